@@ -1,143 +1,126 @@
 #pragma once
 
 #include <unordered_map>
-#include <deque>
-#include <stdext/hash.h>
+#include <vector>
+#include <memory>
+#include <string>
+#include <mutex>
+#include <new>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <stdext/type_id.h>
+#include <tbb/spin_mutex.h>
 #include <cassert>
 
 namespace AI
 {
 	/// <summary>
 	/// A black board class. In a black board, you can store any kind of data. A piece of information is identified by its type and an associated
-	/// string identifier. To accelerate requests, the string identifier must first be converted into a numerical identifier by using the method 
-	/// <see cref="Blackboard::getId"> getId </see>.
+	/// string identifier. To accelerate requests, the pair (type, identifier) should be resolved once in a <see cref="Blackboard::Key"/> by using
+	/// the method <see cref="Blackboard::key"/>: keys are interned for the whole program and designate a slot of every blackboard, a request
+	/// with a key is an array access. The values of a blackboard are stored contiguously in its own memory blocks, an empty blackboard does not
+	/// allocate memory.
+	/// Keys can be created from any thread. Blackboards can be used concurrently, requests on the same blackboard are serialized by a spin lock
+	/// (the values themselves are not protected).
 	/// </summary>
 	class Blackboard
 	{
+	public:
 		/// <summary>
-		/// Gets the destroy map storage. The destroy map is used to store callbacks used to remove all data associated with an instance of Blackboard
+		/// Handle of a piece of information of type Type, see <see cref="Blackboard::key"/>.
 		/// </summary>
-		/// <returns></returns>
-		static std::unordered_map<const Blackboard *, std::deque<std::function<void()>>*> & getDestroyMapStorage()
+		template <typename Type>
+		class Key
 		{
-			static std::unordered_map<const Blackboard *, std::deque<std::function<void()>>*> destroyCallbacks;
-			return destroyCallbacks;
-		}
+			friend class Blackboard;
+
+			std::uint32_t m_slot;
+
+			/// <summary>
+			/// Constructor dedicated to the blackboard.
+			/// </summary>
+			/// <param name="slot">The slot.</param>
+			explicit Key(std::uint32_t slot)
+				: m_slot(slot)
+			{}
 
+		public:
+			/// <summary>
+			/// Gets the slot designated by this key in the blackboards.
+			/// </summary>
+			/// <returns></returns>
+			std::uint32_t getSlot() const { return m_slot; }
+		};
+
+	private:
 		/// <summary>
-		/// Gets the destroy map i.e. the vector containing the callback functions used to clear an instance of blackboard.
+		/// A value of the blackboard and the function destroying it (nullptr for trivially destructible types).
 		/// </summary>
-		/// <param name="blackboard">The blackboard.</param>
-		/// <returns></returns>
-		static std::deque<std::function<void()>> & getDestroyMap(const Blackboard * blackboard)
+		struct Slot
 		{
-			std::unordered_map<const Blackboard *, std::deque<std::function<void()>>*> & destroyCallbacks = getDestroyMapStorage();
-			auto it = destroyCallbacks.find(blackboard);
-			if (it == destroyCallbacks.end())
-			{
-				std::deque<std::function<void()>> * tmp = new std::deque<std::function<void()>>();
-				destroyCallbacks[blackboard] = tmp;
-				return *tmp;
-			}
-			return *(it->second);
-		}
+			void * m_value;
+			void(*m_destroy)(void *);
+		};
 
 		/// <summary>
-		/// Removes the entry associated with a black board in the destroy map storage.
+		/// The size of the memory blocks storing the values (larger values have their own block).
 		/// </summary>
-		/// <param name="blackboard">The blackboard.</param>
-		static void removeDestroyEntry(const Blackboard * blackboard)
-		{
-			std::unordered_map<const Blackboard *, std::deque<std::function<void()>>*> & destroyCallbacks = getDestroyMapStorage();
-			auto it = destroyCallbacks.find(blackboard);
-			assert(it != destroyCallbacks.end());
-			delete it->second;
-			destroyCallbacks.erase(it);
-		}
+		static constexpr size_t blockSize = 256;
 
 		/// <summary>
-		/// Gets the map used to store blackboards data of type Type.
+		/// The interned keys: the slot associated with a type and an identifier.
 		/// </summary>
-		/// <returns></returns>
-		template <typename Type>
-		static std::unordered_map<const Blackboard*, std::deque<Type> *> & getBlackboardMap()
+		struct KeyRegistry
 		{
-			static std::unordered_map<const Blackboard*, std::deque<Type> *> blackboards;
-			return blackboards;
-		}
+			std::mutex m_mutex;
+			std::vector<std::unordered_map<std::string, std::uint32_t>> m_slots;
+			std::uint32_t m_size = 0;
+		};
 
 		/// <summary>
-		/// Gets the storage used to store data of type Type for the provided blackboard.
+		/// Gets the registry of the keys.
 		/// </summary>
-		/// <param name="blackboard">The blackboard.</param>
 		/// <returns></returns>
-		template <typename Type>
-		static std::deque<Type> & getBlackboardData(const Blackboard * blackboard)
+		static KeyRegistry & getKeyRegistry()
 		{
-			std::unordered_map<const Blackboard*, std::deque<Type> *> & map = getBlackboardMap<Type>();
-			auto it = map.find(blackboard);
-			if (it == map.end())
-			{
-				// We create the new storage and record it
-				std::deque<Type> * tmp = new std::deque<Type>();
-				map[blackboard] = tmp;
-				// We register the destroy function for this data
-				std::deque<std::function<void()>> & destroyCallbacks = getDestroyMap(blackboard);
-				auto destroyFunction = [blackboard]()
-				{
-					std::unordered_map<const Blackboard*, std::deque<Type> *> & map = getBlackboardMap<Type>();
-					auto it = map.find(blackboard);
-					assert(it != map.end());
-					delete it->second;
-					map.erase(it);
-				};
-				destroyCallbacks.push_back(destroyFunction);
-				// Now, we can return the storage data.
-				return *tmp;
-			}
-			return *it->second;
+			static KeyRegistry registry;
+			return registry;
 		}
 
 		/// <summary>
-		/// Gets the id map used by the provided blackboard for data of type Type.
+		/// The slots of this blackboard, indexed by Key::getSlot (null value if the slot is not used).
 		/// </summary>
-		/// <returns></returns>
-		template <typename Type>
-		static std::unordered_map<const Blackboard *, std::unordered_map<std::string, size_t> *> & getBlackboardIdMap()
-		{
-			static std::unordered_map<const Blackboard *, std::unordered_map<std::string, size_t> *> ids;
-			return ids;
-		}
+		mutable std::vector<Slot> m_slots;
+		/// <summary>
+		/// The memory blocks storing the values.
+		/// </summary>
+		mutable std::vector<std::unique_ptr<std::max_align_t[]>> m_blocks;
+		/// <summary>
+		/// The number of bytes used in the last block and its capacity.
+		/// </summary>
+		mutable size_t m_used;
+		mutable size_t m_capacity;
+		mutable tbb::spin_mutex m_mutex;
 
 		/// <summary>
-		/// Gets the identifier map used for data of type Type by the provided blackboard.
+		/// Allocates memory in the blocks.
 		/// </summary>
-		/// <param name="blackboard">The blackboard.</param>
+		/// <param name="size">The size.</param>
+		/// <param name="alignment">The alignment.</param>
 		/// <returns></returns>
-		template <typename Type>
-		static std::unordered_map<std::string, size_t> & getBlackboardIdData(const Blackboard * blackboard)
+		void * allocate(size_t size, size_t alignment) const
 		{
-			std::unordered_map<const Blackboard *, std::unordered_map<std::string, size_t> *> & map = getBlackboardIdMap<Type>();
-			auto it = map.find(blackboard);
-			if (it == map.end())
+			size_t offset = (m_used + alignment - 1) & ~(alignment - 1);
+			if (m_blocks.empty() || offset + size > m_capacity)
 			{
-				// We create the new map
-				std::unordered_map<std::string, size_t> * tmp = new std::unordered_map<std::string, size_t>();
-				map[blackboard] = tmp;
-				// We register the destroy function
-				auto destroyFunction = [blackboard]()
-				{
-					std::unordered_map<const Blackboard *, std::unordered_map<std::string, size_t> *> & map = getBlackboardIdMap<Type>();
-					auto it = map.find(blackboard);
-					assert(it != map.end());
-					delete it->second;
-					map.erase(it);
-				};
-				getDestroyMap(blackboard).push_back(destroyFunction);
-				// We return the result
-				return *tmp;
+				size_t capacity = std::max(size, blockSize);
+				m_blocks.push_back(std::unique_ptr<std::max_align_t[]>(new std::max_align_t[(capacity + sizeof(std::max_align_t) - 1) / sizeof(std::max_align_t)]));
+				m_capacity = capacity;
+				offset = 0;
 			}
-			return *it->second;
+			m_used = offset + size;
+			return reinterpret_cast<unsigned char*>(m_blocks.back().get()) + offset;
 		}
 
 	public:
@@ -200,7 +183,7 @@ namespace AI
 			/// <param name="blackboard">The blackboard.</param>
 			/// <param name="data">The data.</param>
 			BlackboardData(const Blackboard * blackboard, Type * data)
-				: ConstBlackboardData(blackboard, data)
+				: ConstBlackboardData<Type>(blackboard, data)
 			{}
 
 		public:
@@ -218,13 +201,13 @@ namespace AI
 			/// <summary>
 			/// Cast operator to Type&amp;.
 			/// </summary>
-			operator Type & () { return *m_data; }
+			operator Type & () { return *this->m_data; }
 
 			/// <summary>
 			/// Accesses data designated by this instance.
 			/// </summary>
 			/// <returns></returns>
-			Type & operator * () { return *m_data; }
+			Type & operator * () { return *this->m_data; }
 
 			/// <summary>
 			/// Changes the value designated by this operator
@@ -233,7 +216,7 @@ namespace AI
 			/// <returns></returns>
 			BlackboardData & operator = (const Type & value)
 			{
-				(*m_data) = value;
+				(*this->m_data) = value;
 				return (*this);
 			}
 		};
@@ -242,8 +225,12 @@ namespace AI
 		/// Initializes a new instance of the <see cref="Blackboard"/> class.
 		/// </summary>
 		Blackboard()
+			: m_used(0), m_capacity(0)
 		{}
 
+		Blackboard(const Blackboard &) = delete;
+		Blackboard & operator = (const Blackboard &) = delete;
+
 		/// <summary>
 		/// Finalizes an instance of the <see cref="Blackboard"/> class.
 		/// </summary>
@@ -253,37 +240,98 @@ namespace AI
 		}
 
 		/// <summary>
-		/// Clears this blackboard. 
+		/// Clears this blackboard. The previously returned data are no longer valid.
 		/// </summary>
 		void clear()
 		{
-			std::deque<std::function<void()>> & destroyCallbacks = getDestroyMap(this);
-			for (auto it = destroyCallbacks.begin(), end = destroyCallbacks.end(); it != end; ++it)
+			tbb::spin_mutex::scoped_lock lock(m_mutex);
+			for (const Slot & slot : m_slots)
 			{
-				(*it)(); // We call all destroy functions
+				if (slot.m_value != nullptr && slot.m_destroy != nullptr) { slot.m_destroy(slot.m_value); }
 			}
-			removeDestroyEntry(this);
+			m_slots.clear();
+			m_blocks.clear();
+			m_used = 0;
+			m_capacity = 0;
 		}
 
 		/// <summary>
-		/// Gets the id of the variable of type Type identified by the provided identifier.
+		/// Gets the key of the variable of type Type identified by the provided identifier. Keys should be stored (e.g. in static variables or
+		/// class members) and reused: this method locks the registry of the keys.
 		/// </summary>
 		/// <param name="identifier">The identifier.</param>
 		/// <returns></returns>
 		template <typename Type>
-		BlackboardData<Type> get(const std::string & identifier, Type defaultValue = Type()) const
+		static Key<Type> key(const std::string & identifier)
+		{
+			KeyRegistry & registry = getKeyRegistry();
+			stdext::type_id_t type = stdext::type_id<Type>();
+			std::lock_guard<std::mutex> lock(registry.m_mutex);
+			if (type >= registry.m_slots.size()) { registry.m_slots.resize(type + 1); }
+			auto result = registry.m_slots[type].insert(std::make_pair(identifier, registry.m_size));
+			if (result.second) { ++registry.m_size; }
+			return Key<Type>(result.first->second);
+		}
+
+		/// <summary>
+		/// Tests if this blackboard contains the variable designated by the provided key.
+		/// </summary>
+		/// <param name="key">The key.</param>
+		/// <returns></returns>
+		template <typename Type>
+		bool contains(const Key<Type> & key) const
+		{
+			tbb::spin_mutex::scoped_lock lock(m_mutex);
+			return key.m_slot < m_slots.size() && m_slots[key.m_slot].m_value != nullptr;
+		}
+
+		/// <summary>
+		/// Gets the variable designated by the provided key. The variable is created with the default value if it does not exist.
+		/// </summary>
+		/// <param name="key">The key.</param>
+		/// <param name="defaultValue">The default value.</param>
+		/// <returns></returns>
+		template <typename Type>
+		BlackboardData<Type> get(const Key<Type> & key, const Type & defaultValue = Type()) const
 		{
-			std::unordered_map<std::string, size_t> & ids = getBlackboardIdData<Type>(this);
-			auto it = ids.find(identifier);
-			std::deque<Type> & data = getBlackboardData<Type>(this);
-			if (it == ids.end())
-			{				
-				data.push_back(defaultValue);
-				ids[identifier] = data.size() - 1;
-				//return data.size() - 1;
-				return BlackboardData<Type>(this, &data.back());
+			static_assert(alignof(Type) <= alignof(std::max_align_t), "Over-aligned types cannot be stored in a blackboard");
+			tbb::spin_mutex::scoped_lock lock(m_mutex);
+			if (key.m_slot >= m_slots.size())
+			{
+				// Room for all the keys created so far
+				std::uint32_t size = 0;
+				{
+					KeyRegistry & registry = getKeyRegistry();
+					std::lock_guard<std::mutex> registryLock(registry.m_mutex);
+					size = registry.m_size;
+				}
+				m_slots.resize(std::max<size_t>(size, key.m_slot + 1), Slot{ nullptr, nullptr });
+			}
+			Slot & slot = m_slots[key.m_slot];
+			if (slot.m_value == nullptr)
+			{
+				slot.m_value = new (allocate(sizeof(Type), alignof(Type))) Type(defaultValue);
+				if constexpr (!std::is_trivially_destructible<Type>::value)
+				{
+					slot.m_destroy = [](void * value) { static_cast<Type*>(value)->~Type(); };
+				}
 			}
-			return BlackboardData<Type>(this, &data[it->second]);
+			return BlackboardData<Type>(this, static_cast<Type*>(slot.m_value));
+		}
+
+		/// <summary>
+		/// Gets the variable of type Type identified by the provided identifier. The variable is created with the default value if it does not
+		/// exist. Slow: each call interns the identifier and locks the registry of the keys, a mutex shared by all the threads (about five
+		/// times slower than a request with a key, see Benchmarks/BlackboardBenchmark.h). Reserve it to occasional requests and prefer
+		/// <see cref="get(const Key&lt;Type&gt; &amp;, const Type &amp;)"/> with a stored key.
+		/// </summary>
+		/// <param name="identifier">The identifier.</param>
+		/// <param name="defaultValue">The default value.</param>
+		/// <returns></returns>
+		template <typename Type>
+		BlackboardData<Type> get(const std::string & identifier, Type defaultValue = Type()) const
+		{
+			return get(key<Type>(identifier), defaultValue);
 		}
 	};
-}
\ No newline at end of file
+}
@@ -0,0 +1,663 @@
+#pragma once
+
+#include <AI/Tasks/Task.h>
+#include <AI/Tasks/internal/CompiledTree_imp.h>
+#include <stdext/chrono/is_clock.h>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <chrono>
+#include <cstdint>
+#include <stdexcept>
+#include <initializer_list>
+
+namespace AI
+{
+	namespace Tasks
+	{
+		/// <summary>
+		/// Compiled task trees. The operators of this namespace mirror the ones of AI/Tasks/Operators.h and AI/Tasks/TimeOperators.h (same
+		/// names, same semantics) but build a <see cref="Description"/> whose leaves are functions of a context (e.g. an agent) instead of
+		/// closures. A description is compiled once into a <see cref="Tree"/>: a contiguous array of nodes executed without virtual calls,
+		/// shared pointers or memory allocation. The execution state of each agent (statuses, current children...) is a block of
+		/// <see cref="Tree::getStateSize"/> words, the blocks of many agents can be stored contiguously (see <see cref="Tree::States"/>).
+		/// </summary>
+		namespace Compiled
+		{
+			/// <summary>
+			/// A compiled task tree, see AI::Tasks::Compiled.
+			/// </summary>
+			template <typename Context>
+			class Tree
+			{
+				using Node = internal::Node<Context>;
+				using Kind = internal::Kind;
+				using Status = Task::Status;
+
+				std::vector<Node> m_nodes;
+				/// <summary>
+				/// The children of the nodes, the children of a node are in [m_firstChild; m_firstChild + m_childCount[.
+				/// </summary>
+				std::vector<std::uint32_t> m_children;
+				std::uint32_t m_stateSize;
+
+				/// <summary>
+				/// Appends a node and its subtree (pre-order).
+				/// </summary>
+				/// <returns>The index of the node.</returns>
+				std::uint32_t compile(const Description<Context> & description)
+				{
+					std::uint32_t index = std::uint32_t(m_nodes.size());
+					std::uint32_t childCount = std::uint32_t(description.m_children.size());
+					if ((description.m_kind == Kind::sequence || description.m_kind == Kind::firstOf || description.m_kind == Kind::randomPick) && childCount == 0)
+					{
+						throw std::runtime_error("AI::Tasks::Compiled::Tree: sequence, firstOf and randomPick need at least one task");
+					}
+					Node node;
+					node.m_kind = description.m_kind;
+					node.m_result = description.m_result;
+					node.m_firstChild = std::uint32_t(m_children.size());
+					node.m_childCount = childCount;
+					node.m_state = m_stateSize;
+					node.m_initialize = description.m_initialize;
+					node.m_activity = description.m_activity;
+					node.m_finalize = description.m_finalize;
+					node.m_condition = description.m_condition;
+					node.m_now = description.m_now;
+					node.m_duration = description.m_duration;
+					m_nodes.push_back(node);
+					m_stateSize += 1 + internal::stateWords(node.m_kind, childCount);
+					// The children of the node are contiguous, the subtrees are appended after them
+					m_children.resize(m_children.size() + childCount);
+					for (std::uint32_t cpt = 0; cpt < childCount; ++cpt)
+					{
+						std::uint32_t child = compile(description.m_children[cpt]);
+						m_children[m_nodes[index].m_firstChild + cpt] = child;
+					}
+					return index;
+				}
+
+				const Node & child(const Node & node, std::uint32_t rank) const { return m_nodes[m_children[node.m_firstChild + rank]]; }
+
+				/// <summary>
+				/// The first child of a node, which directly follows it in the pre-order array.
+				/// </summary>
+				static const Node & firstChild(const Node & node) { return (&node)[1]; }
+
+				static bool finished(Status status) { return status == Status::success || status == Status::failure; }
+
+				/// <summary>
+				/// Equivalent of Task::execute.
+				/// </summary>
+				Status execute(const Node & node, Context & context, std::uint32_t * state) const
+				{
+					std::uint32_t * data = state + node.m_state;
+					Status status = Status(data[0]);
+					if (finished(status) || status == Status::none)
+					{
+						initialize(node, context, data);
+						data[0] = std::uint32_t(Status::sleeping);
+					}
+					// Leaves are the most frequent nodes: their activity is called directly
+					status = node.m_kind == Kind::leaf ? node.m_activity(context) : activity(node, context, state, data);
+					data[0] = std::uint32_t(status);
+					if (finished(status)) { finalize(node, context, state, data); }
+					return status;
+				}
+
+				/// <summary>
+				/// Equivalent of Task::reset.
+				/// </summary>
+				void reset(const Node & node, Context & context, std::uint32_t * state) const
+				{
+					std::uint32_t * data = state + node.m_state;
+					Status status = Status(data[0]);
+					if (!finished(status) && status != Status::none) { finalize(node, context, state, data); }
+					data[0] = std::uint32_t(Status::none);
+				}
+
+				void initialize(const Node & node, Context & context, std::uint32_t * data) const
+				{
+					switch (node.m_kind)
+					{
+					case Kind::leaf:
+						node.m_initialize(context);
+						break;
+					case Kind::ifSuccessOrFailure:
+					case Kind::sequence:
+					case Kind::precondition:
+					case Kind::firstOf:
+						data[1] = 0;
+						break;
+					case Kind::randomPick:
+					{
+						data[1] = 0;
+						std::uint32_t * order = data + 3;
+						for (std::uint32_t cpt = 0; cpt < node.m_childCount; ++cpt) { order[cpt] = cpt; }
+						// Fisher-Yates shuffle driven by a xorshift generator stored in the state
+						for (std::uint32_t cpt = node.m_childCount; cpt > 1; --cpt)
+						{
+							std::uint32_t & random = data[2];
+							random ^= random << 13; random ^= random >> 17; random ^= random << 5;
+							std::swap(order[cpt - 1], order[random % cpt]);
+						}
+						break;
+					}
+					case Kind::parallelAnd:
+					case Kind::parallelOr:
+						data[1] = node.m_childCount;
+						for (std::uint32_t cpt = 0; cpt < node.m_childCount; ++cpt) { data[2 + cpt] = cpt; }
+						break;
+					case Kind::waitFor:
+					case Kind::tryDuring:
+					{
+						std::uint64_t now = std::uint64_t(node.m_now());
+						data[1] = std::uint32_t(now);
+						data[2] = std::uint32_t(now >> 32);
+						break;
+					}
+					default:
+						break;
+					}
+				}
+
+				/// <summary>
+				/// Activity of firstOf and randomPick (kept out of activity so that the other operators do not pay for its registers).
+				/// </summary>
+				Status pick(const Node & node, Context & context, std::uint32_t * state, std::uint32_t * data) const
+				{
+					// data[1] is the rank of the current task plus one, 0 if no task is running
+					const std::uint32_t * order = node.m_kind == Kind::randomPick ? data + 3 : nullptr;
+					if (data[1] != 0)
+					{
+						std::uint32_t rank = data[1] - 1;
+						return execute(child(node, order ? order[rank] : rank), context, state);
+					}
+					for (std::uint32_t rank = 0; rank < node.m_childCount; ++rank)
+					{
+						const Node & current = child(node, order ? order[rank] : rank);
+						Status tmp = execute(current, context, state);
+						if (tmp != Status::sleeping)
+						{
+							data[1] = rank + 1;
+							return tmp;
+						}
+						reset(current, context, state);
+					}
+					return Status::sleeping;
+				}
+
+				/// <summary>
+				/// Activity of parallelAnd and parallelOr, same order of execution as the running list of ParallelAnd / ParallelOr (removal
+				/// by swap with the last task).
+				/// </summary>
+				Status parallel(const Node & node, Context & context, std::uint32_t * state, std::uint32_t * data) const
+				{
+					bool isAnd = node.m_kind == Kind::parallelAnd;
+					Status result = Status::running;
+					std::uint32_t & count = data[1];
+					std::uint32_t * running = data + 2;
+					for (std::uint32_t cpt = 0; cpt < count; )
+					{
+						Status tmp = execute(child(node, running[cpt]), context, state);
+						if (finished(tmp))
+						{
+							running[cpt] = running[--count];
+							if (tmp == (isAnd ? Status::failure : Status::success)) { result = tmp; }
+						}
+						else { ++cpt; }
+					}
+					if (count == 0 && result == Status::running) { return isAnd ? Status::success : Status::failure; }
+					return result;
+				}
+
+				Status activity(const Node & node, Context & context, std::uint32_t * state, std::uint32_t * data) const
+				{
+					switch (node.m_kind)
+					{
+					case Kind::leaf:
+						return node.m_activity(context);
+					case Kind::constant:
+						return node.m_result;
+					case Kind::ifSuccessOrFailure:
+					{
+						if (data[1] != 0) { return execute(child(node, data[1]), context, state); }
+						Status tmp = execute(firstChild(node), context, state);
+						if (tmp == Status::success) { data[1] = 1; return Status::running; }
+						if (tmp == Status::failure) { data[1] = 2; return Status::running; }
+						return tmp;
+					}
+					case Kind::sequence:
+					{
+						Status tmp = execute(child(node, data[1]), context, state);
+						if (tmp == Status::failure) { return Status::failure; }
+						if (tmp == Status::success) { ++data[1]; }
+						if (data[1] == node.m_childCount) { return Status::success; }
+						return Status::running;
+					}
+					case Kind::precondition:
+						if (data[1] == 0 && node.m_condition(context)) { data[1] = 1; }
+						if (data[1] != 0) { return execute(firstChild(node), context, state); }
+						return Status::sleeping;
+					case Kind::firstOf:
+					case Kind::randomPick:
+						return pick(node, context, state, data);
+					case Kind::succeedsWhen:
+					{
+						if (node.m_condition(context)) { return Status::success; }
+						Status tmp = execute(firstChild(node), context, state);
+						if (tmp == Status::failure) { return Status::failure; }
+						return Status::running;
+					}
+					case Kind::failsWhen:
+					{
+						if (node.m_condition(context)) { return Status::failure; }
+						Status tmp = execute(firstChild(node), context, state);
+						if (tmp == Status::success) { return Status::success; }
+						return Status::running;
+					}
+					case Kind::repeatUntilSuccess:
+						return execute(firstChild(node), context, state) == Status::success ? Status::success : Status::running;
+					case Kind::repeatUntilFailure:
+						return execute(firstChild(node), context, state) == Status::failure ? Status::success : Status::running;
+					case Kind::parallelAnd:
+					case Kind::parallelOr:
+						return parallel(node, context, state, data);
+					case Kind::negate:
+					{
+						Status tmp = execute(firstChild(node), context, state);
+						if (tmp == Status::success) { return Status::failure; }
+						if (tmp == Status::failure) { return Status::success; }
+						return tmp;
+					}
+					case Kind::loop:
+						execute(firstChild(node), context, state);
+						return Status::running;
+					case Kind::waitFor:
+					case Kind::tryDuring:
+					{
+						std::int64_t start = std::int64_t(std::uint64_t(data[1]) | (std::uint64_t(data[2]) << 32));
+						if (node.m_now() - start >= node.m_duration) { return node.m_result; }
+						if (node.m_kind == Kind::waitFor) { return Status::running; }
+						Status tmp = execute(firstChild(node), context, state);
+						return finished(tmp) ? tmp : Status::running;
+					}
+					}
+					return Status::failure;
+				}
+
+				void finalize(const Node & node, Context & context, std::uint32_t * state, std::uint32_t * data) const
+				{
+					switch (node.m_kind)
+					{
+					case Kind::leaf:
+						node.m_finalize(context);
+						break;
+					case Kind::ifSuccessOrFailure:
+						for (std::uint32_t cpt = 0; cpt < 3; ++cpt) { reset(child(node, cpt), context, state); }
+						break;
+					case Kind::sequence:
+						for (std::uint32_t cpt = 0; cpt <= std::min(data[1], node.m_childCount - 1); ++cpt) { reset(child(node, cpt), context, state); }
+						break;
+					case Kind::precondition:
+						if (data[1] != 0) { reset(firstChild(node), context, state); }
+						break;
+					case Kind::firstOf:
+						if (data[1] != 0) { reset(child(node, data[1] - 1), context, state); }
+						break;
+					case Kind::randomPick:
+						if (data[1] != 0) { reset(child(node, data[3 + data[1] - 1]), context, state); }
+						break;
+					case Kind::succeedsWhen:
+					case Kind::failsWhen:
+					case Kind::repeatUntilSuccess:
+					case Kind::repeatUntilFailure:
+					case Kind::tryDuring:
+						reset(firstChild(node), context, state);
+						break;
+					case Kind::parallelAnd:
+					case Kind::parallelOr:
+						for (std::uint32_t cpt = 0; cpt < data[1]; ++cpt) { reset(child(node, data[2 + cpt]), context, state); }
+						data[1] = 0;
+						break;
+					default:
+						break;
+					}
+				}
+
+			public:
+				/// <summary>
+				/// Compiles a task tree.
+				/// </summary>
+				/// <param name="description">The description of the tree.</param>
+				Tree(const Description<Context> & description)
+					: m_stateSize(0)
+				{
+					compile(description);
+				}
+
+				/// <summary>
+				/// Returns the number of nodes of the tree.
+				/// </summary>
+				/// <returns></returns>
+				size_t getNodeCount() const { return m_nodes.size(); }
+
+				/// <summary>
+				/// Returns the size of a state block, in words.
+				/// </summary>
+				/// <returns></returns>
+				std::uint32_t getStateSize() const { return m_stateSize; }
+
+				/// <summary>
+				/// Initializes a state block: all tasks are reset.
+				/// </summary>
+				/// <param name="state">The state block (getStateSize() words).</param>
+				/// <param name="seed">The seed of the random picks.</param>
+				void initialize(std::uint32_t * state, std::uint32_t seed = 1) const
+				{
+					std::fill(state, state + m_stateSize, 0u);
+					for (size_t cpt = 0; cpt < m_nodes.size(); ++cpt)
+					{
+						state[m_nodes[cpt].m_state] = std::uint32_t(Status::none);
+						if (m_nodes[cpt].m_kind == Kind::randomPick)
+						{
+							// The xorshift state must not be null
+							state[m_nodes[cpt].m_state + 2] = (seed ^ std::uint32_t(cpt * 0x9E3779B9u)) | 1u;
+						}
+					}
+				}
+
+				/// <summary>
+				/// Executes the tree for a context. Once the tree as succeeded or failed, a new call forces a new execution (see Task::execute).
+				/// </summary>
+				/// <param name="context">The context.</param>
+				/// <param name="state">The state block of the context.</param>
+				/// <returns>The status of the root task.</returns>
+				Status execute(Context & context, std::uint32_t * state) const { return execute(m_nodes[0], context, state); }
+
+				/// <summary>
+				/// Resets the tree for a context (see Task::reset).
+				/// </summary>
+				/// <param name="context">The context.</param>
+				/// <param name="state">The state block of the context.</param>
+				void reset(Context & context, std::uint32_t * state) const { reset(m_nodes[0], context, state); }
+
+				/// <summary>
+				/// Gets the status of the root task in a state block.
+				/// </summary>
+				/// <param name="state">The state block.</param>
+				/// <returns></returns>
+				Status getStatus(const std::uint32_t * state) const { return Status(state[0]); }
+
+				/// <summary>
+				/// The contiguous state blocks of a set of contexts.
+				/// </summary>
+				class States
+				{
+					std::uint32_t m_stateSize;
+					std::vector<std::uint32_t> m_words;
+
+				public:
+					/// <summary>
+					/// Allocates and initializes the state blocks.
+					/// </summary>
+					/// <param name="tree">The tree.</param>
+					/// <param name="count">The number of state blocks.</param>
+					/// <param name="seed">The seed of the random picks, the block of index i uses seed + i.</param>
+					States(const Tree & tree, size_t count, std::uint32_t seed = 1)
+						: m_stateSize(tree.getStateSize()), m_words(count * tree.getStateSize())
+					{
+						for (size_t cpt = 0; cpt < count; ++cpt) { tree.initialize((*this)[cpt], seed + std::uint32_t(cpt)); }
+					}
+
+					/// <summary>
+					/// Returns the number of state blocks.
+					/// </summary>
+					/// <returns></returns>
+					size_t size() const { return m_stateSize == 0 ? 0 : m_words.size() / m_stateSize; }
+
+					std::uint32_t * operator[] (size_t index) { return m_words.data() + index * m_stateSize; }
+					const std::uint32_t * operator[] (size_t index) const { return m_words.data() + index * m_stateSize; }
+				};
+			};
+
+			/// <summary>
+			/// Creates a leaf task. The context type must be provided explicitly so that lambdas without capture can be used.
+			/// </summary>
+			/// <param name="initialize">The initialization function.</param>
+			/// <param name="activity">The activity, called until it returns success or failure.</param>
+			/// <param name="finalize">The function called when the task has finished.</param>
+			/// <returns></returns>
+			template <typename Context>
+			Description<Context> makeTask(void(*initialize)(Context &), Task::Status(*activity)(Context &), void(*finalize)(Context &))
+			{
+				return Description<Context>(internal::Kind::leaf).setFunctions(initialize, activity, finalize);
+			}
+
+			/// <summary>
+			/// Creates a leaf task with only an activity.
+			/// </summary>
+			/// <param name="activity">The activity.</param>
+			/// <returns></returns>
+			template <typename Context>
+			Description<Context> makeTask(Task::Status(*activity)(Context &))
+			{
+				return makeTask<Context>([](Context &) {}, activity, [](Context &) {});
+			}
+
+			/// <summary>
+			/// Creates a leaf task calling a method of the context, e.g. makeTask&lt;&amp;Prey::drink&gt;().
+			/// </summary>
+			/// <returns></returns>
+			template <auto method, typename Context = typename internal::member_class<decltype(method)>::type>
+			Description<Context> makeTask()
+			{
+				return makeTask<Context>([](Context & context) { return Task::Status((context.*method)()); });
+			}
+
+			/// <summary>
+			/// And operator. If the first task succeeds, the second task is executed and the operator returns the status of the second task.
+			/// If the first task fails, the operator fails.
+			/// </summary>
+			template <typename Context>
+			Description<Context> operator && (const Description<Context> & t1, const Description<Context> & successTask)
+			{
+				return Description<Context>(internal::Kind::ifSuccessOrFailure, { t1, successTask, Description<Context>(internal::Kind::constant).setResult(Task::Status::failure) });
+			}
+
+			/// <summary>
+			/// Or operator. If the first task succeeds, the operators succeeds. If the first task fails, the operator returns the status
+			/// of the second task.
+			/// </summary>
+			template <typename Context>
+			Description<Context> operator || (const Description<Context> & task, const Description<Context> & failureTask)
+			{
+				return Description<Context>(internal::Kind::ifSuccessOrFailure, { task, Description<Context>(internal::Kind::constant).setResult(Task::Status::success), failureTask });
+			}
+
+			/// <summary>
+			/// If task succeeds, success task is performed. If task fails, the failure task is performed.
+			/// </summary>
+			template <typename Context>
+			Description<Context> ifSuccessOrFailure(const Description<Context> & task, const Description<Context> & successTask, const Description<Context> & failureTask)
+			{
+				return Description<Context>(internal::Kind::ifSuccessOrFailure, { task, successTask, failureTask });
+			}
+
+			/// <summary>
+			/// Executes the tasks in parallel. If a task fails, the operator fails.
+			/// </summary>
+			template <typename Context>
+			Description<Context> parallelAnd(const std::vector<Description<Context>> & tasks)
+			{
+				return Description<Context>(internal::Kind::parallelAnd, tasks);
+			}
+
+			template <typename Context>
+			Description<Context> parallelAnd(std::initializer_list<Description<Context>> tasks) { return parallelAnd(std::vector<Description<Context>>(tasks)); }
+
+			/// <summary>
+			/// Executes tasks in parallel. If a tasks succeeds, the operator succeeds.
+			/// </summary>
+			template <typename Context>
+			Description<Context> parallelOr(const std::vector<Description<Context>> & tasks)
+			{
+				return Description<Context>(internal::Kind::parallelOr, tasks);
+			}
+
+			template <typename Context>
+			Description<Context> parallelOr(std::initializer_list<Description<Context>> tasks) { return parallelOr(std::vector<Description<Context>>(tasks)); }
+
+			/// <summary>
+			/// Realize the sequence of tasks. If a task fails, the whole sequence fails.
+			/// </summary>
+			template <typename Context>
+			Description<Context> sequence(const std::vector<Description<Context>> & tasks)
+			{
+				return Description<Context>(internal::Kind::sequence, tasks);
+			}
+
+			template <typename Context>
+			Description<Context> sequence(std::initializer_list<Description<Context>> tasks) { return sequence(std::vector<Description<Context>>(tasks)); }
+
+			/// <summary>
+			/// Negates the result of the task i.e. succeeds if failes and reciprocally.
+			/// </summary>
+			template <typename Context>
+			Description<Context> negate(const Description<Context> & task)
+			{
+				return Description<Context>(internal::Kind::negate, { task });
+			}
+
+			/// <summary>
+			/// Adds a precondition to the provided task. If the precondition is false, the execute call returns a sleeping status.
+			/// </summary>
+			template <typename Context>
+			Description<Context> precondition(typename internal::identity<bool(*)(Context &)>::type condition, const Description<Context> & task)
+			{
+				return Description<Context>(internal::Kind::precondition, { task }).setCondition(condition);
+			}
+
+			/// <summary>
+			/// Execute the first task with a true precondition i.e. the first task that is not sleeping after a call to execute.
+			/// </summary>
+			template <typename Context>
+			Description<Context> firstOf(const std::vector<Description<Context>> & tasks)
+			{
+				return Description<Context>(internal::Kind::firstOf, tasks);
+			}
+
+			template <typename Context>
+			Description<Context> firstOf(std::initializer_list<Description<Context>> tasks) { return firstOf(std::vector<Description<Context>>(tasks)); }
+
+			/// <summary>
+			/// Randomly picks a task to execute and executes the first found to be not sleeping after a call to execute. The random order
+			/// only depends on the seed of the state block (see <see cref="Tree::initialize"/>).
+			/// </summary>
+			template <typename Context>
+			Description<Context> randomPick(const std::vector<Description<Context>> & tasks)
+			{
+				return Description<Context>(internal::Kind::randomPick, tasks);
+			}
+
+			template <typename Context>
+			Description<Context> randomPick(std::initializer_list<Description<Context>> tasks) { return randomPick(std::vector<Description<Context>>(tasks)); }
+
+			/// <summary>
+			/// This operator changes the success condition of the task. The task is executed until the condition becomes true. If  the
+			/// task fails, the operator fails.
+			/// </summary>
+			template <typename Context>
+			Description<Context> succeedsWhen(typename internal::identity<bool(*)(Context &)>::type condition, const Description<Context> & task)
+			{
+				return Description<Context>(internal::Kind::succeedsWhen, { task }).setCondition(condition);
+			}
+
+			/// <summary>
+			/// This operator changes the failure condition of the task. If the task succeeds, the operator succeeds.
+			/// </summary>
+			template <typename Context>
+			Description<Context> failsWhen(typename internal::identity<bool(*)(Context &)>::type condition, const Description<Context> & task)
+			{
+				return Description<Context>(internal::Kind::failsWhen, { task }).setCondition(condition);
+			}
+
+			/// <summary>
+			/// The task always returns a success status even if the provided one failed.
+			/// </summary>
+			template <typename Context>
+			Description<Context> alwaysSucceeds(const Description<Context> & task)
+			{
+				return task || Description<Context>(internal::Kind::constant).setResult(Task::Status::success);
+			}
+
+			/// <summary>
+			/// The task always returns a  failure status, even if the provided one succeeded.
+			/// </summary>
+			template <typename Context>
+			Description<Context> alwaysFails(const Description<Context> & task)
+			{
+				return task && Description<Context>(internal::Kind::constant).setResult(Task::Status::failure);
+			}
+
+			/// <summary>
+			/// Repeats the task until it succeeds.
+			/// </summary>
+			template <typename Context>
+			Description<Context> repeatUntilSuccess(const Description<Context> & task)
+			{
+				return Description<Context>(internal::Kind::repeatUntilSuccess, { task });
+			}
+
+			/// <summary>
+			/// Repeats the task until it fails, when this happens the operator returns success.
+			/// </summary>
+			template <typename Context>
+			Description<Context> repeatUntilFailure(const Description<Context> & task)
+			{
+				return Description<Context>(internal::Kind::repeatUntilFailure, { task });
+			}
+
+			/// <summary>
+			/// Loops indefinitely on the provided task. This task is always in running state.
+			/// </summary>
+			template <typename Context>
+			Description<Context> loop(const Description<Context> & task)
+			{
+				return Description<Context>(internal::Kind::loop, { task });
+			}
+
+			/// <summary>
+			/// Waits for the number of provided seconds, measured with Clock (e.g. stdext::chrono::simulated_clock).
+			/// </summary>
+			/// <param name="seconds">The number of seconds to wait.</param>
+			/// <param name="result">The result.</param>
+			/// <returns></returns>
+			template <typename Context, typename Clock = std::chrono::high_resolution_clock>
+			Description<Context> waitFor(double seconds, Task::Status result = Task::Status::success)
+			{
+				static_assert(stdext::chrono::is_clock<Clock>::value, "The provided class is not compatible with the STL clock type.");
+				std::int64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(seconds)).count();
+				auto now = []() { return std::int64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count()); };
+				return Description<Context>(internal::Kind::waitFor).setResult(result).setClock(now, duration);
+			}
+
+			/// <summary>
+			/// Tries to perform a task during a given amount of time, measured with Clock. If the task succeeds or fails during the provided
+			/// amount of time, its result is returns. If the task is not finished, the provided result is returned.
+			/// </summary>
+			/// <param name="seconds">The seconds.</param>
+			/// <param name="task">The task.</param>
+			/// <param name="result">The result.</param>
+			/// <returns></returns>
+			template <typename Clock = std::chrono::high_resolution_clock, typename Context>
+			Description<Context> tryDuring(double seconds, const Description<Context> & task, Task::Status result = Task::Status::failure)
+			{
+				static_assert(stdext::chrono::is_clock<Clock>::value, "The provided class is not compatible with the STL clock type.");
+				std::int64_t duration = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::duration<double>(seconds)).count();
+				auto now = []() { return std::int64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count()); };
+				return Description<Context>(internal::Kind::tryDuring, { task }).setResult(result).setClock(now, duration);
+			}
+		}
+	}
+}
@@ -86,14 +86,7 @@ namespace AI
 		/// <returns></returns>
 		inline std::shared_ptr<Task> negate(const std::shared_ptr<Task> & task)
 		{
-			auto fnc = [task]()
-			{
-				Task::Status tmp = task->execute();
-				if (tmp == Task::Status::success) { return Task::Status::failure; }
-				if (tmp == Task::Status::failure) { return Task::Status::success; }
-				return tmp;
-			};
-			return makeTask(fnc);
+			return std::make_shared<internal::Negate>(task);
 		}
 
 		/// <summary>
@@ -203,8 +196,7 @@ namespace AI
 		/// <returns></returns>
 		inline std::shared_ptr<Task> loop(const std::shared_ptr<Task> & task)
 		{
-			auto fnc = [task]() { task->execute(); return Task::Status::running; };
-			return makeTask(fnc);
+			return std::make_shared<internal::Loop>(task);
 		}
 	}
 }
\ No newline at end of file
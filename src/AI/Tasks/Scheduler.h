@@ -0,0 +1,252 @@
+#pragma once
+
+#include <AI/Tasks/Task.h>
+#include <stdext/chrono/is_clock.h>
+#include <vector>
+#include <memory>
+#include <chrono>
+#include <algorithm>
+#include <cstdint>
+#include <stdexcept>
+
+namespace AI
+{
+	namespace Tasks
+	{
+		/// <summary>
+		/// Executes a set of task trees (e.g. the behaviours of the agents) only when they may progress. After each execution, a running tree
+		/// is parked in a priority queue until its idle time is over (see <see cref="Task::getIdleTime"/>): a tree waiting in a waitFor or a
+		/// tryDuring is not executed again before the end of the wait, so idle agents cost nothing per update. Trees executing any other
+		/// leaf are executed at each update, as they would be without scheduler.
+		/// Clock is the clock of the time operators of the trees (e.g. stdext::chrono::simulated_clock, which must be advanced before
+		/// calling <see cref="Scheduler::update"/>). A scheduler must be used by one thread at a time.
+		/// </summary>
+		template <typename Clock = std::chrono::high_resolution_clock>
+		class Scheduler
+		{
+			static_assert(stdext::chrono::is_clock<Clock>::value, "The provided class is not compatible with the STL clock type.");
+
+		public:
+			using time_point = typename Clock::time_point;
+
+			/// <summary>
+			/// Identifier of a task tree in the scheduler.
+			/// </summary>
+			using Handle = size_t;
+
+		private:
+			/// <summary>
+			/// A scheduled tree.
+			/// </summary>
+			struct Slot
+			{
+				std::shared_ptr<Task> m_task;
+				/// <summary>
+				/// Incremented each time the tree is rescheduled or removed: an entry of the queue with another stamp is obsolete.
+				/// </summary>
+				std::uint32_t m_stamp;
+				/// <summary>
+				/// True if the slot has an up to date entry in the queue.
+				/// </summary>
+				bool m_queued;
+			};
+
+			/// <summary>
+			/// An entry of the queue: the tree of a slot is due at a given time.
+			/// </summary>
+			struct Entry
+			{
+				time_point m_due;
+				Handle m_handle;
+				std::uint32_t m_stamp;
+
+				/// <summary>
+				/// Order of the heap: the entry with the smallest due time (then the smallest handle) is on top.
+				/// </summary>
+				bool operator < (const Entry & other) const
+				{
+					if (m_due != other.m_due) { return m_due > other.m_due; }
+					return m_handle > other.m_handle;
+				}
+			};
+
+			std::vector<Slot> m_slots;
+			std::vector<Handle> m_freeSlots;
+			std::vector<Entry> m_queue;
+			/// <summary>
+			/// The entries processed by the current update (kept to avoid allocations).
+			/// </summary>
+			std::vector<Entry> m_due;
+			size_t m_size;
+
+			/// <summary>
+			/// Schedules the tree of a slot, any previous entry becomes obsolete.
+			/// </summary>
+			/// <param name="handle">The handle.</param>
+			/// <param name="due">The due time.</param>
+			void schedule(Handle handle, time_point due)
+			{
+				Slot & slot = m_slots[handle];
+				++slot.m_stamp;
+				slot.m_queued = true;
+				m_queue.push_back(Entry{ due, handle, slot.m_stamp });
+				std::push_heap(m_queue.begin(), m_queue.end());
+			}
+
+			const Slot & getSlot(Handle handle) const
+			{
+				if (handle >= m_slots.size() || !m_slots[handle].m_task)
+				{
+					throw std::runtime_error("AI::Tasks::Scheduler: invalid handle");
+				}
+				return m_slots[handle];
+			}
+
+		public:
+			/// <summary>
+			/// Initializes a new instance of the <see cref="Scheduler"/> class.
+			/// </summary>
+			Scheduler()
+				: m_size(0)
+			{}
+
+			/// <summary>
+			/// Adds a task tree, executed by the next update.
+			/// </summary>
+			/// <param name="task">The task.</param>
+			/// <returns>The handle of the tree in this scheduler.</returns>
+			Handle add(const std::shared_ptr<Task> & task)
+			{
+				if (!task) { throw std::runtime_error("AI::Tasks::Scheduler: null task"); }
+				Handle handle;
+				if (m_freeSlots.empty())
+				{
+					handle = m_slots.size();
+					m_slots.push_back(Slot{ task, 0, false });
+				}
+				else
+				{
+					handle = m_freeSlots.back();
+					m_freeSlots.pop_back();
+					m_slots[handle].m_task = task;
+				}
+				++m_size;
+				schedule(handle, Clock::now());
+				return handle;
+			}
+
+			/// <summary>
+			/// Removes a task tree. The tree is not reset.
+			/// </summary>
+			/// <param name="handle">The handle.</param>
+			void remove(Handle handle)
+			{
+				getSlot(handle);
+				Slot & slot = m_slots[handle];
+				slot.m_task.reset();
+				++slot.m_stamp;
+				slot.m_queued = false;
+				m_freeSlots.push_back(handle);
+				--m_size;
+			}
+
+			/// <summary>
+			/// Forces the execution of a tree by the next update, e.g. because an event occurred. A tree which succeeded or failed is not
+			/// executed anymore until it is woken up (its execution restarts, see Task::execute).
+			/// </summary>
+			/// <param name="handle">The handle.</param>
+			void wakeUp(Handle handle)
+			{
+				getSlot(handle);
+				schedule(handle, Clock::now());
+			}
+
+			/// <summary>
+			/// Executes the trees whose due time is over. The trees which are still running or sleeping are scheduled again after their
+			/// idle time.
+			/// </summary>
+			/// <returns>The number of executed trees.</returns>
+			size_t update()
+			{
+				return update([](Handle, Task::Status) {});
+			}
+
+			/// <summary>
+			/// Executes the trees whose due time is over and calls onExecuted(handle, status) after each execution. The trees are executed
+			/// by increasing due time. onExecuted may add, remove or wake up trees, the trees it adds or wakes up are executed by the next
+			/// update.
+			/// </summary>
+			/// <param name="onExecuted">The function called after each execution.</param>
+			/// <returns>The number of executed trees.</returns>
+			template <typename Callback>
+			size_t update(const Callback & onExecuted)
+			{
+				time_point now = Clock::now();
+				// The due trees are extracted first: a tree with no idle time is due again at the current time
+				m_due.clear();
+				while (!m_queue.empty() && !(now < m_queue.front().m_due))
+				{
+					std::pop_heap(m_queue.begin(), m_queue.end());
+					const Entry & entry = m_queue.back();
+					if (entry.m_stamp == m_slots[entry.m_handle].m_stamp) { m_due.push_back(entry); }
+					m_queue.pop_back();
+				}
+				size_t executed = 0;
+				for (const Entry & entry : m_due)
+				{
+					Slot & slot = m_slots[entry.m_handle];
+					if (entry.m_stamp != slot.m_stamp) { continue; } // Removed or woken up by onExecuted
+					slot.m_queued = false;
+					std::shared_ptr<Task> task = slot.m_task;
+					Task::Status status = task->execute();
+					++executed;
+					if (status == Task::Status::running || status == Task::Status::sleeping)
+					{
+						schedule(entry.m_handle, now + std::chrono::duration_cast<typename Clock::duration>(task->getIdleTime()));
+					}
+					onExecuted(entry.m_handle, status);
+				}
+				return executed;
+			}
+
+			/// <summary>
+			/// Returns the number of task trees.
+			/// </summary>
+			/// <returns></returns>
+			size_t size() const { return m_size; }
+
+			/// <summary>
+			/// Returns the number of trees waiting for their due time or for a wake up.
+			/// </summary>
+			/// <returns></returns>
+			size_t getQueuedCount() const
+			{
+				size_t result = 0;
+				for (const Slot & slot : m_slots) { result += slot.m_queued ? 1 : 0; }
+				return result;
+			}
+
+			/// <summary>
+			/// Gets the task tree associated with a handle.
+			/// </summary>
+			/// <param name="handle">The handle.</param>
+			/// <returns></returns>
+			const std::shared_ptr<Task> & getTask(Handle handle) const { return getSlot(handle).m_task; }
+
+			/// <summary>
+			/// Gets the next time at which a tree is due, Clock::time_point::max() if no tree is scheduled.
+			/// </summary>
+			/// <returns></returns>
+			time_point getNextDueTime()
+			{
+				// Obsolete entries on top of the queue are discarded
+				while (!m_queue.empty() && m_queue.front().m_stamp != m_slots[m_queue.front().m_handle].m_stamp)
+				{
+					std::pop_heap(m_queue.begin(), m_queue.end());
+					m_queue.pop_back();
+				}
+				return m_queue.empty() ? time_point::max() : m_queue.front().m_due;
+			}
+		};
+	}
+}
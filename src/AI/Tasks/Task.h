@@ -2,6 +2,7 @@
 
 #include <memory>
 #include <iostream>
+#include <chrono>
 
 namespace AI
 {
@@ -58,6 +59,12 @@ namespace AI
 			/// Called when the task has finished (success or failure)
 			/// </summary>
 			virtual void finalize() = 0;
+			/// <summary>
+			/// Gets the time during which executing this running task would not change anything, see <see cref="getIdleTime"/>. By default,
+			/// a task must be executed at each update.
+			/// </summary>
+			/// <returns></returns>
+			virtual std::chrono::nanoseconds idleTime() const { return std::chrono::nanoseconds::zero(); }
 
 		public:
 			/// <summary>
@@ -121,6 +128,18 @@ namespace AI
 				}
 			}
 
+			/// <summary>
+			/// Gets the time during which this task does not need to be executed: it is waiting (see waitFor and tryDuring) and executing it
+			/// would neither change its state nor call any user function. The time is measured with the clock of the time operators. A task
+			/// which is not running has no idle time.
+			/// </summary>
+			/// <returns></returns>
+			std::chrono::nanoseconds getIdleTime() const
+			{
+				if (m_status != Status::running) { return std::chrono::nanoseconds::zero(); }
+				return idleTime();
+			}
+
 			virtual Task * clone() const = 0;
 
 			virtual ~Task() 
@@ -1,5 +1,6 @@
 #pragma once
 #include <chrono>
+#include <algorithm>
 #include <AI/Tasks/Task.h>
 #include <stdext/chrono/timer.h>
 #include <AI/Tasks/internal/TimeOperators_imp.h>
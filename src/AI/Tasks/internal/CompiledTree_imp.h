@@ -0,0 +1,158 @@
+#pragma once
+
+#include <AI/Tasks/Task.h>
+#include <vector>
+#include <cstdint>
+
+namespace AI
+{
+	namespace Tasks
+	{
+		namespace Compiled
+		{
+			template <typename Context>
+			class Tree;
+
+			namespace internal
+			{
+				/// <summary>
+				/// Identity metafunction, used to exclude a parameter from template argument deduction (so that lambdas can be converted
+				/// to function pointers).
+				/// </summary>
+				template <typename Type>
+				struct identity
+				{
+					using type = Type;
+				};
+
+				/// <summary>
+				/// The class of a pointer to member function.
+				/// </summary>
+				template <typename Method>
+				struct member_class;
+
+				template <typename Class, typename Result>
+				struct member_class<Result(Class::*)()>
+				{
+					using type = Class;
+				};
+
+				/// <summary>
+				/// The kinds of nodes, one per operator of AI/Tasks/Operators.h and AI/Tasks/TimeOperators.h.
+				/// </summary>
+				enum class Kind : std::uint8_t
+				{
+					leaf, constant, ifSuccessOrFailure, sequence, precondition, firstOf, randomPick, succeedsWhen, failsWhen,
+					repeatUntilSuccess, repeatUntilFailure, parallelAnd, parallelOr, negate, loop, waitFor, tryDuring
+				};
+
+				/// <summary>
+				/// The number of state words of a node of the provided kind, in addition to its status word.
+				/// </summary>
+				/// <param name="kind">The kind.</param>
+				/// <param name="children">The number of children.</param>
+				/// <returns></returns>
+				inline std::uint32_t stateWords(Kind kind, std::uint32_t children)
+				{
+					switch (kind)
+					{
+					case Kind::ifSuccessOrFailure:
+					case Kind::sequence:
+					case Kind::precondition:
+					case Kind::firstOf:
+						return 1; // Branch, current child or flag
+					case Kind::randomPick:
+						return 2 + children; // Current position, random state and order of the children
+					case Kind::parallelAnd:
+					case Kind::parallelOr:
+						return 1 + children; // Number of running children and their list
+					case Kind::waitFor:
+					case Kind::tryDuring:
+						return 2; // Start time
+					default:
+						return 0;
+					}
+				}
+
+				/// <summary>
+				/// A node of a compiled tree. The children of a node are contiguous in the children array of the tree.
+				/// </summary>
+				template <typename Context>
+				struct Node
+				{
+					Kind m_kind;
+					/// <summary>
+					/// Status returned by a constant, by waitFor or by tryDuring when the time is over.
+					/// </summary>
+					Task::Status m_result;
+					std::uint32_t m_firstChild;
+					std::uint32_t m_childCount;
+					/// <summary>
+					/// Offset of the state of the node in a state block (status word followed by the words of the node).
+					/// </summary>
+					std::uint32_t m_state;
+					void(*m_initialize)(Context &);
+					Task::Status(*m_activity)(Context &);
+					void(*m_finalize)(Context &);
+					bool(*m_condition)(Context &);
+					/// <summary>
+					/// The clock of waitFor and tryDuring, in nanoseconds.
+					/// </summary>
+					std::int64_t(*m_now)();
+					std::int64_t m_duration;
+				};
+			}
+
+			/// <summary>
+			/// Description of a task tree operating on a Context (e.g. an agent), built with the functions of AI::Tasks::Compiled and compiled
+			/// into a <see cref="Tree"/>. Leaves and conditions are function pointers taking the context as a parameter: a description does
+			/// not capture any state and can be shared by all the agents of a type.
+			/// </summary>
+			template <typename Context>
+			class Description
+			{
+				friend class Tree<Context>;
+
+				internal::Kind m_kind;
+				Task::Status m_result;
+				void(*m_initialize)(Context &);
+				Task::Status(*m_activity)(Context &);
+				void(*m_finalize)(Context &);
+				bool(*m_condition)(Context &);
+				std::int64_t(*m_now)();
+				std::int64_t m_duration;
+				std::vector<Description> m_children;
+
+			public:
+				/// <summary>
+				/// Initializes a new instance of the <see cref="Description"/> class. Use the functions of AI::Tasks::Compiled instead.
+				/// </summary>
+				/// <param name="kind">The kind of node.</param>
+				/// <param name="children">The children.</param>
+				Description(internal::Kind kind, const std::vector<Description> & children = std::vector<Description>())
+					: m_kind(kind), m_result(Task::Status::success), m_initialize(nullptr), m_activity(nullptr), m_finalize(nullptr),
+					m_condition(nullptr), m_now(nullptr), m_duration(0), m_children(children)
+				{}
+
+				Description & setResult(Task::Status result) { m_result = result; return (*this); }
+
+				Description & setFunctions(void(*initialize)(Context &), Task::Status(*activity)(Context &), void(*finalize)(Context &))
+				{
+					m_initialize = initialize;
+					m_activity = activity;
+					m_finalize = finalize;
+					return (*this);
+				}
+
+				Description & setCondition(bool(*condition)(Context &)) { m_condition = condition; return (*this); }
+
+				Description & setClock(std::int64_t(*now)(), std::int64_t duration)
+				{
+					m_now = now;
+					m_duration = duration;
+					return (*this);
+				}
+			};
+		}
+	}
+}
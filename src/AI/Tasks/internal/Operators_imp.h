@@ -1,6 +1,7 @@
 #include <AI/Tasks/Task.h>
 #include <vector>
 #include <random>
+#include <algorithm>
 
 namespace AI
 {
@@ -63,6 +64,13 @@ namespace AI
 					m_failureTask->reset();
 				}
 
+				virtual std::chrono::nanoseconds idleTime() const override
+				{
+					if (m_state == State::runningTask) { return m_task->getIdleTime(); }
+					if (m_state == State::runningTaskSuccess) { return m_successTask->getIdleTime(); }
+					return m_failureTask->getIdleTime();
+				}
+
 			public:
 				IfSuccessOrFailure(const std::shared_ptr<Task> & task, const std::shared_ptr<Task> & successTask, const std::shared_ptr<Task> & failureTask)
 					: m_task(task), m_successTask(successTask), m_failureTask(failureTask), m_state(State::runningTask)
@@ -108,6 +116,11 @@ namespace AI
 					}
 				}
 
+				virtual std::chrono::nanoseconds idleTime() const override
+				{
+					return m_tasks[m_currentTask]->getIdleTime();
+				}
+
 			public:
 				Sequence(const std::vector<std::shared_ptr<Task>> & tasks)
 					: m_tasks(tasks)
@@ -167,6 +180,13 @@ namespace AI
 					if (m_running) { m_running->reset(); }
 				}
 
+				virtual std::chrono::nanoseconds idleTime() const override
+				{
+					// The condition is polled until it becomes true
+					if (m_running) { return m_running->getIdleTime(); }
+					return std::chrono::nanoseconds::zero();
+				}
+
 			public:
 				Precondition(const ConditionType & condition, const std::shared_ptr<Task> & task)
 					: m_condition(condition), m_task(task)
@@ -208,7 +228,7 @@ namespace AI
 							}
 							else
 							{
-								m_current->reset();
+								(*it)->reset();
 							}
 						}
 					}
@@ -224,6 +244,12 @@ namespace AI
 					if (m_current) { m_current->reset(); }
 				}
 
+				virtual std::chrono::nanoseconds idleTime() const override
+				{
+					if (m_current) { return m_current->getIdleTime(); }
+					return std::chrono::nanoseconds::zero();
+				}
+
 			public:
 				FirstOf(const std::vector<std::shared_ptr<Task>> & tasks)
 					: m_tasks(tasks)
@@ -381,6 +407,11 @@ namespace AI
 					m_task->reset();
 				}
 
+				virtual std::chrono::nanoseconds idleTime() const override
+				{
+					return m_task->getIdleTime();
+				}
+
 			public:
 				RepeatUntilSuccess(const std::shared_ptr<Task> & task)
 					: m_task(task)
@@ -419,6 +450,11 @@ namespace AI
 					m_task->reset();
 				}
 
+				virtual std::chrono::nanoseconds idleTime() const override
+				{
+					return m_task->getIdleTime();
+				}
+
 			public:
 				RepeatUntilFailure(const std::shared_ptr<Task> & task)
 					: m_task(task)
@@ -483,6 +519,17 @@ namespace AI
 					m_runningTasks.erase(m_runningTasks.begin(), m_runningTasks.end());
 				}
 
+				virtual std::chrono::nanoseconds idleTime() const override
+				{
+					if (m_runningTasks.empty()) { return std::chrono::nanoseconds::zero(); }
+					std::chrono::nanoseconds result = std::chrono::nanoseconds::max();
+					for (auto it = m_runningTasks.begin(), end = m_runningTasks.end(); it != end; ++it)
+					{
+						result = std::min(result, (*it)->getIdleTime());
+					}
+					return result;
+				}
+
 			public:
 				ParallelAnd(const std::vector<std::shared_ptr<Task>> & tasks)
 					: m_tasks(tasks)
@@ -558,6 +605,17 @@ namespace AI
 					m_runningTasks.erase(m_runningTasks.begin(), m_runningTasks.end());
 				}
 
+				virtual std::chrono::nanoseconds idleTime() const override
+				{
+					if (m_runningTasks.empty()) { return std::chrono::nanoseconds::zero(); }
+					std::chrono::nanoseconds result = std::chrono::nanoseconds::max();
+					for (auto it = m_runningTasks.begin(), end = m_runningTasks.end(); it != end; ++it)
+					{
+						result = std::min(result, (*it)->getIdleTime());
+					}
+					return result;
+				}
+
 			public:
 				ParallelOr(const std::vector<std::shared_ptr<Task>> & tasks)
 					: m_tasks(tasks)
@@ -584,6 +642,72 @@ namespace AI
 					}
 				}
 			};
+
+			class Negate : public Task
+			{
+				std::shared_ptr<Task> m_task;
+
+				virtual void initialize() override
+				{}
+
+				virtual Status activity() override
+				{
+					Status tmp = m_task->execute();
+					if (tmp == Status::success) { return Status::failure; }
+					if (tmp == Status::failure) { return Status::success; }
+					return tmp;
+				}
+
+				virtual void finalize() override
+				{}
+
+				virtual std::chrono::nanoseconds idleTime() const override
+				{
+					return m_task->getIdleTime();
+				}
+
+			public:
+				Negate(const std::shared_ptr<Task> & task)
+					: m_task(task)
+				{}
+
+				virtual Negate * clone() const override
+				{
+					return new Negate(std::shared_ptr<Task>(m_task->clone()));
+				}
+			};
+
+			class Loop : public Task
+			{
+				std::shared_ptr<Task> m_task;
+
+				virtual void initialize() override
+				{}
+
+				virtual Status activity() override
+				{
+					m_task->execute();
+					return Status::running;
+				}
+
+				virtual void finalize() override
+				{}
+
+				virtual std::chrono::nanoseconds idleTime() const override
+				{
+					return m_task->getIdleTime();
+				}
+
+			public:
+				Loop(const std::shared_ptr<Task> & task)
+					: m_task(task)
+				{}
+
+				virtual Loop * clone() const override
+				{
+					return new Loop(std::shared_ptr<Task>(m_task->clone()));
+				}
+			};
 		}
 	}
 }
\ No newline at end of file
@@ -33,11 +33,17 @@ namespace AI
 
 				virtual void finalize() override {}
 
+				virtual std::chrono::nanoseconds idleTime() const override
+				{
+					// Remaining time since the last activity
+					return std::max(std::chrono::nanoseconds::zero(), std::chrono::duration_cast<std::chrono::nanoseconds>(m_duration) - m_timer.template elapsed_time<std::chrono::nanoseconds>());
+				}
+
 			public:
 				WaitFor(double seconds, Status result = Status::success)
 					: m_result(result)
 				{
-					m_duration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::chrono::seconds::period>(seconds));
+					m_duration = std::chrono::duration_cast<typename Clock::duration>(std::chrono::duration<double, std::chrono::seconds::period>(seconds));
 				}
 
 				virtual WaitFor * clone() const
@@ -81,11 +87,17 @@ namespace AI
 					m_task->reset();
 				}
 
+				virtual std::chrono::nanoseconds idleTime() const override
+				{
+					std::chrono::nanoseconds remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(m_duration) - m_timer.template elapsed_time<std::chrono::nanoseconds>();
+					return std::max(std::chrono::nanoseconds::zero(), std::min(remaining, m_task->getIdleTime()));
+				}
+
 			public:
 				TryDuring(double seconds, const std::shared_ptr<Task> & task, Status failResult = Status::failure)
 					: m_result(failResult), m_task(task)
 				{
-					m_duration = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double, std::chrono::seconds::period>(seconds));
+					m_duration = std::chrono::duration_cast<typename Clock::duration>(std::chrono::duration<double, std::chrono::seconds::period>(seconds));
 				}
 
 				virtual TryDuring * clone() const override
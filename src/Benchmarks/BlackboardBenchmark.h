@@ -0,0 +1,67 @@
+#pragma once
+
+#include <Benchmarks/Parameters.h>
+#include <Benchmarks/ResultTable.h>
+#include <string>
+
+namespace Benchmarks
+{
+	/// <summary>
+	/// Headless benchmark and concurrency check of <see cref="AI::Blackboard"/>. The keys of the variables are first created from several
+	/// threads at the same time (each identifier must be interned in a single slot). For each number of blackboards, all the variables
+	/// (alternately double and std::string) are then written in parallel, the same blackboard being accessed by several threads at the same
+	/// time, and read back with the keys and with the identifiers, sequentially and in parallel. A value read back that differs from the
+	/// written one is reported as an error. The request times are recorded in a <see cref="ResultTable"/>.
+	///
+	/// Recognized parameters (key=value):
+	/// - blackboards: comma separated list of numbers of blackboards (default 1000,10000)
+	/// - keys: the number of variables per blackboard (default 16)
+	/// - output: prefix of the result files output.csv / output.json (default blackboard_benchmark)
+	/// </summary>
+	class BlackboardBenchmark
+	{
+		Parameters m_parameters;
+		ResultTable m_results;
+
+		/// <summary>
+		/// Creates the keys concurrently and checks that each identifier was interned once.
+		/// </summary>
+		void checkKeys();
+
+		/// <summary>
+		/// Writes and reads the variables of the provided number of blackboards.
+		/// </summary>
+		/// <param name="blackboards">The number of blackboards.</param>
+		void benchmark(size_t blackboards);
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="BlackboardBenchmark"/> class.
+		/// </summary>
+		/// <param name="parameters">The parameters.</param>
+		BlackboardBenchmark(const Parameters & parameters);
+
+		/// <summary>
+		/// Runs the benchmark for all numbers of blackboards.
+		/// </summary>
+		void run();
+
+		/// <summary>
+		/// Saves the results in CSV and JSON format.
+		/// </summary>
+		void save() const;
+
+		/// <summary>
+		/// Gets the results (one row per number of blackboards and operation).
+		/// </summary>
+		/// <returns></returns>
+		const ResultTable & getResults() const { return m_results; }
+
+		/// <summary>
+		/// Entry point of the benchmark: runs it and saves the results.
+		/// </summary>
+		/// <param name="parameters">The parameters.</param>
+		/// <returns>The exit code of the application.</returns>
+		static int main(const Parameters & parameters);
+	};
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <Benchmarks/Parameters.h>
+#include <Benchmarks/ResultTable.h>
+#include <Crowds/Simulator.h>
+#include <Crowds/NeighbourhoodIndex.h>
+#include <memory>
+#include <string>
+
+namespace Benchmarks
+{
+	/// <summary>
+	/// Headless benchmark of the crowd simulator. For each behaviour, population size and neighbourhood index, agents are spread uniformly
+	/// at a constant density in a square and simulated for a number of steps. The rebuild time of the index, the time of the neighbourhood
+	/// requests of all agents, the time of a full simulation step and the number of overlapping agents at the end of the simulation are
+	/// recorded in a <see cref="ResultTable"/>.
+	///
+	/// Recognized parameters (key=value):
+	/// - agents: comma separated list of population sizes (default 1000,10000,100000)
+	/// - indexes: comma separated list of neighbourhood indexes among grid, vptree, regions (grid indexes in regions simulated by their own
+	///   tasks, see Crowds::RegionIndex) (default grid,vptree)
+	/// - regions: the number of regions of the regions index (default 16)
+	/// - behaviours: comma separated list of behaviours among flocking (separation and alignment), orca (agents crossing the square
+	///   with reciprocal collision avoidance) (default flocking)
+	/// - density: the number of agents per square unit (default 0.02)
+	/// - perception: the perception radius of the agents (default 10)
+	/// - cellSize: the cell size of the grid index (default the perception radius)
+	/// - steps: the number of simulation steps (default 10)
+	/// - dt: the simulation time step (default 0.1)
+	/// - updatePeriod: the agents steer every updatePeriod steps, in round robin (default 1)
+	/// - seed: the seed of the initial positions (default 1)
+	/// - record: if not empty, the simulation steps are recorded in record_behaviour_index_agents.traj (see Crowds::TrajectoryRecorder),
+	///   the step time includes the recording (default empty). Once the file is closed, some random frames are read back and compared
+	///   with the simulation
+	/// - verifyFrames: the number of random frames read back from the recorded file (default 4)
+	/// - output: prefix of the result files output.csv / output.json (default crowd_benchmark)
+	/// </summary>
+	class CrowdBenchmark
+	{
+		Parameters m_parameters;
+		ResultTable m_results;
+
+		/// <summary>
+		/// Creates the neighbourhood index selected by its name.
+		/// </summary>
+		/// <param name="name">The name of the index.</param>
+		/// <returns></returns>
+		std::unique_ptr<Crowds::NeighbourhoodIndex> createIndex(const std::string & name) const;
+
+		/// <summary>
+		/// Creates a population of agents and simulates it with the provided neighbourhood index.
+		/// </summary>
+		/// <param name="agents">The number of agents.</param>
+		/// <param name="index">The name of the neighbourhood index.</param>
+		/// <param name="behaviour">The name of the behaviour of the agents.</param>
+		void benchmark(size_t agents, const std::string & index, const std::string & behaviour);
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="CrowdBenchmark"/> class.
+		/// </summary>
+		/// <param name="parameters">The parameters.</param>
+		CrowdBenchmark(const Parameters & parameters);
+
+		/// <summary>
+		/// Runs the benchmark for all behaviours, population sizes and indexes.
+		/// </summary>
+		void run();
+
+		/// <summary>
+		/// Saves the results in CSV and JSON format.
+		/// </summary>
+		void save() const;
+
+		/// <summary>
+		/// Gets the results (one row per behaviour, population size and index).
+		/// </summary>
+		/// <returns></returns>
+		const ResultTable & getResults() const { return m_results; }
+
+		/// <summary>
+		/// Entry point of the benchmark: runs it and saves the results.
+		/// </summary>
+		/// <param name="parameters">The parameters.</param>
+		/// <returns>The exit code of the application.</returns>
+		static int main(const Parameters & parameters);
+	};
+}
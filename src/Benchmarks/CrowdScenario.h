@@ -0,0 +1,79 @@
+#pragma once
+
+#include <Benchmarks/Parameters.h>
+#include <Benchmarks/ResultTable.h>
+#include <Crowds/Simulator.h>
+#include <string>
+#include <cstdint>
+
+namespace Benchmarks
+{
+	/// <summary>
+	/// Headless driver of the predator / prey scenario of the application (preys, predators and water sources spread uniformly in a
+	/// square). The populations and the simulation settings are read from the parameters, usually from a configuration file, and all the
+	/// randomness is seeded: the initial state by std::srand, the decisions of the agents by Crowds::Simulator::setSeed. The simulated
+	/// time is provided by stdext::chrono::simulated_clock, which is advanced before each simulation step. The time of a tick and its
+	/// breakdown by phase (see Crowds::Simulator::Profile) is recorded in a <see cref="ResultTable"/>, with a checksum of the final
+	/// positions that is identical between two runs with the same parameters.
+	///
+	/// Recognized parameters (key=value):
+	/// - preys: the number of preys (default 1500)
+	/// - predators: the number of predators (default 30)
+	/// - water: the number of water sources (default 30)
+	/// - size: the side of the square (default 100)
+	/// - seed: the seed of the scenario (default 1)
+	/// - steps: the number of measured simulation steps (default 500)
+	/// - warmup: the number of simulation steps before the measure (default 10)
+	/// - dt: the simulation time step (default 0.04)
+	/// - output: prefix of the result files output.csv / output.json (default crowd_scenario)
+	/// </summary>
+	class CrowdScenario
+	{
+		Parameters m_parameters;
+		ResultTable m_results;
+		size_t m_killed;
+
+		/// <summary>
+		/// Creates the agents of the scenario.
+		/// </summary>
+		/// <param name="simulator">The simulator.</param>
+		void populate(Crowds::Simulator & simulator) const;
+
+		/// <summary>
+		/// Computes a checksum of the positions of the running agents (FNV-1a hash of their bits).
+		/// </summary>
+		/// <param name="simulator">The simulator.</param>
+		/// <returns></returns>
+		static std::uint64_t checksum(const Crowds::Simulator & simulator);
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="CrowdScenario"/> class.
+		/// </summary>
+		/// <param name="parameters">The parameters.</param>
+		CrowdScenario(const Parameters & parameters);
+
+		/// <summary>
+		/// Builds the scenario and simulates it.
+		/// </summary>
+		void run();
+
+		/// <summary>
+		/// Saves the results in CSV and JSON format.
+		/// </summary>
+		void save() const;
+
+		/// <summary>
+		/// Gets the results (one row per run).
+		/// </summary>
+		/// <returns></returns>
+		const ResultTable & getResults() const { return m_results; }
+
+		/// <summary>
+		/// Entry point of the driver: runs the scenario and saves the results.
+		/// </summary>
+		/// <param name="parameters">The parameters.</param>
+		/// <returns>The exit code of the application.</returns>
+		static int main(const Parameters & parameters);
+	};
+}
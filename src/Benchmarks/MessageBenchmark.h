@@ -0,0 +1,60 @@
+#pragma once
+
+#include <Benchmarks/Parameters.h>
+#include <Benchmarks/ResultTable.h>
+#include <string>
+
+namespace Benchmarks
+{
+	/// <summary>
+	/// Headless benchmark of the dispatch of <see cref="stdext::message_handler"/>. For each number of receivers, one callback receiver
+	/// is created per target, then messages are broadcast to all receivers, posted to each target, and posted to each target in parallel
+	/// in deferred mode (including the flush). The dispatch time and the number of deliveries per second are recorded in a <see cref="ResultTable"/>.
+	///
+	/// Recognized parameters (key=value):
+	/// - receivers: comma separated list of numbers of receivers (default 100000)
+	/// - messages: the number of broadcast messages and of posts per target (default 10)
+	/// - output: prefix of the result files output.csv / output.json (default message_benchmark)
+	/// </summary>
+	class MessageBenchmark
+	{
+		Parameters m_parameters;
+		ResultTable m_results;
+
+		/// <summary>
+		/// Measures broadcast and post with the provided number of receivers.
+		/// </summary>
+		/// <param name="receivers">The number of receivers.</param>
+		void benchmark(size_t receivers);
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="MessageBenchmark"/> class.
+		/// </summary>
+		/// <param name="parameters">The parameters.</param>
+		MessageBenchmark(const Parameters & parameters);
+
+		/// <summary>
+		/// Runs the benchmark for all numbers of receivers.
+		/// </summary>
+		void run();
+
+		/// <summary>
+		/// Saves the results in CSV and JSON format.
+		/// </summary>
+		void save() const;
+
+		/// <summary>
+		/// Gets the results (one row per number of receivers and operation).
+		/// </summary>
+		/// <returns></returns>
+		const ResultTable & getResults() const { return m_results; }
+
+		/// <summary>
+		/// Entry point of the benchmark: runs it and saves the results.
+		/// </summary>
+		/// <param name="parameters">The parameters.</param>
+		/// <returns>The exit code of the application.</returns>
+		static int main(const Parameters & parameters);
+	};
+}
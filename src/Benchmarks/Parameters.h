@@ -0,0 +1,162 @@
+#pragma once
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <unordered_map>
+#include <filesystem>
+#include <stdexcept>
+#include <vector>
+
+namespace Benchmarks
+{
+	/// <summary>
+	/// Parameters of a benchmark. Parameters are key=value pairs provided on the command line or read from a configuration file
+	/// (one pair per line, lines starting with # are comments).
+	/// </summary>
+	class Parameters
+	{
+		std::unordered_map<std::string, std::string> m_values;
+
+		/// <summary>
+		/// Removes the leading and trailing blanks of a string.
+		/// </summary>
+		/// <param name="value">The value.</param>
+		/// <returns></returns>
+		static std::string trim(const std::string & value)
+		{
+			const char * blanks = " \t\r\n";
+			size_t first = value.find_first_not_of(blanks);
+			if (first == std::string::npos) { return std::string(); }
+			size_t last = value.find_last_not_of(blanks);
+			return value.substr(first, last - first + 1);
+		}
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="Parameters"/> class.
+		/// </summary>
+		Parameters()
+		{}
+
+		/// <summary>
+		/// Initializes a new instance of the <see cref="Parameters"/> class from the command line arguments. Arguments that are not of the form key=value are ignored.
+		/// The special argument config=file loads the provided configuration file, values provided on the command line override values of the file.
+		/// </summary>
+		/// <param name="argc">The number of arguments.</param>
+		/// <param name="argv">The arguments.</param>
+		Parameters(int argc, char ** argv)
+		{
+			for (int cpt = 0; cpt < argc; ++cpt)
+			{
+				if (parse(argv[cpt]) && has("config"))
+				{
+					std::string config = getString("config");
+					m_values.erase("config");
+					load(config);
+				}
+			}
+		}
+
+		/// <summary>
+		/// Parses a key=value pair and records it.
+		/// </summary>
+		/// <param name="line">The line.</param>
+		/// <returns> true if the line was a valid key=value pair. </returns>
+		bool parse(const std::string & line)
+		{
+			std::string tmp = trim(line);
+			size_t separator = tmp.find('=');
+			if (tmp.empty() || tmp[0] == '#' || separator == std::string::npos) { return false; }
+			m_values[trim(tmp.substr(0, separator))] = trim(tmp.substr(separator + 1));
+			return true;
+		}
+
+		/// <summary>
+		/// Loads the parameters contained in a configuration file. Values already defined are overriden.
+		/// </summary>
+		/// <param name="file">The file.</param>
+		void load(const std::filesystem::path & file)
+		{
+			std::ifstream input(file);
+			if (!input) { throw std::runtime_error("Benchmarks::Parameters: unable to open " + file.string()); }
+			std::string line;
+			while (std::getline(input, line))
+			{
+				parse(line);
+			}
+		}
+
+		/// <summary>
+		/// Determines whether a value is associated with the provided key.
+		/// </summary>
+		/// <param name="key">The key.</param>
+		/// <returns></returns>
+		bool has(const std::string & key) const
+		{
+			return m_values.find(key) != m_values.end();
+		}
+
+		/// <summary>
+		/// Sets the value associated with a key.
+		/// </summary>
+		/// <param name="key">The key.</param>
+		/// <param name="value">The value.</param>
+		template <typename Type>
+		void set(const std::string & key, const Type & value)
+		{
+			std::ostringstream out;
+			out << value;
+			m_values[key] = out.str();
+		}
+
+		/// <summary>
+		/// Gets the value associated with a key, or the default value if the key is not defined.
+		/// </summary>
+		/// <param name="key">The key.</param>
+		/// <param name="defaultValue">The default value.</param>
+		/// <returns></returns>
+		template <typename Type>
+		Type get(const std::string & key, const Type & defaultValue = Type()) const
+		{
+			auto it = m_values.find(key);
+			if (it == m_values.end()) { return defaultValue; }
+			std::istringstream in(it->second);
+			Type result;
+			if (!(in >> result)) { throw std::runtime_error("Benchmarks::Parameters: invalid value for " + key + ": " + it->second); }
+			return result;
+		}
+
+		/// <summary>
+		/// Gets the string associated with a key, or the default value if the key is not defined.
+		/// </summary>
+		/// <param name="key">The key.</param>
+		/// <param name="defaultValue">The default value.</param>
+		/// <returns></returns>
+		std::string getString(const std::string & key, const std::string & defaultValue = std::string()) const
+		{
+			auto it = m_values.find(key);
+			if (it == m_values.end()) { return defaultValue; }
+			return it->second;
+		}
+
+		/// <summary>
+		/// Gets a comma separated list associated with a key.
+		/// </summary>
+		/// <param name="key">The key.</param>
+		/// <param name="defaultValue">The default value (comma separated).</param>
+		/// <returns></returns>
+		std::vector<std::string> getList(const std::string & key, const std::string & defaultValue) const
+		{
+			std::vector<std::string> result;
+			std::istringstream in(getString(key, defaultValue));
+			std::string item;
+			while (std::getline(in, item, ','))
+			{
+				item = trim(item);
+				if (!item.empty()) { result.push_back(item); }
+			}
+			return result;
+		}
+	};
+}
@@ -0,0 +1,200 @@
+#pragma once
+
+#include <Benchmarks/Parameters.h>
+#include <Benchmarks/ResultTable.h>
+#include <MotionPlanning/SixDofPlannerBase.h>
+#include <MotionPlanning/SamplingStrategy.h>
+#include <MotionPlanning/CollisionManager.h>
+#include <MotionPlanning/ClearanceFilter.h>
+#include <HelperGl/Mesh.h>
+#include <memory>
+#include <vector>
+#include <string>
+#include <functional>
+
+namespace Benchmarks
+{
+	/// <summary>
+	/// Headless benchmark of the six dof planners. For each scene (a .3ds world in the MotionPlanning data directory), a set of
+	/// collision free start / target queries is generated from a seed, and each planner is run on every query. Time to solution,
+	/// number of samples, of collision checks, of nodes, path length and success are recorded in a <see cref="ResultTable"/>.
+	///
+	/// Recognized parameters (key=value):
+	/// - scenes: comma separated list of worlds (default world_simple.3ds,world.3ds,world2.3ds,world3.3ds)
+	/// - mobile: the mobile (default mobile.3ds)
+	/// - planners: comma separated list among rrt, birrt, prm, prm-batch, experience (default rrt,birrt,prm). prm-batch answers all the queries
+	///   of a scene in parallel over a frozen roadmap. experience reuses the paths of previous queries (see <see cref="MotionPlanning::ExperiencePlanner"/>).
+	/// - queries: the number of queries per scene (default 20)
+	/// - passes: the number of times the queries of a scene are solved, multi query planners keep their state between passes (default 1)
+	/// - experienceRadius, repairSampleLimit: the retrieval radius and the sample limit of path repairs of the experience planner (default 0.5, 1000)
+	/// - seed: the seed used to generate the queries and to seed the planners (default 1)
+	/// - sampler: the configuration sampler used by the planners among uniform, halton, sobol (default uniform)
+	/// - strategy: the sampling strategy among uniform, gaussian, bridge, obstacle (default uniform)
+	/// - sigma: the standard deviation used by the gaussian and bridge test strategies (default 0.1)
+	/// - radius: the extension radius of the RRT planners (default 0.1)
+	/// - dq: the resolution used to validate local paths (default 0.02)
+	/// - filterCell: the cell size of the clearance filter answering collision tests of certainly free configurations before fcl (default 0,
+	///   no filter). The filter is built once per scene.
+	/// - edge: the validation of local paths, discrete (sampled at resolution dq) or continuous (default discrete)
+	/// - prmNodes, prmNeighbours: size of the initial roadmap and connection neighbourhood of the PRM (default 1000, 10)
+	/// - sampleLimit: the maximum number of samples allowed per query (default 100000)
+	/// - output: prefix of the result files, output.csv / output.json contain one row per query, output_summary.csv /
+	///   output_summary.json one row per scene and planner (default planning_benchmark)
+	/// </summary>
+	class PlanningBenchmark
+	{
+	public:
+		using Configuration = MotionPlanning::SixDofPlannerBase::Configuration;
+
+		/// <summary>
+		/// A planning query.
+		/// </summary>
+		struct Query
+		{
+			Configuration m_start;
+			Configuration m_target;
+		};
+
+		/// <summary>
+		/// A loaded scene: a static world and the mobile registered in their own collision manager.
+		/// </summary>
+		struct Scene
+		{
+			std::string m_name;
+			std::unique_ptr<MotionPlanning::CollisionManager> m_collisionManager;
+			std::unique_ptr<HelperGl::Mesh> m_worldMesh;
+			std::unique_ptr<HelperGl::Mesh> m_mobileMesh;
+			MotionPlanning::CollisionManager::DynamicCollisionObject m_mobile;
+			std::vector<Query> m_queries;
+			std::shared_ptr<const MotionPlanning::ClearanceFilter> m_clearanceFilter;
+		};
+
+		/// <summary>
+		/// The outcome of a single planning query.
+		/// </summary>
+		struct Outcome
+		{
+			bool m_success;
+			double m_time;
+			MotionPlanning::SixDofPlannerBase::Statistics m_statistics;
+			float m_pathLength;
+			size_t m_pathSize;
+		};
+
+	protected:
+		Parameters m_parameters;
+		ResultTable m_results;
+		ResultTable m_summary;
+
+		/// <summary>
+		/// Loads a 3ds file and merges all its meshes into one collision mesh.
+		/// </summary>
+		/// <param name="file">The file name (relative to the MotionPlanning data directory).</param>
+		/// <returns></returns>
+		std::unique_ptr<HelperGl::Mesh> loadMesh(const std::string & file) const;
+
+		/// <summary>
+		/// Loads a scene and generates its queries.
+		/// </summary>
+		/// <param name="world">The world file.</param>
+		/// <returns></returns>
+		std::unique_ptr<Scene> loadScene(const std::string & world) const;
+
+		/// <summary>
+		/// Generates the seeded collision free queries of a scene.
+		/// </summary>
+		/// <param name="scene">The scene.</param>
+		void generateQueries(Scene & scene) const;
+
+		/// <summary>
+		/// Creates the configuration sampler selected by the parameters.
+		/// </summary>
+		/// <returns></returns>
+		std::unique_ptr<MotionPlanning::ConfigurationSampler> createSampler() const;
+
+		/// <summary>
+		/// Creates the sampling strategy selected by the parameters (nullptr for uniform sampling).
+		/// </summary>
+		/// <returns></returns>
+		std::unique_ptr<MotionPlanning::SamplingStrategy> createStrategy() const;
+
+		/// <summary>
+		/// Sets the sampler, the sampling strategy, the edge validation, the clearance filter of the scene and the seed of a newly created planner.
+		/// </summary>
+		/// <param name="planner">The planner.</param>
+		/// <param name="scene">The scene the planner is created for.</param>
+		/// <returns>The planner.</returns>
+		MotionPlanning::SixDofPlannerBase * configure(MotionPlanning::SixDofPlannerBase * planner, const Scene & scene) const;
+
+		/// <summary>
+		/// Runs a planner on a query and measures the outcome.
+		/// </summary>
+		/// <param name="planner">The planner.</param>
+		/// <param name="query">The query.</param>
+		/// <returns></returns>
+		Outcome solve(MotionPlanning::SixDofPlannerBase & planner, const Query & query) const;
+
+		/// <summary>
+		/// Runs a planner on all the queries of a scene. The factory creates a planner for each query, if it returns the same planner, the
+		/// planner is reused between queries (multi query planners).
+		/// </summary>
+		/// <param name="scene">The scene.</param>
+		/// <param name="plannerName">Name of the planner.</param>
+		/// <param name="factory">The planner factory, called with the index of the query.</param>
+		void benchmark(const Scene & scene, const std::string & plannerName, const std::function<MotionPlanning::SixDofPlannerBase*(size_t)> & factory);
+
+		/// <summary>
+		/// Answers all the queries of a scene with one batch over a frozen PRM roadmap.
+		/// </summary>
+		/// <param name="scene">The scene.</param>
+		void benchmarkBatch(const Scene & scene);
+
+		/// <summary>
+		/// Records the outcome of a query.
+		/// </summary>
+		void record(const std::string & scene, const std::string & planner, size_t query, const Outcome & outcome);
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="PlanningBenchmark"/> class.
+		/// </summary>
+		/// <param name="parameters">The parameters.</param>
+		PlanningBenchmark(const Parameters & parameters);
+
+		/// <summary>
+		/// Runs the benchmark on all scenes and all planners.
+		/// </summary>
+		void run();
+
+		/// <summary>
+		/// Saves the results (per query and summary) in CSV and JSON format.
+		/// </summary>
+		void save() const;
+
+		/// <summary>
+		/// Gets the results (one row per query).
+		/// </summary>
+		/// <returns></returns>
+		const ResultTable & getResults() const { return m_results; }
+
+		/// <summary>
+		/// Gets the summary (one row per scene and planner).
+		/// </summary>
+		/// <returns></returns>
+		const ResultTable & getSummary() const { return m_summary; }
+
+		/// <summary>
+		/// Computes the length of a path in the configuration space.
+		/// </summary>
+		/// <param name="path">The path.</param>
+		/// <returns></returns>
+		static float pathLength(const std::vector<Configuration> & path);
+
+		/// <summary>
+		/// Entry point of the benchmark: runs it and saves the results.
+		/// </summary>
+		/// <param name="parameters">The parameters.</param>
+		/// <returns>The exit code of the application.</returns>
+		static int main(const Parameters & parameters);
+	};
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <vector>
+#include <filesystem>
+#include <stdexcept>
+#include <cassert>
+#include <type_traits>
+#include <cmath>
+
+namespace Benchmarks
+{
+	/// <summary>
+	/// A table of benchmark results. Each row is a record of named values. The table can be saved in CSV or JSON format
+	/// so that results can be compared between several versions of the code.
+	/// </summary>
+	class ResultTable
+	{
+	public:
+		/// <summary>
+		/// A cell of the table.
+		/// </summary>
+		struct Cell
+		{
+			/// <summary>
+			/// The textual representation of the value, empty for a missing number (null in JSON).
+			/// </summary>
+			std::string m_value;
+			/// <summary>
+			/// Is the value a number (no quotes in JSON).
+			/// </summary>
+			bool m_isNumber;
+		};
+
+		/// <summary>
+		/// A row of the table. Values are provided in the order of the columns.
+		/// </summary>
+		class Row
+		{
+			friend class ResultTable;
+
+			std::vector<Cell> m_cells;
+
+		public:
+			/// <summary>
+			/// Appends a value to the row. Non finite floating point values (e.g. a ratio with a zero denominator) are missing values:
+			/// empty cell in CSV, null in JSON.
+			/// </summary>
+			/// <param name="value">The value.</param>
+			/// <returns></returns>
+			template <typename Type>
+			Row & operator << (const Type & value)
+			{
+				std::ostringstream out;
+				if constexpr (std::is_same<Type, bool>::value) { out << (value ? "true" : "false"); }
+				else if constexpr (std::is_floating_point<Type>::value) { if (std::isfinite(value)) { out << value; } }
+				else { out << value; }
+				m_cells.push_back(Cell{ out.str(), std::is_arithmetic<Type>::value });
+				return (*this);
+			}
+
+			/// <summary>
+			/// Appends a string to the row.
+			/// </summary>
+			/// <param name="value">The value.</param>
+			/// <returns></returns>
+			Row & operator << (const char * value)
+			{
+				m_cells.push_back(Cell{ value, false });
+				return (*this);
+			}
+		};
+
+	protected:
+		std::vector<std::string> m_columns;
+		std::vector<Row> m_rows;
+
+		/// <summary>
+		/// Escapes a string for the CSV format.
+		/// </summary>
+		/// <param name="value">The value.</param>
+		/// <returns></returns>
+		static std::string escapeCsv(const std::string & value)
+		{
+			if (value.find_first_of(",\"\n") == std::string::npos) { return value; }
+			std::string result = "\"";
+			for (char c : value)
+			{
+				if (c == '"') { result += '"'; }
+				result += c;
+			}
+			return result + "\"";
+		}
+
+		/// <summary>
+		/// Escapes a string for the JSON format.
+		/// </summary>
+		/// <param name="value">The value.</param>
+		/// <returns></returns>
+		static std::string escapeJson(const std::string & value)
+		{
+			std::string result = "\"";
+			for (char c : value)
+			{
+				if (c == '"' || c == '\\') { result += '\\'; result += c; }
+				else if (c == '\n') { result += "\\n"; }
+				else { result += c; }
+			}
+			return result + "\"";
+		}
+
+		/// <summary>
+		/// Opens a file for writing.
+		/// </summary>
+		/// <param name="file">The file.</param>
+		/// <returns></returns>
+		static std::ofstream open(const std::filesystem::path & file)
+		{
+			std::ofstream output(file);
+			if (!output) { throw std::runtime_error("Benchmarks::ResultTable: unable to write " + file.string()); }
+			return output;
+		}
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="ResultTable"/> class.
+		/// </summary>
+		/// <param name="columns">The names of the columns.</param>
+		ResultTable(const std::vector<std::string> & columns)
+			: m_columns(columns)
+		{}
+
+		/// <summary>
+		/// Adds a new row in the table.
+		/// </summary>
+		/// <param name="row">The row.</param>
+		void add(const Row & row)
+		{
+			assert(row.m_cells.size() == m_columns.size());
+			m_rows.push_back(row);
+		}
+
+		/// <summary>
+		/// Returns the number of rows.
+		/// </summary>
+		/// <returns></returns>
+		size_t size() const { return m_rows.size(); }
+
+		/// <summary>
+		/// Writes the table in CSV format (first line contains the name of the columns).
+		/// </summary>
+		/// <param name="out">The output stream.</param>
+		void writeCsv(std::ostream & out) const
+		{
+			for (size_t cpt = 0; cpt < m_columns.size(); ++cpt)
+			{
+				out << (cpt == 0 ? "" : ",") << escapeCsv(m_columns[cpt]);
+			}
+			out << std::endl;
+			for (auto it = m_rows.begin(), end = m_rows.end(); it != end; ++it)
+			{
+				for (size_t cpt = 0; cpt < it->m_cells.size(); ++cpt)
+				{
+					out << (cpt == 0 ? "" : ",") << escapeCsv(it->m_cells[cpt].m_value);
+				}
+				out << std::endl;
+			}
+		}
+
+		/// <summary>
+		/// Writes the table in JSON format (an array of objects, one per row).
+		/// </summary>
+		/// <param name="out">The output stream.</param>
+		void writeJson(std::ostream & out) const
+		{
+			out << "[" << std::endl;
+			for (size_t row = 0; row < m_rows.size(); ++row)
+			{
+				out << "  {";
+				const std::vector<Cell> & cells = m_rows[row].m_cells;
+				for (size_t cpt = 0; cpt < cells.size(); ++cpt)
+				{
+					out << (cpt == 0 ? " " : ", ") << escapeJson(m_columns[cpt]) << ": ";
+					if (!cells[cpt].m_isNumber) { out << escapeJson(cells[cpt].m_value); }
+					else { out << (cells[cpt].m_value.empty() ? "null" : cells[cpt].m_value); }
+				}
+				out << " }" << (row + 1 == m_rows.size() ? "" : ",") << std::endl;
+			}
+			out << "]" << std::endl;
+		}
+
+		/// <summary>
+		/// Saves the table. The format depends on the extension of the file (.json for JSON, CSV otherwise).
+		/// </summary>
+		/// <param name="file">The file.</param>
+		void save(const std::filesystem::path & file) const
+		{
+			std::ofstream output = open(file);
+			if (file.extension() == ".json") { writeJson(output); }
+			else { writeCsv(output); }
+		}
+	};
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <Benchmarks/Parameters.h>
+#include <Benchmarks/ResultTable.h>
+#include <string>
+
+namespace Benchmarks
+{
+	/// <summary>
+	/// Headless benchmark and cross check of the task trees. For each number of agents, the same behaviour is built as one classic tree
+	/// per agent (AI/Tasks/Operators.h) and as one compiled tree with a state block per agent (AI/Tasks/CompiledTree.h). The tree uses
+	/// all the operators except randomPick (the classic one is not seeded), including a firstOf whose first tasks may sleep
+	/// (preconditions). Its leaves draw their status from a random stream of the agent and record their calls. Both versions are ticked
+	/// for a number of steps of a simulated clock. The statuses returned at each tick and the order of the initialization, activity and
+	/// finalization calls must be the same, a divergence is reported as an error. The tick times of both versions are recorded in a
+	/// <see cref="ResultTable"/>.
+	///
+	/// Recognized parameters (key=value):
+	/// - agents: comma separated list of numbers of agents (default 1000,10000)
+	/// - ticks: the number of ticks (default 200)
+	/// - dt: the time step of the simulated clock between two ticks (default 0.1)
+	/// - seed: the seed of the random streams of the agents (default 1)
+	/// - output: prefix of the result files output.csv / output.json (default task_benchmark)
+	/// </summary>
+	class TaskBenchmark
+	{
+		Parameters m_parameters;
+		ResultTable m_results;
+
+		/// <summary>
+		/// Ticks the classic and compiled trees of the provided number of agents and compares them.
+		/// </summary>
+		/// <param name="agents">The number of agents.</param>
+		void benchmark(size_t agents);
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="TaskBenchmark"/> class.
+		/// </summary>
+		/// <param name="parameters">The parameters.</param>
+		TaskBenchmark(const Parameters & parameters);
+
+		/// <summary>
+		/// Runs the benchmark for all numbers of agents.
+		/// </summary>
+		void run();
+
+		/// <summary>
+		/// Saves the results in CSV and JSON format.
+		/// </summary>
+		void save() const;
+
+		/// <summary>
+		/// Gets the results (one row per number of agents).
+		/// </summary>
+		/// <returns></returns>
+		const ResultTable & getResults() const { return m_results; }
+
+		/// <summary>
+		/// Entry point of the benchmark: runs it and saves the results.
+		/// </summary>
+		/// <param name="parameters">The parameters.</param>
+		/// <returns>The exit code of the application.</returns>
+		static int main(const Parameters & parameters);
+	};
+}
@@ -0,0 +1,163 @@
+#include <Benchmarks/BlackboardBenchmark.h>
+#include <AI/Blackboard.h>
+#include <stdext/chrono/timer.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace Benchmarks
+{
+	namespace
+	{
+		/// <summary>
+		/// Identifier of the variable number index (double for even indices, std::string for odd ones).
+		/// </summary>
+		std::string identifier(size_t index)
+		{
+			return "blackboard_benchmark_" + std::to_string(index);
+		}
+
+		/// <summary>
+		/// The value written in the variable number index of the blackboard number board.
+		/// </summary>
+		double expectedValue(size_t board, size_t index)
+		{
+			return double(board) * 1000.0 + double(index);
+		}
+	}
+
+	BlackboardBenchmark::BlackboardBenchmark(const Parameters & parameters)
+		: m_parameters(parameters),
+		m_results({ "operation", "blackboards", "keys", "requests", "time", "requests_per_second" })
+	{}
+
+	void BlackboardBenchmark::checkKeys()
+	{
+		size_t keys = m_parameters.get<size_t>("keys", 16);
+		// Each identifier is interned by 64 tasks at the same time
+		size_t copies = 64;
+		std::vector<std::uint32_t> slots(keys * copies);
+		::tbb::parallel_for(::tbb::blocked_range<size_t>(0, slots.size(), 1), [&](const ::tbb::blocked_range<size_t> & range)
+		{
+			for (size_t cpt = range.begin(); cpt != range.end(); ++cpt)
+			{
+				size_t index = cpt % keys;
+				slots[cpt] = (index % 2 == 0) ? AI::Blackboard::key<double>(identifier(index)).getSlot() : AI::Blackboard::key<std::string>(identifier(index)).getSlot();
+			}
+		});
+		for (size_t cpt = 0; cpt < slots.size(); ++cpt)
+		{
+			if (slots[cpt] != slots[cpt % keys])
+			{
+				throw std::runtime_error("key " + identifier(cpt % keys) + ": interned in several slots by concurrent threads");
+			}
+		}
+		std::cout << keys * copies << " concurrent key creations, " << keys << " slots" << std::endl;
+	}
+
+	void BlackboardBenchmark::benchmark(size_t blackboards)
+	{
+		size_t keys = m_parameters.get<size_t>("keys", 16);
+		std::vector<AI::Blackboard::Key<double>> doubleKeys;
+		std::vector<AI::Blackboard::Key<std::string>> stringKeys;
+		std::vector<std::string> identifiers;
+		for (size_t index = 0; index < keys; ++index)
+		{
+			identifiers.push_back(identifier(index));
+			if (index % 2 == 0) { doubleKeys.push_back(AI::Blackboard::key<double>(identifier(index))); }
+			else { stringKeys.push_back(AI::Blackboard::key<std::string>(identifier(index))); }
+		}
+		std::vector<AI::Blackboard> boards(blackboards);
+		size_t requests = blackboards * keys;
+		// The expected values are computed once, the measures only include the requests and the comparisons
+		std::vector<std::string> expectedStrings(requests);
+		for (size_t cpt = 0; cpt < requests; ++cpt) { expectedStrings[cpt] = std::to_string(expectedValue(cpt % blackboards, cpt / blackboards)); }
+		// Request number cpt accesses the variable cpt / blackboards of the blackboard cpt % blackboards: the tasks working on distinct
+		// variables access the same blackboards at the same time
+		auto measure = [&](const std::string & operation, bool parallel, const auto & request)
+		{
+			std::atomic<size_t> errors(0);
+			auto process = [&](const ::tbb::blocked_range<size_t> & range)
+			{
+				size_t local = 0;
+				for (size_t cpt = range.begin(); cpt != range.end(); ++cpt)
+				{
+					if (!request(boards[cpt % blackboards], cpt)) { ++local; }
+				}
+				errors += local;
+			};
+			stdext::chrono::timer<> timer;
+			timer.start();
+			if (parallel) { ::tbb::parallel_for(::tbb::blocked_range<size_t>(0, requests), process); }
+			else { process(::tbb::blocked_range<size_t>(0, requests)); }
+			timer.stop();
+			double time = timer.elapsed_time().count();
+			if (errors != 0) { throw std::runtime_error(operation + ": " + std::to_string(size_t(errors)) + " values differ from the written ones"); }
+			std::cout << operation << " / " << blackboards << " blackboards: " << time << "s, " << requests / time << " requests/s" << std::endl;
+			ResultTable::Row row;
+			row << operation << blackboards << keys << requests << time << requests / time;
+			m_results.add(row);
+		};
+		measure("write_key_parallel", true, [&](AI::Blackboard & board, size_t cpt)
+		{
+			size_t index = cpt / blackboards;
+			if (index % 2 == 0) { board.get(doubleKeys[index / 2]) = expectedValue(cpt % blackboards, index); }
+			else { board.get(stringKeys[index / 2]) = expectedStrings[cpt]; }
+			return true;
+		});
+		auto readKey = [&](AI::Blackboard & board, size_t cpt)
+		{
+			size_t index = cpt / blackboards;
+			if (index % 2 == 0) { return *board.get(doubleKeys[index / 2]) == expectedValue(cpt % blackboards, index); }
+			return *board.get(stringKeys[index / 2]) == expectedStrings[cpt];
+		};
+		auto readString = [&](AI::Blackboard & board, size_t cpt)
+		{
+			size_t index = cpt / blackboards;
+			if (index % 2 == 0) { return *board.get<double>(identifiers[index]) == expectedValue(cpt % blackboards, index); }
+			return *board.get<std::string>(identifiers[index]) == expectedStrings[cpt];
+		};
+		measure("read_key", false, readKey);
+		measure("read_key_parallel", true, readKey);
+		measure("read_string", false, readString);
+		measure("read_string_parallel", true, readString);
+	}
+
+	void BlackboardBenchmark::run()
+	{
+		checkKeys();
+		std::vector<std::string> blackboards = m_parameters.getList("blackboards", "1000,10000");
+		for (const std::string & count : blackboards)
+		{
+			benchmark(std::stoul(count));
+		}
+	}
+
+	void BlackboardBenchmark::save() const
+	{
+		std::string output = m_parameters.getString("output", "blackboard_benchmark");
+		m_results.save(output + ".csv");
+		m_results.save(output + ".json");
+		std::cout << "Results saved in " << output << ".csv / .json" << std::endl;
+	}
+
+	int BlackboardBenchmark::main(const Parameters & parameters)
+	{
+		try
+		{
+			BlackboardBenchmark benchmark(parameters);
+			benchmark.run();
+			benchmark.save();
+		}
+		catch (const std::exception & e)
+		{
+			std::cerr << "BlackboardBenchmark: " << e.what() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+}
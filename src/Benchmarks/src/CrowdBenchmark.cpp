@@ -0,0 +1,275 @@
+#include <Benchmarks/CrowdBenchmark.h>
+#include <Crowds/Boid.h>
+#include <Crowds/Trajectory.h>
+#include <stdext/chrono/timer.h>
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+#include <map>
+#include <random>
+
+namespace Benchmarks
+{
+	namespace
+	{
+		/// <summary>
+		/// A flocking agent only used by the benchmark: separation and alignment with the perceived neighbours.
+		/// </summary>
+		class BenchmarkAgent : public Crowds::Boid
+		{
+			float m_perception;
+
+		public:
+			BenchmarkAgent(Crowds::Simulator * simulator, const Math::Vector2f & position, float perception)
+				: Boid(simulator, position, 0.5f, 1.0f, 2.0f, 1.0f), m_perception(perception)
+			{}
+
+			virtual UpdateMode getUpdateMode() const override { return UpdateMode::twoPhase; }
+
+			virtual void steer(double dt) override
+			{
+				FlockingForces forces = flocking(m_perception);
+				addSteeringForce(forces.m_separation + forces.m_alignment);
+			}
+		};
+
+		/// <summary>
+		/// A goal directed agent only used by the benchmark: it walks toward its goal and avoids the perceived neighbours with the
+		/// reciprocal collision avoidance behaviour.
+		/// </summary>
+		class OrcaAgent : public Crowds::Boid
+		{
+			Math::Vector2f m_goal;
+			float m_perception;
+
+		public:
+			OrcaAgent(Crowds::Simulator * simulator, const Math::Vector2f & position, const Math::Vector2f & goal, float perception)
+				: Boid(simulator, position, 0.5f, 1.0f, 2.0f, 1000.0f), m_goal(goal), m_perception(perception)
+			{}
+
+			virtual UpdateMode getUpdateMode() const override { return UpdateMode::twoPhase; }
+
+			virtual void steer(double dt) override
+			{
+				Math::Vector2f toGoal = m_goal - getPosition();
+				float distance = toGoal.norm();
+				Math::Vector2f preferredSpeed = distance > getMaxSpeed() * float(dt) ? toGoal * (getMaxSpeed() / distance) : toGoal / float(dt);
+				addSteeringForce(reciprocalAvoidance(preferredSpeed, m_perception, 2.0f, float(dt)));
+			}
+		};
+
+		/// <summary>
+		/// The positions and statuses of the slots of a kinematic storage at a recorded step, compared with the frame read back from the
+		/// trajectory file.
+		/// </summary>
+		struct RecordedState
+		{
+			std::vector<Math::Vector2f> m_positions;
+			std::vector<std::uint8_t> m_statuses;
+
+			void capture(const Crowds::KinematicStorage & kinematics)
+			{
+				m_positions.clear();
+				m_statuses.clear();
+				for (Crowds::KinematicStorage::Index index = 0; index < kinematics.slots(); ++index)
+				{
+					m_positions.push_back(kinematics.position(index));
+					m_statuses.push_back(kinematics.getAgent(index) == nullptr ? Crowds::TrajectoryFrame::freeSlot : kinematics.status(index));
+				}
+			}
+
+			/// <summary>
+			/// Tests if a replayed frame matches this state: same statuses and positions within the quantization step.
+			/// </summary>
+			bool matches(const Crowds::TrajectoryFrame & frame, float quantum) const
+			{
+				if (frame.size() != m_statuses.size()) { return false; }
+				for (size_t index = 0; index < m_statuses.size(); ++index)
+				{
+					if (frame.m_statuses[index] != m_statuses[index]) { return false; }
+					if (m_statuses[index] == Crowds::TrajectoryFrame::freeSlot) { continue; }
+					Math::Vector2f error = frame.m_positions[index] - m_positions[index];
+					if (std::abs(error[0]) > quantum || std::abs(error[1]) > quantum) { return false; }
+				}
+				return true;
+			}
+		};
+	}
+
+	CrowdBenchmark::CrowdBenchmark(const Parameters & parameters)
+		: m_parameters(parameters),
+		m_results({ "behaviour", "index", "agents", "rebuild_time", "query_time", "mean_neighbours", "step_time", "overlaps", "update_period" })
+	{}
+
+	std::unique_ptr<Crowds::NeighbourhoodIndex> CrowdBenchmark::createIndex(const std::string & name) const
+	{
+		if (name == "grid")
+		{
+			float perception = m_parameters.get<float>("perception", 10.0f);
+			return std::unique_ptr<Crowds::NeighbourhoodIndex>(new Crowds::GridIndex(m_parameters.get<float>("cellSize", perception)));
+		}
+		if (name == "vptree") { return std::unique_ptr<Crowds::NeighbourhoodIndex>(new Crowds::VPTreeIndex); }
+		if (name == "regions")
+		{
+			// The halo covers the perception radius: the requests of the agents only visit the index of their region
+			float perception = m_parameters.get<float>("perception", 10.0f);
+			return std::unique_ptr<Crowds::NeighbourhoodIndex>(new Crowds::RegionIndex(createIndex("grid"), m_parameters.get<size_t>("regions", 16), perception));
+		}
+		throw std::runtime_error("CrowdBenchmark: unknown neighbourhood index " + name);
+	}
+
+	void CrowdBenchmark::benchmark(size_t agents, const std::string & index, const std::string & behaviour)
+	{
+		float perception = m_parameters.get<float>("perception", 10.0f);
+		float density = m_parameters.get<float>("density", 0.02f);
+		size_t steps = m_parameters.get<size_t>("steps", 10);
+		double dt = m_parameters.get<double>("dt", 0.1);
+		unsigned int updatePeriod = m_parameters.get<unsigned int>("updatePeriod", 1);
+		float side = std::sqrt(float(agents) / density);
+		// The initial state only depends on the seed
+		std::srand(m_parameters.get<unsigned int>("seed", 1));
+		Crowds::Simulator simulator;
+		simulator.setNeighbourhoodIndex(createIndex(index));
+		Math::Interval<float> coordinates(0.0f, side), speeds(-1.0f, 1.0f);
+		Math::Vector2f center = Math::makeVector(side, side) * 0.5f;
+		for (size_t cpt = 0; cpt < agents; ++cpt)
+		{
+			Math::Vector2f position = Math::makeVector(coordinates.random(), coordinates.random());
+			if (behaviour == "flocking")
+			{
+				std::shared_ptr<BenchmarkAgent> agent = simulator.createAgent<BenchmarkAgent>(position, perception);
+				agent->setSpeed(Math::makeVector(speeds.random(), speeds.random()));
+			}
+			else if (behaviour == "orca")
+			{
+				// The goal is the opposite position: the agents cross the center of the square
+				simulator.createAgent<OrcaAgent>(position, center * 2.0f - position, perception);
+			}
+			else { throw std::runtime_error("CrowdBenchmark: unknown behaviour " + behaviour); }
+			simulator.getAgents().back()->setUpdatePeriod(updatePeriod);
+		}
+		// The index alone: rebuild and one request per agent
+		std::unique_ptr<Crowds::NeighbourhoodIndex> probe = createIndex(index);
+		for (const std::shared_ptr<Crowds::Agent> & agent : simulator.getAgents()) { probe->add(agent); }
+		stdext::chrono::timer<> timer;
+		timer.start();
+		probe->rebuild();
+		timer.stop();
+		double rebuildTime = timer.elapsed_time().count();
+		std::vector<std::shared_ptr<Crowds::Agent>> neighbours;
+		size_t neighbourCount = 0;
+		timer.start();
+		for (const std::shared_ptr<Crowds::Agent> & agent : simulator.getAgents())
+		{
+			neighbours.clear();
+			probe->select(agent->getPosition(), perception, neighbours);
+			neighbourCount += neighbours.size();
+		}
+		timer.stop();
+		double queryTime = timer.elapsed_time().count();
+		// Full simulation steps (agent updates and rebuild of the index of the simulator)
+		std::unique_ptr<Crowds::TrajectoryRecorder> recorder;
+		std::string record = m_parameters.getString("record", "");
+		std::string trajectory = record + "_" + behaviour + "_" + index + "_" + std::to_string(agents) + ".traj";
+		// The states of some random frames are kept to check the file once the recorder is closed (frame 0 is the initial state)
+		std::map<size_t, RecordedState> verified;
+		if (!record.empty())
+		{
+			std::minstd_rand frames(m_parameters.get<unsigned int>("seed", 1));
+			for (size_t cpt = 0, count = m_parameters.get<size_t>("verifyFrames", 4); cpt < count; ++cpt)
+			{
+				verified[std::uniform_int_distribution<size_t>(0, steps)(frames)];
+			}
+			recorder.reset(new Crowds::TrajectoryRecorder(trajectory));
+			recorder->record(simulator);
+		}
+		auto capture = [&verified, &simulator](size_t frame)
+		{
+			auto found = verified.find(frame);
+			if (found != verified.end()) { found->second.capture(simulator.getKinematics()); }
+		};
+		if (recorder) { capture(0); }
+		timer.start();
+		for (size_t cpt = 0; cpt < steps; ++cpt)
+		{
+			simulator.update(dt);
+			if (recorder)
+			{
+				recorder->record(simulator);
+				capture(cpt + 1);
+			}
+		}
+		timer.stop();
+		double stepTime = steps == 0 ? 0.0 : timer.elapsed_time().count() / steps;
+		if (recorder)
+		{
+			recorder->close();
+			// Replay: the frames read back must match the simulation up to the quantization
+			Crowds::TrajectoryReader reader(trajectory);
+			if (reader.getFrameCount() != steps + 1) { throw std::runtime_error("CrowdBenchmark: " + trajectory + " does not contain all the recorded frames"); }
+			for (const auto & frame : verified)
+			{
+				if (!frame.second.matches(reader.read(frame.first), reader.getPositionQuantum()))
+				{
+					throw std::runtime_error("CrowdBenchmark: frame " + std::to_string(frame.first) + " of " + trajectory + " differs from the simulation");
+				}
+			}
+			std::cout << "Replay of " << trajectory << ": " << verified.size() << " frames verified" << std::endl;
+		}
+		// Number of pairs of overlapping agents at the end of the simulation
+		size_t overlaps = 0;
+		for (const std::shared_ptr<Crowds::Agent> & agent : simulator.getAgents())
+		{
+			simulator.forEachNeighbour(agent->getPosition(), 2.0f * agent->getRadius(), [&](const Crowds::Agent & other)
+			{
+				float distance = (other.getPosition() - agent->getPosition()).norm();
+				if (&other < agent.get() && distance < other.getRadius() + agent->getRadius()) { ++overlaps; }
+			});
+		}
+		std::cout << behaviour << " / " << index << " / " << agents << " agents: rebuild " << rebuildTime << "s, requests " << queryTime << "s, step " << stepTime << "s, " << overlaps << " overlaps" << std::endl;
+		ResultTable::Row row;
+		row << behaviour << index << agents << rebuildTime << queryTime << double(neighbourCount) / std::max<size_t>(agents, 1) << stepTime << overlaps << updatePeriod;
+		m_results.add(row);
+	}
+
+	void CrowdBenchmark::run()
+	{
+		std::vector<std::string> populations = m_parameters.getList("agents", "1000,10000,100000");
+		std::vector<std::string> indexes = m_parameters.getList("indexes", "grid,vptree");
+		std::vector<std::string> behaviours = m_parameters.getList("behaviours", "flocking");
+		for (const std::string & behaviour : behaviours)
+		{
+			for (const std::string & population : populations)
+			{
+				for (const std::string & index : indexes)
+				{
+					benchmark(std::stoul(population), index, behaviour);
+				}
+			}
+		}
+	}
+
+	void CrowdBenchmark::save() const
+	{
+		std::string output = m_parameters.getString("output", "crowd_benchmark");
+		m_results.save(output + ".csv");
+		m_results.save(output + ".json");
+		std::cout << "Results saved in " << output << ".csv / .json" << std::endl;
+	}
+
+	int CrowdBenchmark::main(const Parameters & parameters)
+	{
+		try
+		{
+			CrowdBenchmark benchmark(parameters);
+			benchmark.run();
+			benchmark.save();
+		}
+		catch (const std::exception & e)
+		{
+			std::cerr << "CrowdBenchmark: " << e.what() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+}
@@ -0,0 +1,137 @@
+#include <Benchmarks/CrowdScenario.h>
+#include <Crowds/Prey.h>
+#include <Crowds/Predator.h>
+#include <Crowds/Water.h>
+#include <Crowds/Messages.h>
+#include <stdext/chrono/simulated_clock.h>
+#include <stdext/chrono/timer.h>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+
+namespace Benchmarks
+{
+	CrowdScenario::CrowdScenario(const Parameters & parameters)
+		: m_parameters(parameters),
+		m_results({ "preys", "predators", "water", "seed", "steps", "tick_ms", "perception_ms", "steering_ms", "integration_ms",
+			"index_rebuild_ms", "delivery_ms", "sequential_ms", "killed", "checksum" }),
+		m_killed(0)
+	{}
+
+	void CrowdScenario::populate(Crowds::Simulator & simulator) const
+	{
+		float half = m_parameters.get<float>("size", 100.0f) * 0.5f;
+		Math::Interval<float> coordinates(-half, half);
+		// Same distributions as the interactive application (SIAA_TP5_behavior)
+		size_t preys = m_parameters.get<size_t>("preys", 1500);
+		for (size_t cpt = 0; cpt < preys; ++cpt)
+		{
+			Math::Vector2f position = Math::makeVector(coordinates.random(), coordinates.random());
+			float radius = Math::Interval<float>(0.3f, 0.6f).random();
+			float mass = Math::Interval<float>(6.0f, 8.0f).random();
+			float maxSpeed = Math::Interval<float>(2.0f, 4.0f).random();
+			float maxForce = Math::Interval<float>(15.0f, 25.0f).random();
+			simulator.createAgent<Crowds::Prey>(position, radius, mass, maxSpeed, maxForce);
+		}
+		size_t predators = m_parameters.get<size_t>("predators", 30);
+		for (size_t cpt = 0; cpt < predators; ++cpt)
+		{
+			Math::Vector2f position = Math::makeVector(coordinates.random(), coordinates.random());
+			float radius = Math::Interval<float>(0.3f, 0.6f).random();
+			float mass = Math::Interval<float>(8.0f, 10.0f).random();
+			float maxSpeed = Math::Interval<float>(2.0f, 4.0f).random();
+			float maxForce = Math::Interval<float>(15.0f, 25.0f).random();
+			simulator.createAgent<Crowds::Predator>(position, radius, mass, maxSpeed, maxForce);
+		}
+		size_t water = m_parameters.get<size_t>("water", 30);
+		for (size_t cpt = 0; cpt < water; ++cpt)
+		{
+			Math::Vector2f position = Math::makeVector(coordinates.random(), coordinates.random());
+			float radius = Math::Interval<float>(8.0f, 12.0f).random();
+			simulator.createAgent<Crowds::Water>(position, radius);
+		}
+	}
+
+	std::uint64_t CrowdScenario::checksum(const Crowds::Simulator & simulator)
+	{
+		std::uint64_t result = 14695981039346656037ull;
+		for (const std::shared_ptr<Crowds::Agent> & agent : simulator.getAgents())
+		{
+			if (agent->getStatus() != Crowds::Agent::Status::running) { continue; }
+			for (int coordinate = 0; coordinate < 2; ++coordinate)
+			{
+				std::uint32_t bits;
+				std::memcpy(&bits, &agent->getPosition()[coordinate], sizeof(bits));
+				result = (result ^ bits) * 1099511628211ull;
+			}
+		}
+		return result;
+	}
+
+	void CrowdScenario::run()
+	{
+		unsigned int seed = m_parameters.get<unsigned int>("seed", 1);
+		size_t steps = m_parameters.get<size_t>("steps", 500);
+		size_t warmup = m_parameters.get<size_t>("warmup", 10);
+		double dt = m_parameters.get<double>("dt", 0.04);
+		// The initial state only depends on the seed, the decisions of the agents on the seed of the simulator
+		std::srand(seed);
+		Crowds::Simulator simulator;
+		simulator.setSeed(seed);
+		populate(simulator);
+		m_killed = 0;
+		simulator.createReceiver<Crowds::PreyKilledMessage>([this](const Crowds::PreyKilledMessage &) { ++m_killed; }, simulator.spyTarget());
+		auto tick = [&simulator, dt]()
+		{
+			stdext::chrono::simulated_clock::update(dt);
+			simulator.update(dt);
+		};
+		for (size_t cpt = 0; cpt < warmup; ++cpt) { tick(); }
+		simulator.resetProfile();
+		simulator.setProfiling(true);
+		stdext::chrono::timer<> timer;
+		timer.start();
+		for (size_t cpt = 0; cpt < steps; ++cpt) { tick(); }
+		const Crowds::Simulator::Profile & profile = simulator.getProfile();
+		timer.stop();
+		simulator.setProfiling(false);
+		// Milliseconds per tick
+		double scale = steps == 0 ? 0.0 : 1000.0 / steps;
+		std::uint64_t result = checksum(simulator);
+		std::cout << std::fixed << std::setprecision(3)
+			<< "Crowd scenario: " << simulator.getAgents().size() << " agents, " << steps << " steps, " << timer.elapsed_time().count() * scale << " ms/tick" << std::endl
+			<< "  perception " << profile.m_perception * scale << " ms, steering " << profile.m_steering * scale << " ms, integration " << profile.m_integration * scale
+			<< " ms, index rebuild " << profile.m_rebuild * scale << " ms, message delivery " << profile.m_delivery * scale << " ms, sequential agents " << profile.m_sequential * scale << " ms" << std::endl
+			<< "  " << m_killed << " preys killed, checksum " << std::hex << result << std::dec << std::defaultfloat << std::endl;
+		ResultTable::Row row;
+		row << m_parameters.get<size_t>("preys", 1500) << m_parameters.get<size_t>("predators", 30) << m_parameters.get<size_t>("water", 30) << seed << steps
+			<< timer.elapsed_time().count() * scale << profile.m_perception * scale << profile.m_steering * scale << profile.m_integration * scale
+			<< profile.m_rebuild * scale << profile.m_delivery * scale << profile.m_sequential * scale << m_killed << result;
+		m_results.add(row);
+	}
+
+	void CrowdScenario::save() const
+	{
+		std::string output = m_parameters.getString("output", "crowd_scenario");
+		m_results.save(output + ".csv");
+		m_results.save(output + ".json");
+		std::cout << "Results saved in " << output << ".csv / .json" << std::endl;
+	}
+
+	int CrowdScenario::main(const Parameters & parameters)
+	{
+		try
+		{
+			CrowdScenario scenario(parameters);
+			scenario.run();
+			scenario.save();
+		}
+		catch (const std::exception & e)
+		{
+			std::cerr << "CrowdScenario: " << e.what() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+}
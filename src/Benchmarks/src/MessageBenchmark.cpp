@@ -0,0 +1,119 @@
+#include <Benchmarks/MessageBenchmark.h>
+#include <stdext/message_handler.h>
+#include <stdext/chrono/timer.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+
+namespace Benchmarks
+{
+	namespace
+	{
+		/// <summary>
+		/// The message exchanged during the benchmark.
+		/// </summary>
+		struct BenchmarkMessage
+		{
+			size_t m_value;
+		};
+	}
+
+	MessageBenchmark::MessageBenchmark(const Parameters & parameters)
+		: m_parameters(parameters),
+		m_results({ "operation", "receivers", "deliveries", "time", "deliveries_per_second" })
+	{}
+
+	void MessageBenchmark::benchmark(size_t receivers)
+	{
+		size_t messages = m_parameters.get<size_t>("messages", 10);
+		stdext::message_handler handler;
+		// The addresses of the targets identify the receivers
+		std::vector<int> targets(receivers);
+		size_t delivered = 0;
+		std::vector<stdext::message_handler::receiver_callback<BenchmarkMessage>*> created;
+		created.reserve(receivers);
+		for (int & target : targets)
+		{
+			created.push_back(handler.createReceiver<BenchmarkMessage>([&delivered](const BenchmarkMessage & message) { delivered += message.m_value; }, &target));
+		}
+		auto measure = [&](const std::string & operation, const auto & dispatch)
+		{
+			delivered = 0;
+			stdext::chrono::timer<> timer;
+			timer.start();
+			dispatch();
+			timer.stop();
+			double time = timer.elapsed_time().count();
+			if (delivered != messages * receivers) { throw std::runtime_error(operation + ": wrong number of deliveries"); }
+			std::cout << operation << " / " << receivers << " receivers: " << time << "s, " << delivered / time << " deliveries/s" << std::endl;
+			ResultTable::Row row;
+			row << operation << receivers << delivered << time << delivered / time;
+			m_results.add(row);
+		};
+		measure("broadcast", [&]()
+		{
+			for (size_t cpt = 0; cpt < messages; ++cpt) { handler.broadcast(BenchmarkMessage{ 1 }); }
+		});
+		measure("post", [&]()
+		{
+			for (size_t cpt = 0; cpt < messages; ++cpt)
+			{
+				for (int & target : targets) { handler.post(BenchmarkMessage{ 1 }, &target); }
+			}
+		});
+		// Posts emitted in parallel (one emitter per target) then delivered by a flush
+		measure("deferred_post", [&]()
+		{
+			handler.setDeferred(true);
+			for (size_t cpt = 0; cpt < messages; ++cpt)
+			{
+				::tbb::parallel_for(::tbb::blocked_range<size_t>(0, targets.size()), [&](const ::tbb::blocked_range<size_t> & range)
+				{
+					for (size_t index = range.begin(); index != range.end(); ++index)
+					{
+						stdext::message_handler::setEmitter(index);
+						handler.post(BenchmarkMessage{ 1 }, &targets[index]);
+					}
+				});
+				handler.flush();
+			}
+			handler.setDeferred(false);
+		});
+		for (stdext::message_handler::receiver_callback<BenchmarkMessage> * receiver : created) { delete receiver; }
+	}
+
+	void MessageBenchmark::run()
+	{
+		std::vector<std::string> receivers = m_parameters.getList("receivers", "100000");
+		for (const std::string & count : receivers)
+		{
+			benchmark(std::stoul(count));
+		}
+	}
+
+	void MessageBenchmark::save() const
+	{
+		std::string output = m_parameters.getString("output", "message_benchmark");
+		m_results.save(output + ".csv");
+		m_results.save(output + ".json");
+		std::cout << "Results saved in " << output << ".csv / .json" << std::endl;
+	}
+
+	int MessageBenchmark::main(const Parameters & parameters)
+	{
+		try
+		{
+			MessageBenchmark benchmark(parameters);
+			benchmark.run();
+			benchmark.save();
+		}
+		catch (const std::exception & e)
+		{
+			std::cerr << "MessageBenchmark: " << e.what() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+}
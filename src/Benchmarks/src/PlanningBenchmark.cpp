@@ -0,0 +1,392 @@
+#include <Benchmarks/PlanningBenchmark.h>
+#include <MotionPlanning/RRT.h>
+#include <MotionPlanning/PRM.h>
+#include <MotionPlanning/SixDofPlannerBiRRT.h>
+#include <MotionPlanning/ExperiencePlanner.h>
+#include <HelperGl/Loader3ds.h>
+#include <stdext/chrono/timer.h>
+#include <Config.h>
+#include <algorithm>
+#include <iostream>
+#include <stdexcept>
+
+namespace Benchmarks
+{
+	namespace
+	{
+		/// <summary>
+		/// Planner only used to sample collision free configurations when generating the queries.
+		/// </summary>
+		class QuerySampler : public MotionPlanning::SixDofPlannerBase
+		{
+		public:
+			QuerySampler(MotionPlanning::CollisionManager * collisionManager, MotionPlanning::CollisionManager::DynamicCollisionObject object)
+				: SixDofPlannerBase(collisionManager, object)
+			{}
+
+			virtual bool plan(const Configuration &, const Configuration &, float, float, std::vector<Configuration> &)
+			{
+				return false;
+			}
+
+			/// <summary>
+			/// The maximum number of configurations tested by <see cref="freeConfiguration"/>.
+			/// </summary>
+			static constexpr size_t maxAttempts = 100000;
+
+			/// <summary>
+			/// Generates a collision free configuration.
+			/// </summary>
+			/// <returns></returns>
+			Configuration freeConfiguration()
+			{
+				for (size_t cpt = 0; cpt < maxAttempts; ++cpt)
+				{
+					Configuration result;
+					if (!randomConfiguration(result)) { break; }
+					if (!doCollide(result)) { return result; }
+				}
+				throw std::runtime_error("PlanningBenchmark: no collision free configuration found, the scene may be fully obstructed");
+			}
+		};
+
+		/// <summary>
+		/// Computes the median of a set of values.
+		/// </summary>
+		double median(std::vector<double> values)
+		{
+			if (values.empty()) { return 0.0; }
+			std::sort(values.begin(), values.end());
+			size_t middle = values.size() / 2;
+			if (values.size() % 2 == 1) { return values[middle]; }
+			return (values[middle - 1] + values[middle]) / 2.0;
+		}
+	}
+
+	PlanningBenchmark::PlanningBenchmark(const Parameters & parameters)
+		: m_parameters(parameters),
+		m_results({ "scene", "planner", "query", "success", "time", "samples", "candidates", "acceptance_rate", "collision_checks", "continuous_checks", "filtered_checks", "filter_hit_rate", "library_hits", "nodes", "path_length", "path_size" }),
+		m_summary({ "scene", "planner", "queries", "success_rate", "mean_time", "median_time", "mean_collision_checks", "mean_nodes", "mean_path_length", "roadmap_time", "library_hit_rate" })
+	{}
+
+	std::unique_ptr<HelperGl::Mesh> PlanningBenchmark::loadMesh(const std::string & file) const
+	{
+		std::filesystem::path modelPath = Config::dataPath() / "MotionPlanning";
+		HelperGl::Loader3ds loader(modelPath / file, modelPath);
+		const std::vector<HelperGl::Mesh *> & meshes = loader.getMeshes();
+		std::unique_ptr<HelperGl::Mesh> result(new HelperGl::Mesh);
+		for (auto it = meshes.begin(), end = meshes.end(); it != end; ++it)
+		{
+			result->merge(**it);
+		}
+		return result;
+	}
+
+	std::unique_ptr<PlanningBenchmark::Scene> PlanningBenchmark::loadScene(const std::string & world) const
+	{
+		std::unique_ptr<Scene> scene(new Scene);
+		scene->m_name = world;
+		scene->m_collisionManager.reset(new MotionPlanning::CollisionManager);
+		scene->m_mobileMesh = loadMesh(m_parameters.getString("mobile", "mobile.3ds"));
+		scene->m_mobile = scene->m_collisionManager->registerDynamicObject(scene->m_mobileMesh.get());
+		scene->m_worldMesh = loadMesh(world);
+		scene->m_collisionManager->registerStaticObject(scene->m_worldMesh.get());
+		float filterCell = m_parameters.get<float>("filterCell", 0.0f);
+		if (filterCell > 0.0f)
+		{
+			std::vector<std::pair<float, float>> intervals(3, MotionPlanning::SixDofPlannerBase::defaultPositionInterval());
+			stdext::chrono::timer<> timer;
+			timer.start();
+			scene->m_clearanceFilter = std::make_shared<MotionPlanning::ClearanceFilter>(*scene->m_collisionManager, scene->m_mobile, intervals, filterCell);
+			timer.stop();
+			std::cout << world << ": clearance filter built in " << timer.elapsed_time().count() << "s" << std::endl;
+		}
+		generateQueries(*scene);
+		return scene;
+	}
+
+	void PlanningBenchmark::generateQueries(Scene & scene) const
+	{
+		size_t queries = m_parameters.get<size_t>("queries", 20);
+		QuerySampler sampler(scene.m_collisionManager.get(), scene.m_mobile);
+		sampler.seed(m_parameters.get<std::uint64_t>("seed", 1));
+		scene.m_queries.clear();
+		// The query of the motion planning practical work is always part of the benchmark
+		Math::Vector3f noRotation = Math::makeVector(0.0f, 0.0f, 0.0f);
+		Query reference{ Configuration(Math::makeVector(1.0f, -1.0f, 1.0f), noRotation), Configuration(Math::makeVector(1.0f, 1.0f, -1.0f), noRotation) };
+		if (queries > 0 && !sampler.doCollide(reference.m_start) && !sampler.doCollide(reference.m_target))
+		{
+			scene.m_queries.push_back(reference);
+		}
+		while (scene.m_queries.size() < queries)
+		{
+			Configuration start = sampler.freeConfiguration();
+			Configuration target = sampler.freeConfiguration();
+			scene.m_queries.push_back(Query{ start, target });
+		}
+	}
+
+	std::unique_ptr<MotionPlanning::ConfigurationSampler> PlanningBenchmark::createSampler() const
+	{
+		std::string sampler = m_parameters.getString("sampler", "uniform");
+		if (sampler == "halton") { return std::unique_ptr<MotionPlanning::ConfigurationSampler>(new MotionPlanning::HaltonSampler); }
+		if (sampler == "sobol") { return std::unique_ptr<MotionPlanning::ConfigurationSampler>(new MotionPlanning::SobolSampler); }
+		if (sampler != "uniform") { throw std::runtime_error("PlanningBenchmark: unknown sampler " + sampler); }
+		return std::unique_ptr<MotionPlanning::ConfigurationSampler>(new MotionPlanning::UniformSampler);
+	}
+
+	std::unique_ptr<MotionPlanning::SamplingStrategy> PlanningBenchmark::createStrategy() const
+	{
+		std::string strategy = m_parameters.getString("strategy", "uniform");
+		float sigma = m_parameters.get<float>("sigma", 0.1f);
+		if (strategy == "gaussian") { return std::unique_ptr<MotionPlanning::SamplingStrategy>(new MotionPlanning::GaussianStrategy(sigma)); }
+		if (strategy == "bridge") { return std::unique_ptr<MotionPlanning::SamplingStrategy>(new MotionPlanning::BridgeTestStrategy(sigma)); }
+		if (strategy == "obstacle") { return std::unique_ptr<MotionPlanning::SamplingStrategy>(new MotionPlanning::ObstacleBasedStrategy(m_parameters.get<float>("dq", 0.02f))); }
+		if (strategy != "uniform") { throw std::runtime_error("PlanningBenchmark: unknown sampling strategy " + strategy); }
+		return nullptr;
+	}
+
+	MotionPlanning::SixDofPlannerBase * PlanningBenchmark::configure(MotionPlanning::SixDofPlannerBase * planner, const Scene & scene) const
+	{
+		planner->setClearanceFilter(scene.m_clearanceFilter);
+		planner->setSampler(createSampler());
+		planner->setSamplingStrategy(createStrategy());
+		std::string edge = m_parameters.getString("edge", "discrete");
+		if (edge != "discrete" && edge != "continuous") { throw std::runtime_error("PlanningBenchmark: unknown edge validation " + edge); }
+		planner->setEdgeValidation(edge == "continuous" ? MotionPlanning::SixDofPlannerBase::EdgeValidation::cContinuous : MotionPlanning::SixDofPlannerBase::EdgeValidation::cDiscrete);
+		planner->seed(m_parameters.get<std::uint64_t>("seed", 1));
+		return planner;
+	}
+
+	PlanningBenchmark::Outcome PlanningBenchmark::solve(MotionPlanning::SixDofPlannerBase & planner, const Query & query) const
+	{
+		float radius = m_parameters.get<float>("radius", 0.1f);
+		float dq = m_parameters.get<float>("dq", 0.02f);
+		std::vector<Configuration> path;
+		planner.resetStatistics();
+		planner.setSampleLimit(m_parameters.get<size_t>("sampleLimit", 100000));
+		stdext::chrono::timer<> timer;
+		timer.start();
+		bool success = planner.plan(query.m_start, query.m_target, radius, dq, path);
+		timer.stop();
+		Outcome outcome;
+		outcome.m_success = success;
+		outcome.m_time = timer.elapsed_time().count();
+		outcome.m_statistics = planner.getStatistics();
+		outcome.m_pathLength = success ? pathLength(path) : 0.0f;
+		outcome.m_pathSize = success ? path.size() : 0;
+		return outcome;
+	}
+
+	void PlanningBenchmark::record(const std::string & scene, const std::string & planner, size_t query, const Outcome & outcome)
+	{
+		ResultTable::Row row;
+		row << scene << planner << query << outcome.m_success << outcome.m_time << outcome.m_statistics.m_samples << outcome.m_statistics.m_candidates
+			<< outcome.m_statistics.acceptanceRate() << outcome.m_statistics.m_collisionChecks << outcome.m_statistics.m_continuousChecks
+			<< outcome.m_statistics.m_filteredChecks << outcome.m_statistics.filterHitRate() << outcome.m_statistics.m_libraryHits
+			<< outcome.m_statistics.m_nodes << outcome.m_pathLength << outcome.m_pathSize;
+		m_results.add(row);
+	}
+
+	void PlanningBenchmark::benchmark(const Scene & scene, const std::string & plannerName, const std::function<MotionPlanning::SixDofPlannerBase*(size_t)> & factory)
+	{
+		std::uint64_t seed = m_parameters.get<std::uint64_t>("seed", 1);
+		std::vector<double> times;
+		size_t successes = 0;
+		double collisionChecks = 0.0, nodes = 0.0, length = 0.0;
+		// Queries solved from a path library and their cumulated time, compared to the other ones
+		size_t hits = 0;
+		double hitTime = 0.0, missTime = 0.0;
+		// The query set is solved several times if requested, multi query planners keep their state between passes
+		size_t total = scene.m_queries.size() * m_parameters.get<size_t>("passes", 1);
+		// The construction of multi query planners is done in the factory and measured separately
+		stdext::chrono::timer<> timer;
+		timer.start();
+		MotionPlanning::SixDofPlannerBase * previous = factory(0);
+		timer.stop();
+		double roadmapTime = timer.elapsed_time().count();
+		for (size_t cpt = 0; cpt < total; ++cpt)
+		{
+			MotionPlanning::SixDofPlannerBase * planner = (cpt == 0) ? previous : factory(cpt);
+			if (planner != previous) { delete previous; roadmapTime = 0.0; }
+			previous = planner;
+			planner->seed(seed + cpt);
+			Outcome outcome = solve(*planner, scene.m_queries[cpt % scene.m_queries.size()]);
+			record(scene.m_name, plannerName, cpt, outcome);
+			std::cout << scene.m_name << " / " << plannerName << " / query " << cpt << ": " << (outcome.m_success ? "success" : "failure") << " in " << outcome.m_time << "s" << std::endl;
+			collisionChecks += outcome.m_statistics.m_collisionChecks;
+			nodes += outcome.m_statistics.m_nodes;
+			if (outcome.m_statistics.m_libraryHits > 0) { ++hits; hitTime += outcome.m_time; }
+			else { missTime += outcome.m_time; }
+			if (outcome.m_success)
+			{
+				++successes;
+				times.push_back(outcome.m_time);
+				length += outcome.m_pathLength;
+			}
+		}
+		delete previous;
+		if (hits > 0)
+		{
+			double meanMissTime = (total == hits) ? 0.0 : missTime / (total - hits);
+			std::cout << scene.m_name << " / " << plannerName << ": library hit rate " << double(hits) / total << ", mean time " << hitTime / hits
+				<< "s with a retrieved path, " << meanMissTime << "s otherwise" << std::endl;
+		}
+		double queries = double(std::max<size_t>(total, 1));
+		double meanTime = 0.0;
+		for (double time : times) { meanTime += time; }
+		ResultTable::Row row;
+		row << scene.m_name << plannerName << total << successes / queries << (times.empty() ? 0.0 : meanTime / times.size()) << median(times)
+			<< collisionChecks / queries << nodes / queries << (successes == 0 ? 0.0 : length / successes) << roadmapTime << hits / queries;
+		m_summary.add(row);
+	}
+
+	void PlanningBenchmark::benchmarkBatch(const Scene & scene)
+	{
+		MotionPlanning::PRM prm(scene.m_collisionManager.get(), scene.m_mobile);
+		configure(&prm, scene);
+		stdext::chrono::timer<> timer;
+		timer.start();
+		prm.grow(m_parameters.get<size_t>("prmNodes", 1000), m_parameters.get<size_t>("prmNeighbours", 10), m_parameters.get<float>("dq", 0.02f));
+		timer.stop();
+		double roadmapTime = timer.elapsed_time().count();
+		std::vector<MotionPlanning::PRM::Query> queries;
+		for (const Query & query : scene.m_queries)
+		{
+			queries.push_back(MotionPlanning::PRM::Query{ query.m_start, query.m_target });
+		}
+		timer.start();
+		std::vector<MotionPlanning::PRM::QueryResult> results = prm.plan(queries, m_parameters.get<float>("dq", 0.02f));
+		timer.stop();
+		std::cout << scene.m_name << " / prm-batch: " << queries.size() << " queries in " << timer.elapsed_time().count() << "s" << std::endl;
+		std::vector<double> times;
+		size_t successes = 0;
+		double collisionChecks = 0.0, length = 0.0;
+		for (size_t cpt = 0; cpt < results.size(); ++cpt)
+		{
+			Outcome outcome{ results[cpt].m_success, results[cpt].m_time, results[cpt].m_statistics, pathLength(results[cpt].m_path), results[cpt].m_path.size() };
+			record(scene.m_name, "prm-batch", cpt, outcome);
+			collisionChecks += outcome.m_statistics.m_collisionChecks;
+			if (outcome.m_success)
+			{
+				++successes;
+				times.push_back(outcome.m_time);
+				length += outcome.m_pathLength;
+			}
+		}
+		double count = double(std::max<size_t>(results.size(), 1));
+		double meanTime = 0.0;
+		for (double time : times) { meanTime += time; }
+		ResultTable::Row row;
+		row << scene.m_name << "prm-batch" << results.size() << successes / count << (times.empty() ? 0.0 : meanTime / times.size()) << median(times)
+			<< collisionChecks / count << 0.0 << (successes == 0 ? 0.0 : length / successes) << roadmapTime << 0.0;
+		m_summary.add(row);
+	}
+
+	void PlanningBenchmark::run()
+	{
+		std::vector<std::string> scenes = m_parameters.getList("scenes", "world_simple.3ds,world.3ds,world2.3ds,world3.3ds");
+		std::vector<std::string> planners = m_parameters.getList("planners", "rrt,birrt,prm");
+		float dq = m_parameters.get<float>("dq", 0.02f);
+		for (auto scene = scenes.begin(), sceneEnd = scenes.end(); scene != sceneEnd; ++scene)
+		{
+			std::unique_ptr<Scene> current = loadScene(*scene);
+			MotionPlanning::CollisionManager * collisionManager = current->m_collisionManager.get();
+			MotionPlanning::CollisionManager::DynamicCollisionObject mobile = current->m_mobile;
+			const Scene & currentScene = *current;
+			for (auto planner = planners.begin(), plannerEnd = planners.end(); planner != plannerEnd; ++planner)
+			{
+				if (*planner == "rrt")
+				{
+					// RRT keeps its tree between two calls to plan, a new planner is created for each query
+					benchmark(*current, *planner, [this, collisionManager, mobile, &currentScene](size_t) { return configure(new MotionPlanning::RRT(collisionManager, mobile), currentScene); });
+				}
+				else if (*planner == "birrt")
+				{
+					benchmark(*current, *planner, [this, collisionManager, mobile, &currentScene](size_t) { return configure(new MotionPlanning::SixDofPlannerBiRRT(collisionManager, mobile), currentScene); });
+				}
+				else if (*planner == "prm")
+				{
+					// The roadmap is built once and reused by all queries
+					size_t nodes = m_parameters.get<size_t>("prmNodes", 1000);
+					size_t neighbours = m_parameters.get<size_t>("prmNeighbours", 10);
+					MotionPlanning::PRM * prm = nullptr;
+					benchmark(*current, *planner, [this, &prm, collisionManager, mobile, &currentScene, nodes, neighbours, dq](size_t)
+					{
+						if (prm == nullptr)
+						{
+							prm = new MotionPlanning::PRM(collisionManager, mobile);
+							configure(prm, currentScene);
+							prm->grow(nodes, neighbours, dq);
+						}
+						return prm;
+					});
+				}
+				else if (*planner == "experience")
+				{
+					// A single planner keeps its path library for all the queries, paths are repaired and computed by bidirectional RRTs
+					float retrievalRadius = m_parameters.get<float>("experienceRadius", 0.5f);
+					size_t repairLimit = m_parameters.get<size_t>("repairSampleLimit", 1000);
+					MotionPlanning::ExperiencePlanner * experience = nullptr;
+					benchmark(*current, *planner, [this, &experience, collisionManager, mobile, &currentScene, retrievalRadius, repairLimit](size_t)
+					{
+						if (experience == nullptr)
+						{
+							auto factory = [this, collisionManager, mobile, &currentScene]()
+							{
+								return std::unique_ptr<MotionPlanning::SixDofPlannerBase>(configure(new MotionPlanning::SixDofPlannerBiRRT(collisionManager, mobile), currentScene));
+							};
+							experience = new MotionPlanning::ExperiencePlanner(collisionManager, mobile, factory, retrievalRadius, repairLimit);
+							configure(experience, currentScene);
+						}
+						return experience;
+					});
+				}
+				else if (*planner == "prm-batch")
+				{
+					benchmarkBatch(*current);
+				}
+				else
+				{
+					std::cerr << "PlanningBenchmark: unknown planner " << *planner << ", ignored" << std::endl;
+				}
+			}
+		}
+	}
+
+	void PlanningBenchmark::save() const
+	{
+		std::string output = m_parameters.getString("output", "planning_benchmark");
+		m_results.save(output + ".csv");
+		m_results.save(output + ".json");
+		m_summary.save(output + "_summary.csv");
+		m_summary.save(output + "_summary.json");
+		std::cout << "Results saved in " << output << ".csv / .json" << std::endl;
+	}
+
+	float PlanningBenchmark::pathLength(const std::vector<Configuration> & path)
+	{
+		float result = 0.0f;
+		for (size_t cpt = 1; cpt < path.size(); ++cpt)
+		{
+			result += MotionPlanning::SixDofPlannerBase::configurationDistance(path[cpt - 1], path[cpt]);
+		}
+		return result;
+	}
+
+	int PlanningBenchmark::main(const Parameters & parameters)
+	{
+		try
+		{
+			PlanningBenchmark benchmark(parameters);
+			benchmark.run();
+			benchmark.save();
+		}
+		catch (const std::exception & e)
+		{
+			std::cerr << "PlanningBenchmark: " << e.what() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+}
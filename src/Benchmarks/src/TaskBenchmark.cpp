@@ -0,0 +1,208 @@
+#include <Benchmarks/TaskBenchmark.h>
+#include <AI/Tasks/Operators.h>
+#include <AI/Tasks/TimeOperators.h>
+#include <AI/Tasks/CompiledTree.h>
+#include <stdext/chrono/simulated_clock.h>
+#include <stdext/chrono/timer.h>
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include <cstdint>
+
+namespace Benchmarks
+{
+	namespace
+	{
+		using Status = AI::Tasks::Task::Status;
+		using Clock = stdext::chrono::simulated_clock;
+
+		/// <summary>
+		/// The context of the leaves of an agent: a random stream and a trace of the calls.
+		/// </summary>
+		struct TaskContext
+		{
+			std::minstd_rand m_random;
+			/// <summary>
+			/// Hash of the sequence of calls (FNV-1a), equal for two contexts only if they received the same calls in the same order.
+			/// </summary>
+			std::uint64_t m_trace;
+			size_t m_calls;
+
+			TaskContext(std::uint32_t seed)
+				: m_random(seed), m_trace(0xcbf29ce484222325ull), m_calls(0)
+			{}
+
+			void record(std::uint32_t event)
+			{
+				m_trace = (m_trace ^ event) * 0x100000001b3ull;
+				++m_calls;
+			}
+
+			Status draw()
+			{
+				switch (m_random() % 4)
+				{
+				case 0: return Status::success;
+				case 1: return Status::failure;
+				default: return Status::running;
+				}
+			}
+
+			bool condition() { return m_random() % 3 == 0; }
+		};
+
+		/// <summary>
+		/// Leaf of the classic tree: records its calls (3 * id + 0 / 1 / 2) and draws its status.
+		/// </summary>
+		std::shared_ptr<AI::Tasks::Task> classicLeaf(TaskContext & context, std::uint32_t id)
+		{
+			return AI::Tasks::makeTask([&context, id]() { context.record(3 * id); },
+				[&context, id]() { context.record(3 * id + 1); return context.draw(); },
+				[&context, id]() { context.record(3 * id + 2); });
+		}
+
+		/// <summary>
+		/// Leaf of the compiled tree, same behaviour as classicLeaf.
+		/// </summary>
+		template <std::uint32_t id>
+		AI::Tasks::Compiled::Description<TaskContext> compiledLeaf()
+		{
+			return AI::Tasks::Compiled::makeTask<TaskContext>([](TaskContext & context) { context.record(3 * id); },
+				[](TaskContext & context) { context.record(3 * id + 1); return context.draw(); },
+				[](TaskContext & context) { context.record(3 * id + 2); });
+		}
+
+		/// <summary>
+		/// Builds the classic tree of an agent.
+		/// </summary>
+		std::shared_ptr<AI::Tasks::Task> classicTree(TaskContext & context)
+		{
+			using namespace AI::Tasks;
+			auto leaf = [&context](std::uint32_t id) { return classicLeaf(context, id); };
+			auto condition = [&context]() { return context.condition(); };
+			return loop(sequence({ firstOf({ precondition(condition, leaf(22)), precondition(condition, leaf(23)), leaf(24) }),
+				leaf(1) && leaf(2), leaf(3) || leaf(4), parallelAnd({ leaf(5), leaf(6), leaf(7) }),
+				parallelOr({ leaf(8), negate(leaf(9)) }), ifSuccessOrFailure(leaf(10), leaf(11), leaf(12)),
+				precondition(condition, leaf(13)), succeedsWhen(condition, leaf(14)), failsWhen(condition, leaf(15)),
+				alwaysSucceeds(repeatUntilSuccess(leaf(16))), alwaysSucceeds(repeatUntilFailure(leaf(17))), firstOf({ leaf(18), leaf(19) }),
+				tryDuring<Clock>(0.5, leaf(20)), waitFor<Clock>(0.2), alwaysFails(leaf(21)) }));
+		}
+
+		/// <summary>
+		/// Builds the description of the compiled tree, same structure as classicTree.
+		/// </summary>
+		AI::Tasks::Compiled::Description<TaskContext> compiledTree()
+		{
+			using namespace AI::Tasks::Compiled;
+			bool(*condition)(TaskContext &) = [](TaskContext & context) { return context.condition(); };
+			return loop(sequence({ firstOf({ precondition<TaskContext>(condition, compiledLeaf<22>()), precondition<TaskContext>(condition, compiledLeaf<23>()), compiledLeaf<24>() }),
+				compiledLeaf<1>() && compiledLeaf<2>(), compiledLeaf<3>() || compiledLeaf<4>(),
+				parallelAnd({ compiledLeaf<5>(), compiledLeaf<6>(), compiledLeaf<7>() }), parallelOr({ compiledLeaf<8>(), negate(compiledLeaf<9>()) }),
+				ifSuccessOrFailure(compiledLeaf<10>(), compiledLeaf<11>(), compiledLeaf<12>()),
+				precondition<TaskContext>(condition, compiledLeaf<13>()), succeedsWhen<TaskContext>(condition, compiledLeaf<14>()),
+				failsWhen<TaskContext>(condition, compiledLeaf<15>()), alwaysSucceeds(repeatUntilSuccess(compiledLeaf<16>())),
+				alwaysSucceeds(repeatUntilFailure(compiledLeaf<17>())), firstOf({ compiledLeaf<18>(), compiledLeaf<19>() }),
+				tryDuring<Clock>(0.5, compiledLeaf<20>()), waitFor<TaskContext, Clock>(0.2), alwaysFails(compiledLeaf<21>()) }));
+		}
+	}
+
+	TaskBenchmark::TaskBenchmark(const Parameters & parameters)
+		: m_parameters(parameters),
+		m_results({ "agents", "ticks", "classic_time", "compiled_time", "speedup", "calls" })
+	{}
+
+	void TaskBenchmark::benchmark(size_t agents)
+	{
+		size_t ticks = m_parameters.get<size_t>("ticks", 200);
+		double dt = m_parameters.get<double>("dt", 0.1);
+		std::uint32_t seed = m_parameters.get<std::uint32_t>("seed", 1);
+		// Both versions of an agent draw from identical random streams
+		std::vector<TaskContext> classicContexts, compiledContexts;
+		classicContexts.reserve(agents);
+		compiledContexts.reserve(agents);
+		for (size_t cpt = 0; cpt < agents; ++cpt)
+		{
+			classicContexts.emplace_back(seed + std::uint32_t(cpt));
+			compiledContexts.emplace_back(seed + std::uint32_t(cpt));
+		}
+		std::vector<std::shared_ptr<AI::Tasks::Task>> classic;
+		classic.reserve(agents);
+		for (TaskContext & context : classicContexts) { classic.push_back(classicTree(context)); }
+		AI::Tasks::Compiled::Tree<TaskContext> tree(compiledTree());
+		AI::Tasks::Compiled::Tree<TaskContext>::States states(tree, agents);
+		std::vector<Status> classicStatuses(agents), compiledStatuses(agents);
+		double classicTime = 0.0, compiledTime = 0.0;
+		stdext::chrono::timer<> timer;
+		for (size_t tick = 0; tick < ticks; ++tick)
+		{
+			timer.start();
+			for (size_t cpt = 0; cpt < agents; ++cpt) { classicStatuses[cpt] = classic[cpt]->execute(); }
+			timer.stop();
+			classicTime += timer.elapsed_time().count();
+			timer.start();
+			for (size_t cpt = 0; cpt < agents; ++cpt) { compiledStatuses[cpt] = tree.execute(compiledContexts[cpt], states[cpt]); }
+			timer.stop();
+			compiledTime += timer.elapsed_time().count();
+			for (size_t cpt = 0; cpt < agents; ++cpt)
+			{
+				if (classicStatuses[cpt] != compiledStatuses[cpt])
+				{
+					throw std::runtime_error("agent " + std::to_string(cpt) + ": the compiled tree returned another status than the classic tree at tick " + std::to_string(tick));
+				}
+			}
+			Clock::update(dt);
+		}
+		size_t calls = 0;
+		for (size_t cpt = 0; cpt < agents; ++cpt)
+		{
+			if (classicContexts[cpt].m_calls != compiledContexts[cpt].m_calls || classicContexts[cpt].m_trace != compiledContexts[cpt].m_trace)
+			{
+				throw std::runtime_error("agent " + std::to_string(cpt) + ": the leaves of the compiled tree were not called in the order of the classic tree");
+			}
+			calls += classicContexts[cpt].m_calls;
+		}
+		double tickCount = double(std::max<size_t>(ticks, 1));
+		std::cout << agents << " agents: classic " << classicTime / tickCount << "s/tick, compiled " << compiledTime / tickCount << "s/tick, "
+			<< calls << " identical calls" << std::endl;
+		ResultTable::Row row;
+		row << agents << ticks << classicTime / tickCount << compiledTime / tickCount << (compiledTime > 0.0 ? classicTime / compiledTime : 0.0) << calls;
+		m_results.add(row);
+	}
+
+	void TaskBenchmark::run()
+	{
+		std::vector<std::string> agents = m_parameters.getList("agents", "1000,10000");
+		for (const std::string & count : agents)
+		{
+			benchmark(std::stoul(count));
+		}
+	}
+
+	void TaskBenchmark::save() const
+	{
+		std::string output = m_parameters.getString("output", "task_benchmark");
+		m_results.save(output + ".csv");
+		m_results.save(output + ".json");
+		std::cout << "Results saved in " << output << ".csv / .json" << std::endl;
+	}
+
+	int TaskBenchmark::main(const Parameters & parameters)
+	{
+		try
+		{
+			TaskBenchmark benchmark(parameters);
+			benchmark.run();
+			benchmark.save();
+		}
+		catch (const std::exception & e)
+		{
+			std::cerr << "TaskBenchmark: " << e.what() << std::endl;
+			return 1;
+		}
+		return 0;
+	}
+}
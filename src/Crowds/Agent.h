@@ -1,19 +1,23 @@
 #pragma once
 
 #include <AI/Blackboard.h>
+#include <Crowds/KinematicStorage.h>
 #include <Math/Vectorf.h>
 #include <Math/Constant.h>
 #include <Math/Interval.h>
 #include <stdext/message_handler.h>
 #include <vector>
 #include <memory>
+#include <algorithm>
+#include <random>
 
 namespace Crowds
 {
 	class Simulator;
 
 	/// <summary>
-	/// Abstract base class for agents
+	/// Abstract base class for agents. The kinematic state of an agent (position, speed, orientation, radius and status) is stored in
+	/// the <see cref="KinematicStorage"/> of its simulator, in the slot designated by <see cref="getIndex"/>.
 	/// </summary>
 	class Agent
 	{
@@ -26,27 +30,46 @@ namespace Crowds
 			stopped
 		};
 
+		enum class UpdateMode {
+			/// <summary> The simulator calls update sequentially, after the two phase agents </summary>
+			sequential,
+			/// <summary> The simulator calls steer in parallel on a read only world, then commit in parallel. steer may emit messages (they
+			/// are deferred) but must not use shared state such as rand(): random draws come from <see cref="random"/> </summary>
+			twoPhase
+		};
+
 	private:
 		friend class Simulator;
 
 		Simulator * m_simulator;
 
 	private:
-		AI::Blackboard * m_blackboard;
-		Math::Vector2f m_position;
-		Math::Vector2f m_speed;
-		float m_orientation;
-		float m_radius;
-		Status m_status;
+		KinematicStorage * m_kinematics;
+		KinematicStorage::Index m_index;
+		/// <summary>
+		/// The blackboard is stored in the agent (an empty blackboard does not allocate memory).
+		/// </summary>
+		mutable AI::Blackboard m_blackboard;
+		unsigned int m_updatePeriod;
+		/// <summary>
+		/// Did the agent steer during the current simulation step (two phase agents, set by the simulator)?
+		/// </summary>
+		bool m_steered;
+		/// <summary>
+		/// The random generator of the agent, seeded from the seed of the simulator and the index of the agent so that the random
+		/// decisions do not depend on the order in which the agents are updated.
+		/// </summary>
+		std::minstd_rand m_random;
 
 		/// <summary>
 		/// Updates the orientation of the agent.
 		/// </summary>
 		void updateOrientation()
 		{
-			if (m_speed.norm() != 0.0)
+			const Math::Vector2f & speed = m_kinematics->speed(m_index);
+			if (speed.norm() != 0.0)
 			{
-				m_orientation = atan2(m_speed[1], m_speed[0]);
+				m_kinematics->orientation(m_index) = atan2(speed[1], speed[0]);
 			}
 		}
 
@@ -55,22 +78,56 @@ namespace Crowds
 		/// Initializes a new instance of the <see cref="Agent"/> class.
 		/// </summary>
 		/// <param name="simulator">The simulator.</param>
-		Agent(Simulator * simulator, const Math::Vector2f & position, float radius)
-			: m_simulator(simulator), m_position(position), m_speed(0.0), m_orientation(Math::Interval<float>(-Math::pi, Math::pi).random()), m_radius(radius),
-			m_blackboard(new AI::Blackboard), m_status(Status::running)
-		{}
+		/// <param name="position">The initial position.</param>
+		/// <param name="radius">The radius.</param>
+		Agent(Simulator * simulator, const Math::Vector2f & position, float radius);
+
+		Agent(const Agent &) = delete;
+		Agent & operator = (const Agent &) = delete;
+
+		/// <summary>
+		/// Gets the index of the slot of this agent in the kinematic storage of the simulator.
+		/// </summary>
+		/// <returns></returns>
+		KinematicStorage::Index getIndex() const { return m_index; }
 
 		/// <summary>
 		/// Gets the agent's status.
 		/// </summary>
 		/// <returns></returns>
-		Status getStatus() const { return m_status; }
+		Status getStatus() const { return Status(m_kinematics->status(m_index)); }
 
 		/// <summary>
 		/// Sets the agent status.
 		/// </summary>
 		/// <param name="status">The status.</param>
-		void setStatus(Status status) { m_status = status; }
+		void setStatus(Status status) { m_kinematics->status(m_index) = std::uint8_t(status); }
+
+		/// <summary>
+		/// Gets the update period declared by the agent: a two phase agent steers every getUpdatePeriod() simulation steps and commits
+		/// at each step. The simulator may use a greater period depending on the level of detail (see Simulator::getLevelOfDetail).
+		/// </summary>
+		/// <returns></returns>
+		unsigned int getUpdatePeriod() const { return m_updatePeriod; }
+
+		/// <summary>
+		/// Sets the update period, e.g. a greater one when the agent is idle.
+		/// </summary>
+		/// <param name="period">The period (at least 1).</param>
+		void setUpdatePeriod(unsigned int period) { m_updatePeriod = std::max(period, 1u); }
+
+		/// <summary>
+		/// Returns true if the agent steered during the current simulation step. Valid during the commit phase of two phase agents.
+		/// </summary>
+		/// <returns></returns>
+		bool hasSteered() const { return m_steered; }
+
+		/// <summary>
+		/// Returns a random float in interval [0;1] drawn from the generator of this agent. Unlike Math::Sampler::random, it can be
+		/// called during the steering phase and gives reproducible simulations (see Simulator::setSeed).
+		/// </summary>
+		/// <returns></returns>
+		float random() { return float(m_random() - std::minstd_rand::min()) / float(std::minstd_rand::max() - std::minstd_rand::min()); }
 
 		/// <summary>
 		/// Gets the simulator.
@@ -82,31 +139,31 @@ namespace Crowds
 		/// Gets the agent's blackboard.
 		/// </summary>
 		/// <returns></returns>
-		AI::Blackboard * getBlackboard() const { return m_blackboard; }
+		AI::Blackboard * getBlackboard() const { return &m_blackboard; }
 
 		/// <summary>
 		/// Gets the agent position.
 		/// </summary>
 		/// <returns></returns>
-		const Math::Vector2f & getPosition() const { return m_position; }
+		const Math::Vector2f & getPosition() const { return m_kinematics->position(m_index); }
 
 		/// <summary>
 		/// Sets the position.
 		/// </summary>
 		/// <param name="position">The position.</param>
-		void setPosition(const Math::Vector2f & position) { m_position = position; }
+		void setPosition(const Math::Vector2f & position) { m_kinematics->position(m_index) = position; }
 
 		/// <summary>
 		/// Gets the radius.
 		/// </summary>
 		/// <returns></returns>
-		float getRadius() const { return m_radius; }
+		float getRadius() const { return m_kinematics->radius(m_index); }
 
 		/// <summary>
 		/// Gets the speed.
 		/// </summary>
 		/// <returns></returns>
-		const Math::Vector2f & getSpeed() const { return m_speed; }
+		const Math::Vector2f & getSpeed() const { return m_kinematics->speed(m_index); }
 
 		/// <summary>
 		/// Sets the speed.
@@ -114,7 +171,7 @@ namespace Crowds
 		/// <param name="speed">The speed.</param>
 		void setSpeed(const Math::Vector2f & speed)
 		{
-			m_speed = speed;
+			m_kinematics->speed(m_index) = speed;
 			updateOrientation();
 		}
 
@@ -122,13 +179,13 @@ namespace Crowds
 		/// Gets the orientation of the Agent.
 		/// </summary>
 		/// <returns></returns>
-		float getOrientation() const { return m_orientation; }
+		float getOrientation() const { return m_kinematics->orientation(m_index); }
 
 		/// <summary>
 		/// Gets the vector indicating the front direction.
 		/// </summary>
 		/// <returns></returns>
-		Math::Vector2f getFrontVector() const { return Math::makeVector(cos(m_orientation), sin(m_orientation)); }
+		Math::Vector2f getFrontVector() const { return Math::makeVector(cos(getOrientation()), sin(getOrientation())); }
 
 		/// <summary>
 		/// Perceives the entities of type EntityType beeing at a distance lesser than radius and in a field of view of angle 2*openingAngle.
@@ -141,11 +198,13 @@ namespace Crowds
 		{
 			std::vector<std::shared_ptr<EntityType>>neighbours = getSimulator()->selectEntities<EntityType>(getPosition(), radius);
 			Math::Vector2f front = getFrontVector();
+			const bool fullView = openingAngle >= Math::pi;
+			const float cosOpening = cos(openingAngle);
 			//for (auto it = neighbours.begin(); it != neighbours.end();)
 			for(size_t cpt=0; cpt<neighbours.size() ; )
 			{
 				auto it = neighbours.begin() + cpt;
-				if (((*it).get() == this) || ((*it)->getPosition() - getPosition()).normalized()*front < cos(openingAngle))
+				if (((*it).get() == this) || (!fullView && ((*it)->getPosition() - getPosition()).normalized()*front < cosOpening))
 				{
 					(*it) = neighbours.back();
 					neighbours.pop_back();
@@ -158,6 +217,33 @@ namespace Crowds
 			return neighbours;
 		}
 
+		/// <summary>
+		/// Calls function(EntityType &amp;) for each entity of type EntityType perceived by this agent (same perception as <see cref="perceive"/>).
+		/// This method neither allocates memory nor copies shared pointers.
+		/// </summary>
+		/// <param name="radius">The maximum distance of perception.</param>
+		/// <param name="function">The function.</param>
+		/// <param name="openingAngle">The half opening angle of the field of view.</param>
+		template <typename EntityType = Agent, typename Function>
+		void forEachNeighbour(float radius, const Function & function, float openingAngle = Math::pi) const
+		{
+			const Math::Vector2f & position = getPosition();
+			const Math::Vector2f front = getFrontVector();
+			const bool fullView = openingAngle >= Math::pi;
+			const float cosOpening = cos(openingAngle);
+			getSimulator()->forEachNeighbour<EntityType>(position, radius, [&](EntityType & entity)
+			{
+				if (static_cast<const Agent*>(&entity) == this) { return; }
+				if (!fullView)
+				{
+					// delta.normalized()*front < cos(openingAngle) without division
+					Math::Vector2f delta = entity.getPosition() - position;
+					if (delta * front < cosOpening * delta.norm()) { return; }
+				}
+				function(entity);
+			});
+		}
+
 		/// <summary>
 		/// Removes all the agents for which the condition is true in the provided vector.
 		/// </summary>
@@ -246,11 +332,33 @@ namespace Crowds
 		virtual void update(double dt) = 0;
 
 		/// <summary>
-		/// Finalizes an instance of the <see cref="Agent"/> class.
+		/// Gets the way the simulator updates this agent. Sequential by default.
 		/// </summary>
-		virtual ~Agent()
-		{
-			delete m_blackboard;
-		}
+		/// <returns></returns>
+		virtual UpdateMode getUpdateMode() const { return UpdateMode::sequential; }
+
+		/// <summary>
+		/// First phase of the update of a two phase agent, called in parallel for all agents. The state of the world is the one of the
+		/// previous step: this method can perceive other agents but must only modify the private decision state of this agent (no
+		/// position, speed or status change). Messages can be sent, they are delivered after the commit phase. Agents whose update period
+		/// is greater than one do not steer at each step, see <see cref="getUpdatePeriod"/>.
+		/// </summary>
+		/// <param name="dt">The decision interval: the time until the next call to steer, i.e. the simulation time step multiplied by the
+		/// update period used by the simulator (see Simulator::getUpdatePeriod). Timers and rates of the decision state (e.g. thirst) should
+		/// be advanced by this interval.</param>
+		virtual void steer(double dt) {}
+
+		/// <summary>
+		/// Second phase of the update of a two phase agent, called in parallel for all agents once all of them have steered. This method
+		/// applies the decision of the agent to its own state, it is called at each step even if the agent did not steer (see
+		/// <see cref="hasSteered"/>). The default implementation calls update.
+		/// </summary>
+		/// <param name="dt">The dt.</param>
+		virtual void commit(double dt) { update(dt); }
+
+		/// <summary>
+		/// Finalizes an instance of the <see cref="Agent"/> class. The slot of the agent is released, an agent must not outlive its simulator.
+		/// </summary>
+		virtual ~Agent();
 	};
 }
\ No newline at end of file
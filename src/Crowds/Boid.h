@@ -2,9 +2,11 @@
 
 #include <Crowds/Agent.h>
 #include <Crowds/Simulator.h>
+#include <Crowds/Messages.h>
+#include <Crowds/Orca.h>
+#include <Crowds/CollisionBatch.h>
 #include <Math/Polynomial2.h>
 #include <Math/Vectorf.h>
-#include <Math/Sampler.h>
 #include <Math/PolarCoordinates.h>
 
 namespace Crowds
@@ -18,6 +20,10 @@ namespace Crowds
 	protected:
 		Math::Vector2f m_acceleration;
 		Math::Vector2f m_steeringForce;
+		/// <summary>
+		/// The steering force of the last step during which the agent steered.
+		/// </summary>
+		Math::Vector2f m_lastSteeringForce;
 		float m_mass;
 		float m_maxSpeed;
 		float m_maxForce;
@@ -150,13 +156,27 @@ namespace Crowds
 		}
 
 	public:
+		/// <summary>
+		/// The flocking steering forces computed from a single traversal of the neighbourhood (see <see cref="flocking"/>).
+		/// </summary>
+		struct FlockingForces
+		{
+			Math::Vector2f m_cohesion;
+			Math::Vector2f m_alignment;
+			Math::Vector2f m_separation;
+			/// <summary>
+			/// The number of perceived neighbours, all forces are null if there is none.
+			/// </summary>
+			size_t m_neighbours;
+		};
+
 		/// <summary>
 		/// Initializes a new instance of the <see cref="Boid"/> class.
 		/// </summary>
 		/// <param name="simulator">The simulator.</param>
 		/// <param name="position">The initial position.</param>
 		Boid(Simulator * simulator, const Math::Vector2f & position, float radius, float mass, float maxSpeed, float maxForce)
-			: Agent(simulator, position, radius), m_mass(mass), m_acceleration(0.0f), m_steeringForce(0.0f), m_maxSpeed(maxSpeed), m_maxForce(maxForce)
+			: Agent(simulator, position, radius), m_mass(mass), m_acceleration(0.0f), m_steeringForce(0.0f), m_lastSteeringForce(0.0f), m_maxSpeed(maxSpeed), m_maxForce(maxForce)
 		{}
 
 		/// <summary>
@@ -224,6 +244,18 @@ namespace Crowds
 			m_steeringForce = Math::Vector2f(0.0); // We reset the steering force
 		}
 
+		/// <summary>
+		/// Integrates the steering force computed by <see cref="steer"/> (two phase update). During the steps without steering
+		/// (update period greater than one), the steering force of the last decision is integrated again.
+		/// </summary>
+		/// <param name="dt">The dt.</param>
+		virtual void commit(double dt) override
+		{
+			if (hasSteered()) { m_lastSteeringForce = m_steeringForce; }
+			else { m_steeringForce = m_lastSteeringForce; }
+			Boid::update(dt);
+		}
+
 		/// <summary>
 		/// Seeks the specified target.
 		/// </summary>
@@ -306,7 +338,7 @@ namespace Crowds
 			//if (m_speed.norm() != 0.0) { direction = m_speed.normalized(); }
 			//else { direction = Math::makeVector(1.0, 0.0); }
 			Math::Vector2f center = direction * circleDistance;
-			float delta = (Math::Sampler::random() - 0.5f)*2.0f*modificationPercentage*Math::pi;
+			float delta = (random() - 0.5f)*2.0f*modificationPercentage*Math::pi;
 			previousAngle += delta;
 			Math::Vector2f newSpeed = (Math::makeVector(cos(previousAngle), sin(previousAngle))*circleRadius + center).normalized()*m_maxSpeed;
 			return (newSpeed - getSpeed()) / adaptationTime;
@@ -405,6 +437,100 @@ namespace Crowds
 			return separation(neighbours, adaptationTime);
 		}
 
+		/// <summary>
+		/// Computes the cohesion, alignment and separation steering forces in a single traversal of the perceived neighbours of type
+		/// AgentType, without allocation. The perceiving agent is excluded from the averages.
+		/// </summary>
+		/// <param name="perceptionRadius">The perception radius.</param>
+		/// <param name="openingAngle">The half opening angle of the field of view.</param>
+		/// <param name="adaptationTime">The adaptation time.</param>
+		/// <returns></returns>
+		template <typename AgentType = Agent>
+		FlockingForces flocking(float perceptionRadius, float openingAngle = Math::pi, float adaptationTime = 1.0f) const
+		{
+			static_assert(std::is_base_of<Agent, AgentType>::value, "AgentType must inherit from agent");
+			Math::Vector2f center(0.0f), speed(0.0f), separationForce(0.0f);
+			size_t count = 0;
+			forEachNeighbour<AgentType>(perceptionRadius, [&](const AgentType & neighbour)
+			{
+				Math::Vector2f delta = neighbour.getPosition() - getPosition();
+				float distance = delta.norm();
+				center = center + neighbour.getPosition();
+				speed = speed + neighbour.getSpeed();
+				if (distance > 0.0f)
+				{
+					separationForce = separationForce - delta / (distance * std::max(distance - getRadius() - neighbour.getRadius(), 0.01f));
+				}
+				++count;
+			}, openingAngle);
+			FlockingForces result = { Math::Vector2f(0.0f), Math::Vector2f(0.0f), Math::Vector2f(0.0f), count };
+			if (count == 0) { return result; }
+			result.m_cohesion = seek(center / float(count), adaptationTime);
+			result.m_alignment = (speed / float(count) - getSpeed()) / adaptationTime;
+			result.m_separation = separationForce / adaptationTime;
+			return result;
+		}
+
+		/// <summary>
+		/// Computes the collision free speed closest to the preferred speed with respect to the perceived neighbours of type AgentType
+		/// (optimal reciprocal collision avoidance, see <see cref="Orca"/>). The neighbours are assumed to use the same behaviour and to
+		/// take half of the avoidance effort. Expected cost linear in the number of neighbours, no allocation once warmed up. Perfectly
+		/// symmetric configurations may lead to a standstill, a small random perturbation of the preferred speed breaks the symmetry.
+		/// </summary>
+		/// <param name="preferredSpeed">The preferred speed (e.g. toward the goal of the agent).</param>
+		/// <param name="perceptionRadius">The perception radius.</param>
+		/// <param name="timeHorizon">The collisions happening after this time are ignored.</param>
+		/// <param name="dt">The time step of the simulation.</param>
+		/// <returns></returns>
+		template <typename AgentType = Agent>
+		Math::Vector2f reciprocalAvoidanceSpeed(const Math::Vector2f & preferredSpeed, float perceptionRadius, float timeHorizon, float dt) const
+		{
+			static_assert(std::is_base_of<Agent, AgentType>::value, "AgentType must inherit from agent");
+			// The buffer of each thread is reused by its next requests
+			static thread_local std::vector<Orca::Line> lines;
+			lines.clear();
+			forEachNeighbour<AgentType>(perceptionRadius, [&](const AgentType & neighbour)
+			{
+				lines.push_back(Orca::computeLine(getPosition(), getSpeed(), getRadius(), neighbour.getPosition(), neighbour.getSpeed(), neighbour.getRadius(), timeHorizon, dt));
+			});
+			return Orca::solve(lines, preferredSpeed, m_maxSpeed);
+		}
+
+		/// <summary>
+		/// The reciprocal collision avoidance behaviour: the steering force reaching the speed computed by <see cref="reciprocalAvoidanceSpeed"/>
+		/// within one time step. The speed is only guaranteed to be collision free if the force is not truncated (the maximum force
+		/// should be greater than mass * 2 * maxSpeed / dt) and if it is not mixed with other behaviours (they should be included in
+		/// the preferred speed).
+		/// </summary>
+		/// <param name="preferredSpeed">The preferred speed (e.g. toward the goal of the agent).</param>
+		/// <param name="perceptionRadius">The perception radius.</param>
+		/// <param name="timeHorizon">The collisions happening after this time are ignored.</param>
+		/// <param name="dt">The time step of the simulation.</param>
+		/// <returns></returns>
+		template <typename AgentType = Agent>
+		Math::Vector2f reciprocalAvoidance(const Math::Vector2f & preferredSpeed, float perceptionRadius, float timeHorizon, float dt) const
+		{
+			return (reciprocalAvoidanceSpeed<AgentType>(preferredSpeed, perceptionRadius, timeHorizon, dt) - getSpeed()) * (m_mass / dt);
+		}
+
+		/// <summary>
+		/// Copies the positions, speeds and radii of the provided neighbours in the collision batch of the calling thread.
+		/// </summary>
+		/// <param name="neighbours">The neighbours.</param>
+		/// <returns></returns>
+		template <typename AgentType>
+		static CollisionBatch & fillCollisionBatch(const std::vector<std::shared_ptr<AgentType>> & neighbours)
+		{
+			// The buffer of each thread is reused by its next requests
+			static thread_local CollisionBatch batch;
+			batch.clear();
+			for (const std::shared_ptr<AgentType> & neighbour : neighbours)
+			{
+				batch.push_back(neighbour->getPosition(), neighbour->getSpeed(), neighbour->getRadius());
+			}
+			return batch;
+		}
+
 		/// <summary>
 		/// Tests if that agent may collide with at least one of the provided ones whitin the provided time window
 		/// </summary>
@@ -414,17 +540,8 @@ namespace Crowds
 		template <typename AgentType>
 		bool mayCollide(std::vector<std::shared_ptr<AgentType>> & neighbours, const Math::Interval<float> & timeWindow = Math::makeInterval(0.0f, 10.0f)) const
 		{
-			// We search for the collision which is the closest in time.
-			for (auto it = neighbours.begin(), end = neighbours.end(); it != end; ++it)
-			{
-				const std::shared_ptr<Agent> & other = (*it);
-				float collisionTime = std::numeric_limits<float>::max();
-				if (canCollide(*other, timeWindow, collisionTime))
-				{
-					return true;
-				}
-			}
-			return false;
+			const CollisionBatch & batch = fillCollisionBatch(neighbours);
+			return batch.firstCollision(getPosition(), getSpeed(), getRadius(), timeWindow) != batch.size();
 		}
 
 		/// <summary>
@@ -438,26 +555,14 @@ namespace Crowds
 		template <typename AgentType>
 		Math::Vector2f avoidCollisions(std::vector<std::shared_ptr<AgentType>> & neighbours, float adaptationTime = 1.0, const Math::Interval<float> & timeWindow = Math::makeInterval(0.0f, 10.0f))
 		{
-			bool collision = false; // Is there a predicted collision ? 
-			float minCollisionTime = std::numeric_limits<float>::max(); // When does this collision happen
-			std::shared_ptr<Agent> nearest; // Who is the collider
-
+			CollisionBatch & batch = fillCollisionBatch(neighbours);
 			// We search for the collision which is the closest in time.
-			for (auto it = neighbours.begin(), end = neighbours.end(); it != end; ++it)
-			{
-				const std::shared_ptr<Agent> & other = (*it);
-				float collisionTime = std::numeric_limits<float>::max();
-				bool col = canCollide(*other, timeWindow, collisionTime);
-				collision |= col;
-				if (col && minCollisionTime > collisionTime)
-				{
-					minCollisionTime = collisionTime;
-					nearest = other;
-				}
-			}
+			float minCollisionTime; // When does this collision happen
+			size_t nearestIndex = batch.earliestCollision(getPosition(), getSpeed(), getRadius(), timeWindow, minCollisionTime);
 			// If a collision has been detected
-			if (nearest)
+			if (nearestIndex != batch.size())
 			{
+				std::shared_ptr<Agent> nearest = neighbours[nearestIndex]; // Who is the collider
 				if ((getPosition() - nearest->getPosition()).norm() <= getRadius() + nearest->getRadius())
 				{	// Agents are colliding...
 					getSimulator()->broadcast(CollisionMessage{ this, nearest.get() });
@@ -466,10 +571,6 @@ namespace Crowds
 				}
 				else
 				{	// Agents are not colliding
-					auto computePolynomial = [this](const Math::Vector2f & speed, const Agent & other)
-					{
-						return computeCollisionPolynomial(getPosition(), speed, getRadius(), other.getPosition(), other.getSpeed(), other.getRadius());
-					};
 					// We prepare the solving algorithm
 					Math::PolarCoordinates polarSpeed(getSpeed());
 					const std::vector<SpeedVariation> & speeds = getSpeedTable();
@@ -478,21 +579,13 @@ namespace Crowds
 					for (auto it = speeds.begin(), end = speeds.end(); it != end; ++it)
 					{
 						Math::PolarCoordinates testedSpeed = polarSpeed.scale(it->m_speedPercentage).rotate(it->m_angleVariation);
-						bool collisionFound = false;
-						// We validate or invalidate the proposed speed
-						for (auto neighbourIt = neighbours.begin(), end = neighbours.end(); neighbourIt != end; ++neighbourIt)
-						{
-							float t;
-							Math::Polynomial2<float> currentPoly = computePolynomial(testedSpeed, **neighbourIt);
-							if (currentPoly(currentPoly.minimumRoot(timeWindow)) <= 0.1) // Collision case (we use a margin of 0.1m)
-							{
-								if (neighbourIt != neighbours.begin())
-								{   // In dense situations, it accelerates the computation
-									std::swap((*neighbourIt), *(neighbourIt - 1));
-								}
-								collisionFound = true;
-								break;
-							}
+						// We validate or invalidate the proposed speed (collision case with a margin of 0.1m)
+						size_t collider = batch.firstCollision(getPosition(), testedSpeed, getRadius(), timeWindow, 0.1f);
+						bool collisionFound = collider != batch.size();
+						if (collisionFound && collider != 0)
+						{   // In dense situations, it accelerates the computation
+							std::swap(neighbours[collider], neighbours[collider - 1]);
+							batch.swap(collider, collider - 1);
 						}
 						if (!collisionFound) // If we did not find a collision in the previous loop, the speed is a solution to the avoidance problem
 						{
@@ -0,0 +1,227 @@
+#pragma once
+
+#include <Math/Vectorf.h>
+#include <Math/Interval.h>
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <utility>
+
+#if defined(__AVX__)
+#define CROWDS_USE_AVX
+#include <immintrin.h>
+#endif
+
+namespace Crowds
+{
+	/// <summary>
+	/// Structure of arrays storage of the positions, speeds and radii of a set of neighbours, used to evaluate the collision polynomials
+	/// (squared distance minus squared sum of radii as a function of time, see Boid::computeCollisionPolynomial) between an agent and all
+	/// the neighbours with a vectorized kernel (AVX, eight neighbours at a time, scalar code for the remaining ones or without AVX).
+	/// The minimum of a polynomial in a time window is evaluated at its extremum clamped in the window (the polynomials are convex).
+	/// </summary>
+	class CollisionBatch
+	{
+		std::vector<float> m_px, m_py;
+		std::vector<float> m_vx, m_vy;
+		std::vector<float> m_radii;
+
+		/// <summary>
+		/// Coefficients a*t^2 + b*t + c of a collision polynomial.
+		/// </summary>
+		struct Coefficients
+		{
+			float m_a, m_b, m_c;
+		};
+
+		Coefficients coefficients(size_t index, const Math::Vector2f & position, const Math::Vector2f & speed, float radius) const
+		{
+			float dpx = position[0] - m_px[index], dpy = position[1] - m_py[index];
+			float dvx = speed[0] - m_vx[index], dvy = speed[1] - m_vy[index];
+			float sumR = radius + m_radii[index];
+			return { dvx * dvx + dvy * dvy, (dpx * dvx + dpy * dvy) * 2.0f, dpx * dpx + dpy * dpy - sumR * sumR };
+		}
+
+		/// <summary>
+		/// Minimum of a collision polynomial in the time window [t0;t1].
+		/// </summary>
+		static float minimum(const Coefficients & p, float t0, float t1)
+		{
+			// Same operations and NaN handling (null a) as the vectorized kernel
+			float t = -p.m_b / (p.m_a * 2.0f);
+			t = t > t0 ? t : t0;
+			t = t < t1 ? t : t1;
+			return (p.m_a * t + p.m_b) * t + p.m_c;
+		}
+
+		/// <summary>
+		/// Earliest time at which the distance is equal to the sum of the radii, 0 if the agents are already overlapping.
+		/// </summary>
+		static float collisionTime(const Coefficients & p)
+		{
+			if (p.m_c <= 0.0f) { return 0.0f; }
+			// Smallest root written as 2c / (-b + sqrt(delta)), also valid when a is null
+			float delta = p.m_b * p.m_b - p.m_a * p.m_c * 4.0f;
+			return p.m_c * 2.0f / (std::sqrt(delta > 0.0f ? delta : 0.0f) - p.m_b);
+		}
+
+	public:
+		/// <summary>
+		/// Returns the number of stored neighbours.
+		/// </summary>
+		/// <returns></returns>
+		size_t size() const { return m_px.size(); }
+
+		/// <summary>
+		/// Removes all the neighbours.
+		/// </summary>
+		void clear()
+		{
+			m_px.clear(); m_py.clear();
+			m_vx.clear(); m_vy.clear();
+			m_radii.clear();
+		}
+
+		/// <summary>
+		/// Appends a neighbour.
+		/// </summary>
+		/// <param name="position">The position.</param>
+		/// <param name="speed">The speed.</param>
+		/// <param name="radius">The radius.</param>
+		void push_back(const Math::Vector2f & position, const Math::Vector2f & speed, float radius)
+		{
+			m_px.push_back(position[0]); m_py.push_back(position[1]);
+			m_vx.push_back(speed[0]); m_vy.push_back(speed[1]);
+			m_radii.push_back(radius);
+		}
+
+		/// <summary>
+		/// Swaps two neighbours.
+		/// </summary>
+		void swap(size_t index1, size_t index2)
+		{
+			std::swap(m_px[index1], m_px[index2]); std::swap(m_py[index1], m_py[index2]);
+			std::swap(m_vx[index1], m_vx[index2]); std::swap(m_vy[index1], m_vy[index2]);
+			std::swap(m_radii[index1], m_radii[index2]);
+		}
+
+		/// <summary>
+		/// Finds the first neighbour (lowest index) whose collision polynomial with the provided agent is lesser or equal to margin
+		/// during the time window.
+		/// </summary>
+		/// <param name="position">The position of the agent.</param>
+		/// <param name="speed">The speed of the agent.</param>
+		/// <param name="radius">The radius of the agent.</param>
+		/// <param name="timeWindow">The time window.</param>
+		/// <param name="margin">The margin on the squared distance.</param>
+		/// <returns>The index of the neighbour, size() if there is none.</returns>
+		size_t firstCollision(const Math::Vector2f & position, const Math::Vector2f & speed, float radius, const Math::Interval<float> & timeWindow, float margin = 0.0f) const
+		{
+			size_t index = 0;
+#ifdef CROWDS_USE_AVX
+			Kernel kernel(position, speed, radius, timeWindow);
+			const __m256 marginVector = _mm256_set1_ps(margin);
+			for (size_t end = size() & ~size_t(7); index < end; index += 8)
+			{
+				__m256 a, b, c;
+				kernel.coefficients(*this, index, a, b, c);
+				int mask = _mm256_movemask_ps(_mm256_cmp_ps(kernel.minimum(a, b, c), marginVector, _CMP_LE_OQ));
+				if (mask != 0)
+				{
+					while ((mask & 1) == 0) { mask >>= 1; ++index; }
+					return index;
+				}
+			}
+#endif
+			for (; index < size(); ++index)
+			{
+				if (minimum(coefficients(index, position, speed, radius), timeWindow.inf(), timeWindow.sup()) <= margin) { return index; }
+			}
+			return size();
+		}
+
+		/// <summary>
+		/// Finds the neighbour colliding first with the provided agent, among the neighbours that collide with it during the time window.
+		/// </summary>
+		/// <param name="position">The position of the agent.</param>
+		/// <param name="speed">The speed of the agent.</param>
+		/// <param name="radius">The radius of the agent.</param>
+		/// <param name="timeWindow">The time window (should start at 0 or later).</param>
+		/// <param name="time">The collision time with the returned neighbour (0 if they are already overlapping).</param>
+		/// <returns>The index of the neighbour (the lowest one in case of equality), size() if there is none.</returns>
+		size_t earliestCollision(const Math::Vector2f & position, const Math::Vector2f & speed, float radius, const Math::Interval<float> & timeWindow, float & time) const
+		{
+			size_t result = size();
+			time = std::numeric_limits<float>::max();
+			size_t index = 0;
+#ifdef CROWDS_USE_AVX
+			Kernel kernel(position, speed, radius, timeWindow);
+			const __m256 zero = _mm256_setzero_ps();
+			const __m256 two = _mm256_set1_ps(2.0f);
+			const __m256 four = _mm256_set1_ps(4.0f);
+			const __m256 none = _mm256_set1_ps(std::numeric_limits<float>::max());
+			alignas(32) float times[8];
+			for (size_t end = size() & ~size_t(7); index < end; index += 8)
+			{
+				__m256 a, b, c;
+				kernel.coefficients(*this, index, a, b, c);
+				__m256 colliding = _mm256_cmp_ps(kernel.minimum(a, b, c), zero, _CMP_LE_OQ);
+				if (_mm256_movemask_ps(colliding) == 0) { continue; }
+				__m256 delta = _mm256_max_ps(_mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(_mm256_mul_ps(a, c), four)), zero);
+				__m256 t = _mm256_div_ps(_mm256_mul_ps(c, two), _mm256_sub_ps(_mm256_sqrt_ps(delta), b));
+				t = _mm256_blendv_ps(t, zero, _mm256_cmp_ps(c, zero, _CMP_LE_OQ));
+				_mm256_store_ps(times, _mm256_blendv_ps(none, t, colliding));
+				for (size_t lane = 0; lane < 8; ++lane)
+				{
+					if (times[lane] < time) { time = times[lane]; result = index + lane; }
+				}
+			}
+#endif
+			for (; index < size(); ++index)
+			{
+				Coefficients p = coefficients(index, position, speed, radius);
+				if (minimum(p, timeWindow.inf(), timeWindow.sup()) > 0.0f) { continue; }
+				float t = collisionTime(p);
+				if (t < time) { time = t; result = index; }
+			}
+			return result;
+		}
+
+	private:
+#ifdef CROWDS_USE_AVX
+		/// <summary>
+		/// The agent and the time window broadcast in AVX registers.
+		/// </summary>
+		struct Kernel
+		{
+			__m256 m_px, m_py, m_vx, m_vy, m_radius, m_t0, m_t1;
+
+			Kernel(const Math::Vector2f & position, const Math::Vector2f & speed, float radius, const Math::Interval<float> & timeWindow)
+				: m_px(_mm256_set1_ps(position[0])), m_py(_mm256_set1_ps(position[1])),
+				m_vx(_mm256_set1_ps(speed[0])), m_vy(_mm256_set1_ps(speed[1])), m_radius(_mm256_set1_ps(radius)),
+				m_t0(_mm256_set1_ps(timeWindow.inf())), m_t1(_mm256_set1_ps(timeWindow.sup()))
+			{}
+
+			void coefficients(const CollisionBatch & batch, size_t index, __m256 & a, __m256 & b, __m256 & c) const
+			{
+				__m256 dpx = _mm256_sub_ps(m_px, _mm256_loadu_ps(&batch.m_px[index]));
+				__m256 dpy = _mm256_sub_ps(m_py, _mm256_loadu_ps(&batch.m_py[index]));
+				__m256 dvx = _mm256_sub_ps(m_vx, _mm256_loadu_ps(&batch.m_vx[index]));
+				__m256 dvy = _mm256_sub_ps(m_vy, _mm256_loadu_ps(&batch.m_vy[index]));
+				__m256 sumR = _mm256_add_ps(m_radius, _mm256_loadu_ps(&batch.m_radii[index]));
+				a = _mm256_add_ps(_mm256_mul_ps(dvx, dvx), _mm256_mul_ps(dvy, dvy));
+				b = _mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(dpx, dvx), _mm256_mul_ps(dpy, dvy)), _mm256_set1_ps(2.0f));
+				c = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(dpx, dpx), _mm256_mul_ps(dpy, dpy)), _mm256_mul_ps(sumR, sumR));
+			}
+
+			__m256 minimum(__m256 a, __m256 b, __m256 c) const
+			{
+				__m256 t = _mm256_div_ps(_mm256_sub_ps(_mm256_setzero_ps(), b), _mm256_mul_ps(a, _mm256_set1_ps(2.0f)));
+				// max / min return their second operand if the first one is NaN (null a)
+				t = _mm256_min_ps(_mm256_max_ps(t, m_t0), m_t1);
+				return _mm256_add_ps(_mm256_mul_ps(_mm256_add_ps(_mm256_mul_ps(a, t), b), t), c);
+			}
+		};
+#endif
+	};
+}
@@ -0,0 +1,155 @@
+#pragma once
+
+#include <Math/Vectorf.h>
+#include <vector>
+#include <cstdint>
+#include <cassert>
+
+namespace Crowds
+{
+	class Agent;
+
+	/// <summary>
+	/// Structure of arrays storing the kinematic state of the agents of a simulator (position, speed, orientation, radius and status).
+	/// Each agent owns a slot identified by a stable index, the slots of destroyed agents are reused by the next created ones. Loops over
+	/// all agents (neighbourhood index rebuild, integration, extraction of the rendering data...) can stream the arrays instead of visiting
+	/// the agents. Creating a slot may reallocate the arrays and invalidates the references to the stored values.
+	/// </summary>
+	class KinematicStorage
+	{
+	public:
+		/// <summary>
+		/// The index of a slot.
+		/// </summary>
+		using Index = std::uint32_t;
+
+	private:
+		std::vector<Math::Vector2f> m_positions;
+		std::vector<Math::Vector2f> m_speeds;
+		std::vector<float> m_orientations;
+		std::vector<float> m_radii;
+		/// <summary>
+		/// The status of the agents (values of Agent::Status).
+		/// </summary>
+		std::vector<std::uint8_t> m_statuses;
+		/// <summary>
+		/// The agent owning each slot, nullptr for a free slot.
+		/// </summary>
+		std::vector<Agent*> m_agents;
+		std::vector<Index> m_freeSlots;
+
+	public:
+		/// <summary>
+		/// Creates the slot of an agent.
+		/// </summary>
+		/// <param name="agent">The agent owning the slot.</param>
+		/// <param name="position">The initial position.</param>
+		/// <param name="radius">The radius.</param>
+		/// <param name="orientation">The initial orientation.</param>
+		/// <param name="status">The initial status.</param>
+		/// <returns>The index of the slot.</returns>
+		Index create(Agent * agent, const Math::Vector2f & position, float radius, float orientation, std::uint8_t status)
+		{
+			if (!m_freeSlots.empty())
+			{
+				Index index = m_freeSlots.back();
+				m_freeSlots.pop_back();
+				m_positions[index] = position;
+				m_speeds[index] = Math::Vector2f(0.0f);
+				m_orientations[index] = orientation;
+				m_radii[index] = radius;
+				m_statuses[index] = status;
+				m_agents[index] = agent;
+				return index;
+			}
+			m_positions.push_back(position);
+			m_speeds.push_back(Math::Vector2f(0.0f));
+			m_orientations.push_back(orientation);
+			m_radii.push_back(radius);
+			m_statuses.push_back(status);
+			m_agents.push_back(agent);
+			return Index(m_agents.size() - 1);
+		}
+
+		/// <summary>
+		/// Releases the slot of a destroyed agent.
+		/// </summary>
+		/// <param name="index">The index of the slot.</param>
+		void release(Index index)
+		{
+			assert(index < m_agents.size() && m_agents[index] != nullptr);
+			m_agents[index] = nullptr;
+			m_freeSlots.push_back(index);
+		}
+
+		/// <summary>
+		/// Returns the number of slots (the used and the free ones). Valid indexes are in [0;slots()[.
+		/// </summary>
+		/// <returns></returns>
+		size_t slots() const { return m_agents.size(); }
+
+		/// <summary>
+		/// Returns the number of agents.
+		/// </summary>
+		/// <returns></returns>
+		size_t size() const { return m_agents.size() - m_freeSlots.size(); }
+
+		/// <summary>
+		/// Gets the agent owning a slot.
+		/// </summary>
+		/// <param name="index">The index of the slot.</param>
+		/// <returns>The agent or nullptr if the slot is free.</returns>
+		Agent * getAgent(Index index) const { return m_agents[index]; }
+
+		Math::Vector2f & position(Index index) { return m_positions[index]; }
+		const Math::Vector2f & position(Index index) const { return m_positions[index]; }
+
+		Math::Vector2f & speed(Index index) { return m_speeds[index]; }
+		const Math::Vector2f & speed(Index index) const { return m_speeds[index]; }
+
+		float & orientation(Index index) { return m_orientations[index]; }
+		float orientation(Index index) const { return m_orientations[index]; }
+
+		float & radius(Index index) { return m_radii[index]; }
+		float radius(Index index) const { return m_radii[index]; }
+
+		std::uint8_t & status(Index index) { return m_statuses[index]; }
+		std::uint8_t status(Index index) const { return m_statuses[index]; }
+
+		/// <summary>
+		/// Gets the positions of all slots.
+		/// </summary>
+		/// <returns></returns>
+		const std::vector<Math::Vector2f> & getPositions() const { return m_positions; }
+
+		/// <summary>
+		/// Gets the speeds of all slots.
+		/// </summary>
+		/// <returns></returns>
+		const std::vector<Math::Vector2f> & getSpeeds() const { return m_speeds; }
+
+		/// <summary>
+		/// Gets the orientations of all slots.
+		/// </summary>
+		/// <returns></returns>
+		const std::vector<float> & getOrientations() const { return m_orientations; }
+
+		/// <summary>
+		/// Gets the radii of all slots.
+		/// </summary>
+		/// <returns></returns>
+		const std::vector<float> & getRadii() const { return m_radii; }
+
+		/// <summary>
+		/// Gets the status of all slots.
+		/// </summary>
+		/// <returns></returns>
+		const std::vector<std::uint8_t> & getStatuses() const { return m_statuses; }
+
+		/// <summary>
+		/// Gets the agents owning the slots (nullptr for a free slot).
+		/// </summary>
+		/// <returns></returns>
+		const std::vector<Agent*> & getAgents() const { return m_agents; }
+	};
+}
@@ -0,0 +1,84 @@
+#pragma once
+
+#include <Math/Vectorf.h>
+#include <vector>
+#include <algorithm>
+
+namespace Crowds
+{
+	/// <summary>
+	/// Level of detail of the agents of a <see cref="Simulator"/> with respect to a focus point (e.g. the position of the camera).
+	/// Tiers associate a distance to the focus with an update period: an agent farther than the distance of a tier runs its
+	/// perception and decision logic (Agent::steer) every period simulation steps. Without tiers, all agents steer at each step.
+	/// </summary>
+	class LevelOfDetail
+	{
+		/// <summary>
+		/// Agents whose squared distance to the focus is greater than m_squaredDistance steer every m_period steps.
+		/// </summary>
+		struct Tier
+		{
+			float m_squaredDistance;
+			unsigned int m_period;
+		};
+
+		Math::Vector2f m_focus;
+		/// <summary>
+		/// The tiers, sorted by decreasing distance.
+		/// </summary>
+		std::vector<Tier> m_tiers;
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="LevelOfDetail"/> class, without tiers.
+		/// </summary>
+		LevelOfDetail()
+			: m_focus(0.0f)
+		{}
+
+		/// <summary>
+		/// Sets the focus point.
+		/// </summary>
+		/// <param name="focus">The focus.</param>
+		void setFocus(const Math::Vector2f & focus) { m_focus = focus; }
+
+		/// <summary>
+		/// Gets the focus point.
+		/// </summary>
+		/// <returns></returns>
+		const Math::Vector2f & getFocus() const { return m_focus; }
+
+		/// <summary>
+		/// Adds a tier: the agents farther than distance from the focus steer every period steps (unless a farther tier applies).
+		/// </summary>
+		/// <param name="distance">The distance.</param>
+		/// <param name="period">The update period (at least 1).</param>
+		void addTier(float distance, unsigned int period)
+		{
+			Tier tier = { distance * distance, std::max(period, 1u) };
+			auto position = std::find_if(m_tiers.begin(), m_tiers.end(), [&tier](const Tier & other) { return other.m_squaredDistance < tier.m_squaredDistance; });
+			m_tiers.insert(position, tier);
+		}
+
+		/// <summary>
+		/// Removes all tiers.
+		/// </summary>
+		void clear() { m_tiers.clear(); }
+
+		/// <summary>
+		/// Gets the update period of an agent at the provided position.
+		/// </summary>
+		/// <param name="position">The position.</param>
+		/// <returns></returns>
+		unsigned int getUpdatePeriod(const Math::Vector2f & position) const
+		{
+			Math::Vector2f delta = position - m_focus;
+			float squaredDistance = delta * delta;
+			for (const Tier & tier : m_tiers)
+			{
+				if (squaredDistance > tier.m_squaredDistance) { return tier.m_period; }
+			}
+			return 1;
+		}
+	};
+}
@@ -0,0 +1,323 @@
+#pragma once
+
+#include <Crowds/Agent.h>
+#include <MotionPlanning/VPTree.h>
+#include <Math/Vectorf.h>
+#include <vector>
+#include <memory>
+#include <cmath>
+#include <cstdint>
+#include <algorithm>
+
+namespace Crowds
+{
+	/// <summary>
+	/// Base class of the data structures answering neighbourhood requests of the <see cref="Simulator"/>. The index references
+	/// a set of agents, it is rebuilt once per simulation step (agents are moving), requests are answered from the positions of
+	/// the last rebuild.
+	/// </summary>
+	class NeighbourhoodIndex
+	{
+	public:
+		/// <summary>
+		/// Receives the agents selected by a request (see <see cref="visit"/>).
+		/// </summary>
+		class Visitor
+		{
+		public:
+			virtual void operator()(const std::shared_ptr<Agent> & agent) = 0;
+
+		protected:
+			~Visitor() {}
+		};
+
+	private:
+		/// <summary>
+		/// Adapts a function to the <see cref="Visitor"/> interface.
+		/// </summary>
+		template <typename Function>
+		class FunctionVisitor : public Visitor
+		{
+			const Function & m_function;
+
+		public:
+			FunctionVisitor(const Function & function)
+				: m_function(function)
+			{}
+
+			virtual void operator()(const std::shared_ptr<Agent> & agent) override { m_function(agent); }
+		};
+
+	protected:
+		/// <summary>
+		/// The indexed agents.
+		/// </summary>
+		std::vector<std::shared_ptr<Agent>> m_agents;
+
+	public:
+		virtual ~NeighbourhoodIndex() {}
+
+		/// <summary>
+		/// Adds an agent in the index. The agent can be perceived after the next call to <see cref="rebuild"/>.
+		/// </summary>
+		/// <param name="agent">The agent.</param>
+		virtual void add(const std::shared_ptr<Agent> & agent)
+		{
+			m_agents.push_back(agent);
+		}
+
+		/// <summary>
+		/// Rebuilds the index from the current positions of the agents.
+		/// </summary>
+		virtual void rebuild() = 0;
+
+		/// <summary>
+		/// Creates an empty index of the same type, with the same settings.
+		/// </summary>
+		/// <returns></returns>
+		virtual std::unique_ptr<NeighbourhoodIndex> createEmpty() const = 0;
+
+		/// <summary>
+		/// Calls the visitor for each agent whose distance to the provided position is lesser or equal to radius. Requests do not allocate
+		/// memory once warmed up and can be called concurrently (but not during a rebuild).
+		/// </summary>
+		/// <param name="position">The position.</param>
+		/// <param name="radius">The radius.</param>
+		/// <param name="visitor">The visitor.</param>
+		virtual void visit(const Math::Vector2f & position, float radius, Visitor & visitor) const = 0;
+
+		/// <summary>
+		/// Calls function(const std::shared_ptr&lt;Agent&gt; &amp;) for each agent whose distance to the provided position is lesser or equal to radius.
+		/// </summary>
+		/// <param name="position">The position.</param>
+		/// <param name="radius">The radius.</param>
+		/// <param name="function">The function.</param>
+		template <typename Function>
+		void forEach(const Math::Vector2f & position, float radius, const Function & function) const
+		{
+			FunctionVisitor<Function> visitor(function);
+			visit(position, radius, visitor);
+		}
+
+		/// <summary>
+		/// Selects the agents whose distance to the provided position is lesser or equal to radius.
+		/// </summary>
+		/// <param name="position">The position.</param>
+		/// <param name="radius">The radius.</param>
+		/// <param name="result">The selected agents are appended to this vector.</param>
+		void select(const Math::Vector2f & position, float radius, std::vector<std::shared_ptr<Agent>> & result) const
+		{
+			forEach(position, radius, [&result](const std::shared_ptr<Agent> & agent) { result.push_back(agent); });
+		}
+
+		/// <summary>
+		/// Gets the indexed agents.
+		/// </summary>
+		/// <returns></returns>
+		const std::vector<std::shared_ptr<Agent>> & getAgents() const { return m_agents; }
+
+		/// <summary>
+		/// Returns the number of indexed agents.
+		/// </summary>
+		/// <returns></returns>
+		size_t size() const { return m_agents.size(); }
+	};
+
+	/// <summary>
+	/// Neighbourhood index based on a <see cref="MotionPlanning::VPTree"/>. The tree is rebuilt by inserting all agents again.
+	/// The tree stores the indexes of the agents in m_agents, requests do not copy shared pointers.
+	/// </summary>
+	/// <seealso cref="NeighbourhoodIndex" />
+	class VPTreeIndex : public NeighbourhoodIndex
+	{
+		MotionPlanning::VPTree<std::uint32_t, Math::Vector2f> m_tree;
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="VPTreeIndex"/> class.
+		/// </summary>
+		VPTreeIndex()
+			: m_tree(
+				[this](std::uint32_t a1, std::uint32_t a2)
+				{
+					return (m_agents[a1]->getPosition() - m_agents[a2]->getPosition()).norm();
+				},
+				[this](std::uint32_t agent, const Math::Vector2f & position)
+				{
+					return (m_agents[agent]->getPosition() - position).norm();
+				}
+			)
+		{}
+
+		VPTreeIndex(const VPTreeIndex &) = delete;
+		VPTreeIndex & operator = (const VPTreeIndex &) = delete;
+
+		virtual void add(const std::shared_ptr<Agent> & agent) override
+		{
+			NeighbourhoodIndex::add(agent);
+			m_tree.add(std::uint32_t(m_agents.size() - 1));
+		}
+
+		virtual void rebuild() override
+		{
+			if (!m_agents.empty()) { m_tree.recompute(); }
+		}
+
+		virtual std::unique_ptr<NeighbourhoodIndex> createEmpty() const override
+		{
+			return std::unique_ptr<NeighbourhoodIndex>(new VPTreeIndex);
+		}
+
+		virtual void visit(const Math::Vector2f & position, float radius, Visitor & visitor) const override
+		{
+			// The buffer of each thread is reused by its next requests
+			static thread_local std::vector<std::uint32_t> selected;
+			selected.clear();
+			m_tree.select(position, radius, selected);
+			for (std::uint32_t agent : selected) { visitor(m_agents[agent]); }
+		}
+	};
+
+	/// <summary>
+	/// Neighbourhood index based on a uniform grid stored in a spatial hash table. The plane is divided in square cells, each cell is hashed
+	/// in a table whose size is the power of two greater or equal to the number of agents. The rebuild is a counting sort of the agents
+	/// by hash value (O(n)): the agents of a hash entry are contiguous, their positions are copied in the sorted order so that requests
+	/// only read contiguous memory. The world does not need to be bounded. The cell size should be close to the usual perception radius.
+	/// </summary>
+	/// <seealso cref="NeighbourhoodIndex" />
+	class GridIndex : public NeighbourhoodIndex
+	{
+		/// <summary>
+		/// An indexed agent, in the sorted order.
+		/// </summary>
+		struct Entry
+		{
+			Math::Vector2f m_position;
+			std::int32_t m_cellX, m_cellY;
+			std::uint32_t m_agent;
+		};
+
+		float m_cellSize;
+		float m_inverseCellSize;
+		/// <summary>
+		/// The mask of the hash table (its size minus one).
+		/// </summary>
+		std::uint32_t m_mask;
+		/// <summary>
+		/// The first entry of each hash value, the entries of hash value h are in [m_starts[h]; m_starts[h+1][.
+		/// </summary>
+		std::vector<std::uint32_t> m_starts;
+		/// <summary>
+		/// The agents sorted by hash value.
+		/// </summary>
+		std::vector<Entry> m_entries;
+
+		/// <summary>
+		/// Computes the coordinate of the cell containing a coordinate. Coordinates are clamped so that far away agents (e.g. agents
+		/// removed from the world by moving them to infinity) are stored in border cells and rejected by the distance test.
+		/// </summary>
+		std::int32_t cell(float coordinate) const
+		{
+			const float limit = float(1 << 30);
+			return std::int32_t(std::floor(std::clamp(coordinate * m_inverseCellSize, -limit, limit)));
+		}
+
+		/// <summary>
+		/// Hashes the coordinates of a cell.
+		/// </summary>
+		std::uint32_t hash(std::int32_t x, std::int32_t y) const
+		{
+			return ((std::uint32_t(x) * 73856093u) ^ (std::uint32_t(y) * 19349663u)) & m_mask;
+		}
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="GridIndex"/> class.
+		/// </summary>
+		/// <param name="cellSize">The size of a cell.</param>
+		GridIndex(float cellSize = 10.0f)
+			: m_cellSize(cellSize), m_inverseCellSize(1.0f / cellSize), m_mask(0), m_starts(2, 0)
+		{
+			assert(cellSize > 0.0f);
+		}
+
+		/// <summary>
+		/// Gets the size of a cell.
+		/// </summary>
+		/// <returns></returns>
+		float getCellSize() const { return m_cellSize; }
+
+		virtual std::unique_ptr<NeighbourhoodIndex> createEmpty() const override
+		{
+			return std::unique_ptr<NeighbourhoodIndex>(new GridIndex(m_cellSize));
+		}
+
+		virtual void rebuild() override
+		{
+			std::uint32_t tableSize = 1;
+			while (tableSize < m_agents.size()) { tableSize <<= 1; }
+			m_mask = tableSize - 1;
+			m_starts.assign(tableSize + 1, 0);
+			std::vector<Entry> unsorted(m_agents.size());
+			std::vector<std::uint32_t> hashes(m_agents.size());
+			for (size_t cpt = 0; cpt < m_agents.size(); ++cpt)
+			{
+				const Math::Vector2f & position = m_agents[cpt]->getPosition();
+				unsorted[cpt] = Entry{ position, cell(position[0]), cell(position[1]), std::uint32_t(cpt) };
+				hashes[cpt] = hash(unsorted[cpt].m_cellX, unsorted[cpt].m_cellY);
+				++m_starts[hashes[cpt] + 1];
+			}
+			for (size_t cpt = 1; cpt < m_starts.size(); ++cpt) { m_starts[cpt] += m_starts[cpt - 1]; }
+			std::vector<std::uint32_t> next(m_starts.begin(), m_starts.end() - 1);
+			m_entries.resize(m_agents.size());
+			for (size_t cpt = 0; cpt < unsorted.size(); ++cpt)
+			{
+				m_entries[next[hashes[cpt]]++] = unsorted[cpt];
+			}
+		}
+
+		/// <summary>
+		/// Calls visitor(agent index in m_agents, position) for each agent at a distance lesser or equal to radius of the provided position.
+		/// </summary>
+		/// <param name="position">The position.</param>
+		/// <param name="radius">The radius.</param>
+		/// <param name="visitor">The visitor.</param>
+		template <typename Function>
+		void forEachEntry(const Math::Vector2f & position, float radius, const Function & visitor) const
+		{
+			std::int32_t minX = cell(position[0] - radius), maxX = cell(position[0] + radius);
+			std::int32_t minY = cell(position[1] - radius), maxY = cell(position[1] + radius);
+			float squaredRadius = radius * radius;
+			auto visitEntries = [&](std::uint32_t begin, std::uint32_t end, bool checkCell, std::int32_t x, std::int32_t y)
+			{
+				for (std::uint32_t index = begin; index < end; ++index)
+				{
+					const Entry & entry = m_entries[index];
+					// Different cells may share a hash value
+					if (checkCell && (entry.m_cellX != x || entry.m_cellY != y)) { continue; }
+					Math::Vector2f delta = entry.m_position - position;
+					if (delta * delta <= squaredRadius) { visitor(entry.m_agent, entry.m_position); }
+				}
+			};
+			// Large requests covering more cells than there are agents are answered by a linear scan
+			if (std::uint64_t(std::int64_t(maxX) - minX + 1) * std::uint64_t(std::int64_t(maxY) - minY + 1) > m_entries.size())
+			{
+				visitEntries(0, std::uint32_t(m_entries.size()), false, 0, 0);
+				return;
+			}
+			for (std::int32_t x = minX; x <= maxX; ++x)
+			{
+				for (std::int32_t y = minY; y <= maxY; ++y)
+				{
+					std::uint32_t h = hash(x, y);
+					visitEntries(m_starts[h], m_starts[h + 1], true, x, y);
+				}
+			}
+		}
+
+		virtual void visit(const Math::Vector2f & position, float radius, Visitor & visitor) const override
+		{
+			forEachEntry(position, radius, [this, &visitor](std::uint32_t agent, const Math::Vector2f &) { visitor(m_agents[agent]); });
+		}
+	};
+}
@@ -0,0 +1,238 @@
+#pragma once
+
+#include <Math/Vectorf.h>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+namespace Crowds
+{
+	/// <summary>
+	/// Optimal reciprocal collision avoidance (ORCA, van den Berg et al.). Each neighbour forbids a half-plane of the velocity space:
+	/// the velocities leading to a collision with it before a time horizon, assuming that it takes its share (reciprocity) of the
+	/// avoidance effort. The new velocity is the velocity closest to the preferred one in the intersection of the half-planes and
+	/// of the disc of the maximum speed, it is computed by an incremental 2D linear program (Seidel) over the half-planes in the order
+	/// of the lines, as in RVO2. The lines are not shuffled, which keeps the result deterministic: the cost is quadratic in the number
+	/// of half-planes in the worst case (bounded by the number of neighbours), linear only when few lines move the current optimum.
+	/// When the half-planes have no common point (dense crowd), the velocity minimizing the maximum penetration in the half-planes is
+	/// returned.
+	/// </summary>
+	class Orca
+	{
+	public:
+		/// <summary>
+		/// A directed line bounding a half-plane of the velocity space. The permitted velocities are on the left of the line.
+		/// </summary>
+		struct Line
+		{
+			Math::Vector2f m_point;
+			Math::Vector2f m_direction;
+		};
+
+	private:
+		/// <summary>
+		/// Numerical tolerance of the parallelism tests.
+		/// </summary>
+		static constexpr float epsilon = 1e-5f;
+
+		/// <summary>
+		/// Determinant of the 2x2 matrix [v1 v2].
+		/// </summary>
+		static float det(const Math::Vector2f & v1, const Math::Vector2f & v2)
+		{
+			return v1[0] * v2[1] - v1[1] * v2[0];
+		}
+
+		/// <summary>
+		/// Solves the linear program on line lineNo, constrained by the previous lines and the disc of radius maxSpeed.
+		/// </summary>
+		/// <returns>false if the constraints are infeasible on that line.</returns>
+		static bool linearProgram1(const std::vector<Line> & lines, size_t lineNo, float maxSpeed, const Math::Vector2f & optimalSpeed, bool optimizeDirection, Math::Vector2f & result)
+		{
+			const Line & line = lines[lineNo];
+			float dotProduct = line.m_point * line.m_direction;
+			float discriminant = dotProduct * dotProduct + maxSpeed * maxSpeed - line.m_point * line.m_point;
+			if (discriminant < 0.0f) { return false; } // The line does not cross the disc of the maximum speed
+			float sqrtDiscriminant = std::sqrt(discriminant);
+			float tLeft = -dotProduct - sqrtDiscriminant;
+			float tRight = -dotProduct + sqrtDiscriminant;
+			for (size_t cpt = 0; cpt < lineNo; ++cpt)
+			{
+				float denominator = det(line.m_direction, lines[cpt].m_direction);
+				float numerator = det(lines[cpt].m_direction, line.m_point - lines[cpt].m_point);
+				if (std::abs(denominator) <= epsilon)
+				{
+					// Parallel lines
+					if (numerator < 0.0f) { return false; }
+					continue;
+				}
+				float t = numerator / denominator;
+				if (denominator >= 0.0f) { tRight = std::min(tRight, t); }
+				else { tLeft = std::max(tLeft, t); }
+				if (tLeft > tRight) { return false; }
+			}
+			if (optimizeDirection)
+			{
+				result = line.m_point + line.m_direction * ((optimalSpeed * line.m_direction > 0.0f) ? tRight : tLeft);
+			}
+			else
+			{
+				float t = std::clamp(line.m_direction * (optimalSpeed - line.m_point), tLeft, tRight);
+				result = line.m_point + line.m_direction * t;
+			}
+			return true;
+		}
+
+		/// <summary>
+		/// Solves the linear program over all lines, constrained by the disc of radius maxSpeed. Each line violated by the current optimum
+		/// triggers a pass over the previous lines (linearProgram1): O(k^2) for k lines in the worst case.
+		/// </summary>
+		/// <returns>The number of lines if successful, the index of the line on which it failed otherwise.</returns>
+		static size_t linearProgram2(const std::vector<Line> & lines, float maxSpeed, const Math::Vector2f & optimalSpeed, bool optimizeDirection, Math::Vector2f & result)
+		{
+			if (optimizeDirection) { result = optimalSpeed * maxSpeed; } // optimalSpeed is a unit direction
+			else if (optimalSpeed * optimalSpeed > maxSpeed * maxSpeed) { result = optimalSpeed.normalized() * maxSpeed; }
+			else { result = optimalSpeed; }
+			for (size_t cpt = 0; cpt < lines.size(); ++cpt)
+			{
+				if (det(lines[cpt].m_direction, lines[cpt].m_point - result) > 0.0f)
+				{
+					// The current result violates this constraint
+					Math::Vector2f previous = result;
+					if (!linearProgram1(lines, cpt, maxSpeed, optimalSpeed, optimizeDirection, result))
+					{
+						result = previous;
+						return cpt;
+					}
+				}
+			}
+			return lines.size();
+		}
+
+		/// <summary>
+		/// Infeasible program from line beginLine: minimizes the maximum penetration in the half-planes.
+		/// </summary>
+		static void linearProgram3(const std::vector<Line> & lines, size_t beginLine, float maxSpeed, Math::Vector2f & result)
+		{
+			// The buffer of each thread is reused by its next requests
+			static thread_local std::vector<Line> projectedLines;
+			float distance = 0.0f;
+			for (size_t cpt = beginLine; cpt < lines.size(); ++cpt)
+			{
+				if (det(lines[cpt].m_direction, lines[cpt].m_point - result) <= distance) { continue; }
+				// The current result violates this constraint more than the maximum penetration
+				projectedLines.clear();
+				for (size_t other = 0; other < cpt; ++other)
+				{
+					Line line;
+					float determinant = det(lines[cpt].m_direction, lines[other].m_direction);
+					if (std::abs(determinant) <= epsilon)
+					{
+						if (lines[cpt].m_direction * lines[other].m_direction > 0.0f) { continue; } // Same direction
+						line.m_point = (lines[cpt].m_point + lines[other].m_point) * 0.5f; // Opposite directions
+					}
+					else
+					{
+						line.m_point = lines[cpt].m_point + lines[cpt].m_direction * (det(lines[other].m_direction, lines[cpt].m_point - lines[other].m_point) / determinant);
+					}
+					line.m_direction = (lines[other].m_direction - lines[cpt].m_direction).normalized();
+					projectedLines.push_back(line);
+				}
+				Math::Vector2f previous = result;
+				if (linearProgram2(projectedLines, maxSpeed, Math::makeVector(-lines[cpt].m_direction[1], lines[cpt].m_direction[0]), true, result) < projectedLines.size())
+				{
+					// Can only happen because of rounding errors, the result is already in the feasible region of the program
+					result = previous;
+				}
+				distance = det(lines[cpt].m_direction, lines[cpt].m_point - result);
+			}
+		}
+
+	public:
+		/// <summary>
+		/// Computes the half-plane of the permitted velocities of an agent with respect to a neighbour.
+		/// </summary>
+		/// <param name="position">The position of the agent.</param>
+		/// <param name="speed">The current speed of the agent.</param>
+		/// <param name="radius">The radius of the agent.</param>
+		/// <param name="otherPosition">The position of the neighbour.</param>
+		/// <param name="otherSpeed">The speed of the neighbour.</param>
+		/// <param name="otherRadius">The radius of the neighbour.</param>
+		/// <param name="timeHorizon">The collisions happening after this time are ignored.</param>
+		/// <param name="dt">The time step, used to separate already colliding agents within one step.</param>
+		/// <param name="reciprocity">The share of the avoidance taken by the agent: 0.5 if the neighbour also uses ORCA, 1 if it does not avoid.</param>
+		/// <returns></returns>
+		static Line computeLine(const Math::Vector2f & position, const Math::Vector2f & speed, float radius,
+			const Math::Vector2f & otherPosition, const Math::Vector2f & otherSpeed, float otherRadius,
+			float timeHorizon, float dt, float reciprocity = 0.5f)
+		{
+			Math::Vector2f relativePosition = otherPosition - position;
+			Math::Vector2f relativeSpeed = speed - otherSpeed;
+			float squaredDistance = relativePosition * relativePosition;
+			float combinedRadius = radius + otherRadius;
+			float squaredCombinedRadius = combinedRadius * combinedRadius;
+			Line line;
+			Math::Vector2f u;
+			if (squaredDistance > squaredCombinedRadius)
+			{
+				// No collision: the velocity obstacle is a truncated cone
+				float inverseTimeHorizon = 1.0f / timeHorizon;
+				Math::Vector2f w = relativeSpeed - relativePosition * inverseTimeHorizon; // From the cutoff center to the relative speed
+				float squaredWLength = w * w;
+				float dotProduct = w * relativePosition;
+				if (dotProduct < 0.0f && dotProduct * dotProduct > squaredCombinedRadius * squaredWLength)
+				{
+					// Projection on the cutoff circle
+					float wLength = std::sqrt(squaredWLength);
+					Math::Vector2f unitW = w / wLength;
+					line.m_direction = Math::makeVector(unitW[1], -unitW[0]);
+					u = unitW * (combinedRadius * inverseTimeHorizon - wLength);
+				}
+				else
+				{
+					// Projection on the legs of the cone
+					float leg = std::sqrt(squaredDistance - squaredCombinedRadius);
+					if (det(relativePosition, w) > 0.0f)
+					{
+						line.m_direction = Math::makeVector(relativePosition[0] * leg - relativePosition[1] * combinedRadius, relativePosition[0] * combinedRadius + relativePosition[1] * leg) / squaredDistance;
+					}
+					else
+					{
+						line.m_direction = -Math::makeVector(relativePosition[0] * leg + relativePosition[1] * combinedRadius, -relativePosition[0] * combinedRadius + relativePosition[1] * leg) / squaredDistance;
+					}
+					u = line.m_direction * (relativeSpeed * line.m_direction) - relativeSpeed;
+				}
+			}
+			else
+			{
+				// Collision: the agents must be separated within one time step
+				float inverseTimeStep = 1.0f / dt;
+				Math::Vector2f w = relativeSpeed - relativePosition * inverseTimeStep;
+				float wLength = w.norm();
+				Math::Vector2f unitW = wLength > 0.0f ? w / wLength : Math::makeVector(0.0f, 1.0f);
+				line.m_direction = Math::makeVector(unitW[1], -unitW[0]);
+				u = unitW * (combinedRadius * inverseTimeStep - wLength);
+			}
+			line.m_point = speed + u * reciprocity;
+			return line;
+		}
+
+		/// <summary>
+		/// Computes the speed closest to the preferred speed that respects all half-planes and whose norm is no more than maxSpeed.
+		/// </summary>
+		/// <param name="lines">The half-planes (see <see cref="computeLine"/>).</param>
+		/// <param name="preferredSpeed">The preferred speed.</param>
+		/// <param name="maxSpeed">The maximum speed.</param>
+		/// <returns></returns>
+		static Math::Vector2f solve(const std::vector<Line> & lines, const Math::Vector2f & preferredSpeed, float maxSpeed)
+		{
+			Math::Vector2f result(0.0f);
+			size_t failure = linearProgram2(lines, maxSpeed, preferredSpeed, false, result);
+			if (failure < lines.size())
+			{
+				linearProgram3(lines, failure, maxSpeed, result);
+			}
+			return result;
+		}
+	};
+}
@@ -30,7 +30,9 @@ namespace Crowds
 			return AI::Tasks::Task::Status::running;
 		}
 
-		virtual void update(double dt) override
+		virtual UpdateMode getUpdateMode() const override { return UpdateMode::twoPhase; }
+
+		virtual void steer(double dt) override
 		{
 			dTps = dt;
 			//FAIRE UNE TACHE MAIS AVEC DES OPERATEUR ET DES PR2CONDITION
@@ -44,7 +46,6 @@ namespace Crowds
 			else {
 
 			}
-			Boid::update(dt);
 		}
 	};
 }
\ No newline at end of file
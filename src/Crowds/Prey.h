@@ -31,7 +31,9 @@ namespace Crowds
 			pointsEau->push_back(m.m_water);
 		}
 
-		virtual void update(double dt) override
+		virtual UpdateMode getUpdateMode() const override { return UpdateMode::twoPhase; }
+
+		virtual void steer(double dt) override
 		{
 			//update soif
 			soif = std::clamp<float>(soif - dt, 0, 100);
@@ -88,7 +90,6 @@ namespace Crowds
 			//Supprime pts d'eau
 			pointsEau->clear();
 			/*~~~~~~*/
-			Boid::update(dt);
 		}
 	private:
 		std::pair<bool, std::shared_ptr<Prey>> plusLourd(std::vector<std::shared_ptr<Prey>> neighbours) {
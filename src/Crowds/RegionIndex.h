@@ -0,0 +1,324 @@
+#pragma once
+
+#include <Crowds/NeighbourhoodIndex.h>
+#include <Math/Vectorf.h>
+#include <vector>
+#include <memory>
+#include <limits>
+#include <algorithm>
+#include <cstdint>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/partitioner.h>
+
+namespace Crowds
+{
+	/// <summary>
+	/// Neighbourhood index splitting the world in regions, each region having its own index (a copy of a prototype index, see
+	/// <see cref="NeighbourhoodIndex::createEmpty"/>). The regions are the leaves of a 2D tree whose cuts balance the number of agents:
+	/// each agent is owned by the region containing it and is also stored, as a halo agent, in the regions lying at less than the halo
+	/// width. A request whose radius is lesser or equal to the halo width is answered by the index of the region containing the
+	/// position of the request, larger requests visit all the regions they overlap and only keep the agents owned by the visited region.
+	/// At each rebuild, agents migrate to the region containing their new position, the halos are exchanged and the indexes of the
+	/// regions are rebuilt in parallel. The cuts are recomputed when the most populated region exceeds the mean population by more than
+	/// the imbalance ratio. The <see cref="Simulator"/> updates the two phase agents region by region, one task per region (see
+	/// <see cref="forEachRegion"/>).
+	/// </summary>
+	/// <seealso cref="NeighbourhoodIndex" />
+	class RegionIndex : public NeighbourhoodIndex
+	{
+		/// <summary>
+		/// A node of the 2D tree: a cut (m_axis is 0 or 1, agents whose coordinate is lesser than m_cut are on the left) or a region
+		/// (m_axis is -1, the region is m_children[0]).
+		/// </summary>
+		struct Node
+		{
+			int m_axis;
+			float m_cut;
+			std::uint32_t m_children[2];
+		};
+
+		struct Region
+		{
+			std::unique_ptr<NeighbourhoodIndex> m_index;
+			/// <summary>
+			/// The agents owned by the region (indexes in m_agents), in increasing order.
+			/// </summary>
+			std::vector<std::uint32_t> m_owned;
+			/// <summary>
+			/// The agents of the other regions lying at less than the halo width of the region.
+			/// </summary>
+			std::vector<std::uint32_t> m_halo;
+		};
+
+		/// <summary>
+		/// Forwards the agents owned by a region (requests larger than the halo width).
+		/// </summary>
+		class OwnedVisitor : public Visitor
+		{
+			const std::vector<std::uint32_t> & m_owners;
+			std::uint32_t m_region;
+			Visitor & m_visitor;
+
+		public:
+			OwnedVisitor(const std::vector<std::uint32_t> & owners, std::uint32_t region, Visitor & visitor)
+				: m_owners(owners), m_region(region), m_visitor(visitor)
+			{}
+
+			virtual void operator()(const std::shared_ptr<Agent> & agent) override
+			{
+				if (m_owners[agent->getIndex()] == m_region) { m_visitor(agent); }
+			}
+		};
+
+		std::unique_ptr<NeighbourhoodIndex> m_prototype;
+		size_t m_regionCount;
+		float m_halo;
+		float m_imbalance;
+		std::vector<Node> m_nodes;
+		std::vector<Region> m_regions;
+		/// <summary>
+		/// The positions of the agents at the last rebuild.
+		/// </summary>
+		std::vector<Math::Vector2f> m_positions;
+		/// <summary>
+		/// The region owning each agent, by kinematic slot (see Agent::getIndex).
+		/// </summary>
+		std::vector<std::uint32_t> m_owners;
+		/// <summary>
+		/// The number of agents distributed in the regions by the last rebuild.
+		/// </summary>
+		size_t m_partitioned;
+		/// <summary>
+		/// The rebuilds and the updates of the regions reuse the same partitioner so that a region tends to stay on the same thread (and
+		/// memory node).
+		/// </summary>
+		mutable tbb::affinity_partitioner m_affinity;
+
+		/// <summary>
+		/// Builds the subtree of the agents in [begin; end[ with the provided number of regions.
+		/// </summary>
+		/// <returns>The index of the root of the subtree.</returns>
+		std::uint32_t split(std::vector<std::uint32_t>::iterator begin, std::vector<std::uint32_t>::iterator end, size_t regions)
+		{
+			std::uint32_t node = std::uint32_t(m_nodes.size());
+			m_nodes.push_back(Node{ -1, 0.0f, { 0, 0 } });
+			if (regions == 1)
+			{
+				m_nodes[node].m_children[0] = std::uint32_t(m_regions.size());
+				m_regions.emplace_back();
+				return node;
+			}
+			// The cut is orthogonal to the largest extent of the agents
+			Math::Vector2f lower = Math::makeVector(std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+			Math::Vector2f upper = -lower;
+			for (auto it = begin; it != end; ++it)
+			{
+				lower = lower.simdMin(m_positions[*it]);
+				upper = upper.simdMax(m_positions[*it]);
+			}
+			int axis = (end - begin > 0 && upper[1] - lower[1] > upper[0] - lower[0]) ? 1 : 0;
+			size_t leftRegions = regions / 2;
+			auto middle = begin + (end - begin) * leftRegions / regions;
+			float cut = 0.0f;
+			if (middle != end)
+			{
+				std::nth_element(begin, middle, end, [this, axis](std::uint32_t a1, std::uint32_t a2) { return m_positions[a1][axis] < m_positions[a2][axis]; });
+				cut = m_positions[*middle][axis];
+			}
+			else if (begin != end) { cut = upper[axis]; }
+			std::uint32_t left = split(begin, middle, leftRegions);
+			std::uint32_t right = split(middle, end, regions - leftRegions);
+			m_nodes[node] = Node{ axis, cut, { left, right } };
+			return node;
+		}
+
+		/// <summary>
+		/// Recomputes the cuts from the positions of the agents.
+		/// </summary>
+		void partition()
+		{
+			m_nodes.clear();
+			m_regions.clear();
+			std::vector<std::uint32_t> agents(m_agents.size());
+			for (size_t cpt = 0; cpt < agents.size(); ++cpt) { agents[cpt] = std::uint32_t(cpt); }
+			split(agents.begin(), agents.end(), m_regionCount);
+		}
+
+		/// <summary>
+		/// Assigns the agents to the region containing them.
+		/// </summary>
+		/// <returns>The population of the most populated region.</returns>
+		size_t assign()
+		{
+			for (Region & region : m_regions) { region.m_owned.clear(); }
+			size_t largest = 0;
+			for (size_t cpt = 0; cpt < m_agents.size(); ++cpt)
+			{
+				std::uint32_t region = locate(m_positions[cpt]);
+				m_owners[m_agents[cpt]->getIndex()] = region;
+				m_regions[region].m_owned.push_back(std::uint32_t(cpt));
+				largest = std::max(largest, m_regions[region].m_owned.size());
+			}
+			return largest;
+		}
+
+		/// <summary>
+		/// Calls function(region) for each region intersecting the square of center position and of half side radius.
+		/// </summary>
+		template <typename Function>
+		void forEachOverlappingRegion(const Math::Vector2f & position, float radius, const Function & function) const
+		{
+			std::uint32_t stack[64];
+			size_t top = 0;
+			stack[top++] = 0;
+			while (top != 0)
+			{
+				const Node & node = m_nodes[stack[--top]];
+				if (node.m_axis < 0) { function(node.m_children[0]); continue; }
+				if (position[node.m_axis] - radius < node.m_cut) { stack[top++] = node.m_children[0]; }
+				if (position[node.m_axis] + radius >= node.m_cut) { stack[top++] = node.m_children[1]; }
+			}
+		}
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="RegionIndex"/> class.
+		/// </summary>
+		/// <param name="prototype">The prototype of the indexes of the regions.</param>
+		/// <param name="regions">The number of regions (at least 1).</param>
+		/// <param name="halo">The halo width: the usual maximum radius of the requests (e.g. the perception radius of the agents).</param>
+		/// <param name="imbalance">The cuts are recomputed when the largest population exceeds the mean population by this ratio.</param>
+		RegionIndex(std::unique_ptr<NeighbourhoodIndex> prototype, size_t regions, float halo, float imbalance = 0.25f)
+			: m_prototype(std::move(prototype)), m_regionCount(std::max<size_t>(regions, 1)), m_halo(halo), m_imbalance(imbalance), m_partitioned(0)
+		{
+			assert(m_prototype != nullptr);
+		}
+
+		RegionIndex(const RegionIndex &) = delete;
+		RegionIndex & operator = (const RegionIndex &) = delete;
+
+		/// <summary>
+		/// Gets the halo width.
+		/// </summary>
+		/// <returns></returns>
+		float getHalo() const { return m_halo; }
+
+		/// <summary>
+		/// Returns the number of regions (0 before the first rebuild).
+		/// </summary>
+		/// <returns></returns>
+		size_t getRegionCount() const { return m_regions.size(); }
+
+		/// <summary>
+		/// Gets the agents owned by a region, as indexes in getAgents(), in increasing order.
+		/// </summary>
+		/// <param name="region">The region.</param>
+		/// <returns></returns>
+		const std::vector<std::uint32_t> & getOwnedAgents(size_t region) const { return m_regions[region].m_owned; }
+
+		/// <summary>
+		/// Gets the number of halo agents of a region.
+		/// </summary>
+		/// <param name="region">The region.</param>
+		/// <returns></returns>
+		size_t getHaloSize(size_t region) const { return m_regions[region].m_halo.size(); }
+
+		/// <summary>
+		/// Returns the number of agents distributed in the regions by the last rebuild. Agents added since then are not owned by any region.
+		/// </summary>
+		/// <returns></returns>
+		size_t getPartitionedSize() const { return m_partitioned; }
+
+		/// <summary>
+		/// Gets the region containing a position.
+		/// </summary>
+		/// <param name="position">The position.</param>
+		/// <returns></returns>
+		std::uint32_t locate(const Math::Vector2f & position) const
+		{
+			std::uint32_t node = 0;
+			while (m_nodes[node].m_axis >= 0)
+			{
+				node = m_nodes[node].m_children[position[m_nodes[node].m_axis] < m_nodes[node].m_cut ? 0 : 1];
+			}
+			return m_nodes[node].m_children[0];
+		}
+
+		/// <summary>
+		/// Calls function(region) in parallel for each region, one task per region.
+		/// </summary>
+		/// <param name="function">The function.</param>
+		template <typename Function>
+		void forEachRegion(const Function & function) const
+		{
+			tbb::parallel_for(tbb::blocked_range<size_t>(0, m_regions.size(), 1), [&function](const tbb::blocked_range<size_t> & range)
+			{
+				for (size_t region = range.begin(); region != range.end(); ++region) { function(region); }
+			}, m_affinity);
+		}
+
+		virtual void rebuild() override
+		{
+			m_positions.resize(m_agents.size());
+			size_t slots = 0;
+			for (size_t cpt = 0; cpt < m_agents.size(); ++cpt)
+			{
+				m_positions[cpt] = m_agents[cpt]->getPosition();
+				slots = std::max(slots, size_t(m_agents[cpt]->getIndex()) + 1);
+			}
+			m_owners.resize(slots);
+			// Migration of the agents to the region containing them
+			if (m_regions.empty() || assign() > (1.0f + m_imbalance) * float(m_agents.size()) / float(m_regions.size()) + 1.0f)
+			{
+				partition();
+				assign();
+			}
+			// Halo exchange
+			for (Region & region : m_regions) { region.m_halo.clear(); }
+			for (size_t cpt = 0; cpt < m_agents.size(); ++cpt)
+			{
+				std::uint32_t owner = m_owners[m_agents[cpt]->getIndex()];
+				forEachOverlappingRegion(m_positions[cpt], m_halo, [this, cpt, owner](std::uint32_t region)
+				{
+					if (region != owner) { m_regions[region].m_halo.push_back(std::uint32_t(cpt)); }
+				});
+			}
+			forEachRegion([this](size_t cpt)
+			{
+				Region & region = m_regions[cpt];
+				region.m_index = m_prototype->createEmpty();
+				// Both lists are sorted: merging them adds the agents in the order of the whole index, so that the region index visits
+				// the neighbours in the same order as a single index would
+				auto owned = region.m_owned.begin(), halo = region.m_halo.begin();
+				while (owned != region.m_owned.end() || halo != region.m_halo.end())
+				{
+					bool fromOwned = halo == region.m_halo.end() || (owned != region.m_owned.end() && *owned < *halo);
+					region.m_index->add(m_agents[fromOwned ? *owned++ : *halo++]);
+				}
+				region.m_index->rebuild();
+			});
+			m_partitioned = m_agents.size();
+		}
+
+		virtual std::unique_ptr<NeighbourhoodIndex> createEmpty() const override
+		{
+			return std::unique_ptr<NeighbourhoodIndex>(new RegionIndex(m_prototype->createEmpty(), m_regionCount, m_halo, m_imbalance));
+		}
+
+		virtual void visit(const Math::Vector2f & position, float radius, Visitor & visitor) const override
+		{
+			if (m_regions.empty()) { return; }
+			if (radius <= m_halo)
+			{
+				m_regions[locate(position)].m_index->visit(position, radius, visitor);
+				return;
+			}
+			forEachOverlappingRegion(position, radius, [this, &position, radius, &visitor](std::uint32_t region)
+			{
+				OwnedVisitor owned(m_owners, region, visitor);
+				m_regions[region].m_index->visit(position, radius, owned);
+			});
+		}
+	};
+}
@@ -1,45 +1,151 @@
 #pragma once
 
 #include <Crowds/Agent.h>
+#include <Crowds/KinematicStorage.h>
+#include <Crowds/NeighbourhoodIndex.h>
+#include <Crowds/RegionIndex.h>
+#include <Crowds/LevelOfDetail.h>
 #include <vector>
 #include <memory>
 #include <stdext/message_handler.h>
+#include <stdext/type_id.h>
+#include <stdext/chrono/timer.h>
 #include <tbb/task_group.h>
+#include <tbb/parallel_for.h>
+#include <tbb/blocked_range.h>
+#include <tbb/enumerable_thread_specific.h>
 
 namespace Crowds
 {
 	/// <summary>
 	/// The simulator of 2D agents navigating in an environment. This class simulates all the agents and provided
-	/// a neighborhood data structure accelerating neighbourhood requests.
+	/// a neighborhood data structure accelerating neighbourhood requests. The neighbourhood data structure is pluggable (see
+	/// <see cref="setNeighbourhoodIndex"/>), a <see cref="GridIndex"/> is used by default.
+	/// In addition to the index of all agents, the simulator maintains one index per registered agent type (see <see cref="registerType"/>)
+	/// containing the agents of this type and of its subtypes. Typed requests on a registered type only visit the relevant agents and do
+	/// not use RTTI, requests on other types filter the index of all agents with dynamic_cast.
+	/// When the index of all agents is a <see cref="RegionIndex"/>, two phase agents are updated region by region, one task per region.
 	/// </summary>
 	class Simulator : public stdext::message_handler
 	{
+	public:
+		/// <summary>
+		/// Time spent in the phases of <see cref="update"/> since the last call to <see cref="resetProfile"/>, in seconds. The steering phase
+		/// is split between perception (neighbourhood requests) and steering (decisions) in proportion of the thread time spent by the
+		/// agents in the requests, so that the phases add up to the time of the updates.
+		/// </summary>
+		struct Profile
+		{
+			double m_perception;
+			double m_steering;
+			/// <summary> Commit phase of the two phase agents </summary>
+			double m_integration;
+			/// <summary> Delivery of the messages deferred during the two phases </summary>
+			double m_delivery;
+			/// <summary> Update of the sequential agents </summary>
+			double m_sequential;
+			/// <summary> Rebuild of the neighbourhood indexes </summary>
+			double m_rebuild;
+			std::uint64_t m_steps;
+		};
+
 	protected:
+		/// <summary>
+		/// Thread time spent in steer and in the neighbourhood requests during the steering phase (profiling).
+		/// </summary>
+		struct ThreadTimes
+		{
+			double m_steer = 0.0;
+			double m_requests = 0.0;
+		};
+
+		/// <summary>
+		/// Accumulates the time of a neighbourhood request in the thread times when profiling is enabled.
+		/// </summary>
+		class RequestTimer
+		{
+			const Simulator & m_simulator;
+			stdext::chrono::timer<> m_timer;
+
+		public:
+			RequestTimer(const Simulator & simulator)
+				: m_simulator(simulator)
+			{
+				if (m_simulator.m_profiling) { m_timer.start(); }
+			}
+
+			~RequestTimer()
+			{
+				if (!m_simulator.m_profiling) { return; }
+				m_timer.stop();
+				m_simulator.m_threadTimes.local().m_requests += m_timer.elapsed_time().count();
+			}
+		};
+
+		/// <summary>
+		/// The index of the agents of a registered type.
+		/// </summary>
+		struct TypedIndex
+		{
+			std::unique_ptr<NeighbourhoodIndex> m_index;
+			/// <summary>
+			/// Tests if an agent belongs to the type (only used when agents are created).
+			/// </summary>
+			bool(*m_accepts)(const Agent *);
+		};
+
+		/// <summary>
+		/// The kinematic state of the agents, declared first so that it is destroyed after the agents.
+		/// </summary>
+		KinematicStorage m_kinematics;
 		std::vector<std::shared_ptr<Agent>> m_agents;
 		double m_time;
-		MotionPlanning::VPTree<std::shared_ptr<Agent>, Math::Vector2f> m_neighbourhoodTree;
+		/// <summary>
+		/// The number of simulation steps.
+		/// </summary>
+		std::uint64_t m_step;
+		LevelOfDetail m_levelOfDetail;
+		std::unique_ptr<NeighbourhoodIndex> m_neighbourhoodIndex;
+		/// <summary>
+		/// m_neighbourhoodIndex if it partitions the world in regions, nullptr otherwise.
+		/// </summary>
+		const RegionIndex * m_regionIndex;
+		/// <summary>
+		/// The indexes of the registered types, by stdext::type_id (null index for unregistered types).
+		/// </summary>
+		std::vector<TypedIndex> m_typedIndexes;
 		//stdext::message_handler m_messageHandler;
 		bool m_needsInitialisation;
 		tbb::task_group * m_tasksGroup;
+		/// <summary>
+		/// The seed of the random generators of the agents (see Agent::random).
+		/// </summary>
+		std::uint32_t m_seed;
+		bool m_profiling;
+		Profile m_profile;
+		mutable tbb::enumerable_thread_specific<ThreadTimes> m_threadTimes;
+
+		/// <summary>
+		/// Rebuilds the index of all agents and the indexes of the registered types.
+		/// </summary>
+		void rebuildIndexes()
+		{
+			m_neighbourhoodIndex->rebuild();
+			for (TypedIndex & typed : m_typedIndexes)
+			{
+				if (typed.m_index) { typed.m_index->rebuild(); }
+			}
+		}
 
 	public:
 		/// <summary>
 		/// Initializes a new instance of the <see cref="Simulator"/> class.
 		/// </summary>
 		Simulator()
-			: m_time(0), m_neighbourhoodTree(
-				[](const std::shared_ptr<Agent> & a1, const std::shared_ptr<Agent> & a2)
-				{
-					return (a1->getPosition() - a2->getPosition()).norm();
-				},
-				[](const std::shared_ptr<Agent> & agent, const Math::Vector2f & position)
-				{
-					return (agent->getPosition() - position).norm();
-				}
-			),
-			m_needsInitialisation(true)
+			: m_time(0), m_step(0), m_neighbourhoodIndex(new GridIndex), m_regionIndex(nullptr), m_needsInitialisation(true), m_seed(1), m_profiling(false)
 		{
 			m_tasksGroup = new tbb::task_group;
+			resetProfile();
 		}
 
 		/// <summary>
@@ -49,6 +155,7 @@ namespace Crowds
 		{
 			try
 			{
+				m_tasksGroup->wait();
 				delete m_tasksGroup;
 			}
 			catch (const std::exception & e)
@@ -63,6 +170,82 @@ namespace Crowds
 		/// <returns></returns>
 		//stdext::message_handler & getMessageHandler() { return m_messageHandler; }
 
+		/// <summary>
+		/// Replaces the neighbourhood data structure. The agents of the previous one are transferred to the new one.
+		/// </summary>
+		/// <param name="index">The new neighbourhood index.</param>
+		void setNeighbourhoodIndex(std::unique_ptr<NeighbourhoodIndex> index)
+		{
+			assert(index != nullptr);
+			m_tasksGroup->wait();
+			for (const std::shared_ptr<Agent> & agent : m_neighbourhoodIndex->getAgents()) { index->add(agent); }
+			index->rebuild();
+			for (TypedIndex & typed : m_typedIndexes)
+			{
+				if (!typed.m_index) { continue; }
+				std::unique_ptr<NeighbourhoodIndex> typedIndex = index->createEmpty();
+				for (const std::shared_ptr<Agent> & agent : typed.m_index->getAgents()) { typedIndex->add(agent); }
+				typedIndex->rebuild();
+				typed.m_index = std::move(typedIndex);
+			}
+			m_neighbourhoodIndex = std::move(index);
+			m_regionIndex = dynamic_cast<const RegionIndex*>(m_neighbourhoodIndex.get());
+		}
+
+		/// <summary>
+		/// Registers an agent type: an index containing the agents of this type and of its subtypes is maintained. The types of the created
+		/// agents are automatically registered, registering a base type (e.g. Boid) accelerates the requests on this type.
+		/// </summary>
+		template <typename EntityType>
+		void registerType()
+		{
+			static_assert(std::is_base_of<Agent, EntityType>::value, "Base class of EntityType should be Agent");
+			if (std::is_same<EntityType, Agent>::value) { return; }
+			stdext::type_id_t id = stdext::type_id<EntityType>();
+			if (id < m_typedIndexes.size() && m_typedIndexes[id].m_index) { return; }
+			m_tasksGroup->wait();
+			if (id >= m_typedIndexes.size()) { m_typedIndexes.resize(id + 1); }
+			TypedIndex & typed = m_typedIndexes[id];
+			typed.m_accepts = [](const Agent * agent) { return dynamic_cast<const EntityType*>(agent) != nullptr; };
+			typed.m_index = m_neighbourhoodIndex->createEmpty();
+			for (const std::shared_ptr<Agent> & agent : m_neighbourhoodIndex->getAgents())
+			{
+				if (typed.m_accepts(agent.get())) { typed.m_index->add(agent); }
+			}
+			typed.m_index->rebuild();
+		}
+
+		/// <summary>
+		/// Gets the index of the agents of the provided type.
+		/// </summary>
+		/// <returns>The index or nullptr if the type is not registered.</returns>
+		template <typename EntityType>
+		const NeighbourhoodIndex * getNeighbourhoodIndex() const
+		{
+			if (std::is_same<EntityType, Agent>::value) { return m_neighbourhoodIndex.get(); }
+			stdext::type_id_t id = stdext::type_id<EntityType>();
+			if (id < m_typedIndexes.size()) { return m_typedIndexes[id].m_index.get(); }
+			return nullptr;
+		}
+
+		/// <summary>
+		/// Gets the kinematic state of the agents.
+		/// </summary>
+		/// <returns></returns>
+		KinematicStorage & getKinematics() { return m_kinematics; }
+
+		/// <summary>
+		/// Gets the kinematic state of the agents.
+		/// </summary>
+		/// <returns></returns>
+		const KinematicStorage & getKinematics() const { return m_kinematics; }
+
+		/// <summary>
+		/// Gets the neighbourhood data structure.
+		/// </summary>
+		/// <returns></returns>
+		const NeighbourhoodIndex & getNeighbourhoodIndex() const { return *m_neighbourhoodIndex; }
+
 		/// <summary>
 		/// Gets the absolute time.
 		/// </summary>
@@ -70,28 +253,195 @@ namespace Crowds
 		double getTime() const { return m_time; }
 
 		/// <summary>
-		/// Updates all agents.
+		/// Sets the seed of the random generators of the agents created after this call (see Agent::random).
+		/// </summary>
+		/// <param name="seed">The seed.</param>
+		void setSeed(std::uint32_t seed) { m_seed = seed; }
+
+		/// <summary>
+		/// Gets the seed of the random generators of the agents.
+		/// </summary>
+		/// <returns></returns>
+		std::uint32_t getSeed() const { return m_seed; }
+
+		/// <summary>
+		/// Enables or disables the measure of the time spent in the phases of the updates (see <see cref="getProfile"/>).
+		/// </summary>
+		/// <param name="profiling">true to enable profiling.</param>
+		void setProfiling(bool profiling) { m_profiling = profiling; }
+
+		/// <summary>
+		/// Tests if profiling is enabled.
+		/// </summary>
+		/// <returns></returns>
+		bool isProfiling() const { return m_profiling; }
+
+		/// <summary>
+		/// Gets the time spent in the phases of the updates since the last reset. Waits for the end of the rebuild of the indexes.
+		/// </summary>
+		/// <returns></returns>
+		const Profile & getProfile()
+		{
+			m_tasksGroup->wait();
+			return m_profile;
+		}
+
+		/// <summary>
+		/// Resets the profile.
+		/// </summary>
+		void resetProfile()
+		{
+			m_tasksGroup->wait();
+			m_profile = Profile{ 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0 };
+		}
+
+		/// <summary>
+		/// Gets the number of simulation steps since the creation of the simulator.
+		/// </summary>
+		/// <returns></returns>
+		std::uint64_t getStep() const { return m_step; }
+
+		/// <summary>
+		/// Gets the level of detail, used to reduce the steering frequency of the agents far from its focus.
+		/// </summary>
+		/// <returns></returns>
+		LevelOfDetail & getLevelOfDetail() { return m_levelOfDetail; }
+
+		/// <summary>
+		/// Gets the level of detail.
+		/// </summary>
+		/// <returns></returns>
+		const LevelOfDetail & getLevelOfDetail() const { return m_levelOfDetail; }
+
+		/// <summary>
+		/// Gets the update period of an agent: the greatest of the period it declares and of the period of its level of detail.
+		/// </summary>
+		/// <param name="agent">The agent.</param>
+		/// <returns></returns>
+		unsigned int getUpdatePeriod(const Agent & agent) const
+		{
+			return std::max(agent.getUpdatePeriod(), m_levelOfDetail.getUpdatePeriod(agent.getPosition()));
+		}
+
+		/// <summary>
+		/// Tests if an agent steers during the current step. Agents sharing an update period steer in round robin: their steps are
+		/// shifted by the index of their slot, so that each step only runs the decisions of a 1/period share of them.
+		/// </summary>
+		/// <param name="agent">The agent.</param>
+		/// <returns></returns>
+		bool isSteeringStep(const Agent & agent) const
+		{
+			return (m_step + agent.getIndex()) % getUpdatePeriod(agent) == 0;
+		}
+
+		/// <summary>
+		/// Updates all agents. Two phase agents (see <see cref="Agent::UpdateMode"/>) first steer in parallel while positions and
+		/// speeds are frozen, then commit in parallel. Their result does not depend on the order of the agents. The messages they send
+		/// are deferred and delivered after the commit phase, ordered by agent (see <see cref="stdext::message_handler::flush"/>).
+		/// Sequential agents are then updated in creation order, their messages are delivered immediately.
+		/// Two phase agents only steer during their steering steps (see <see cref="isSteeringStep"/>) but commit at each step.
 		/// </summary>
 		/// <param name="dt">The dt.</param>
 		virtual void update(double dt)
 		{
-			//std::cout << "Number of simulated agents: " << m_agents.size() << ", in tree " << m_neighbourhoodTree.size() << std::endl;
+			//std::cout << "Number of simulated agents: " << m_agents.size() << ", in tree " << m_neighbourhoodIndex->size() << std::endl;
 			if (m_needsInitialisation)
 			{
-				m_neighbourhoodTree.recompute();
+				rebuildIndexes();
 				m_needsInitialisation = false;
 			}
 			m_tasksGroup->wait();
+			// The agents of the index of all agents and of the simulator are in the same order, the regions are used as long as they
+			// contain all agents (agents created since the last rebuild are not in a region)
+			bool byRegion = m_regionIndex != nullptr && m_regionIndex->getPartitionedSize() == m_agents.size() && m_regionIndex->size() == m_agents.size();
+			auto forEachTwoPhase = [this, byRegion](std::uint64_t phase, auto && function)
+			{
+				auto process = [this, phase, &function](size_t cpt)
+				{
+					Agent * agent = m_agents[cpt].get();
+					if (agent->getStatus() == Agent::Status::running && agent->getUpdateMode() == Agent::UpdateMode::twoPhase)
+					{
+						setEmitter(phase * m_agents.size() + cpt);
+						function(agent);
+					}
+				};
+				if (byRegion)
+				{
+					m_regionIndex->forEachRegion([this, &process](size_t region)
+					{
+						for (std::uint32_t cpt : m_regionIndex->getOwnedAgents(region)) { process(cpt); }
+					});
+					return;
+				}
+				tbb::parallel_for(tbb::blocked_range<size_t>(0, m_agents.size()), [&process](const tbb::blocked_range<size_t> & range)
+				{
+					for (size_t cpt = range.begin(); cpt != range.end(); ++cpt) { process(cpt); }
+				});
+			};
+			stdext::chrono::timer<> timer;
+			auto measure = [this, &timer](double & phase)
+			{
+				if (!m_profiling) { return; }
+				timer.stop();
+				phase += timer.elapsed_time().count();
+				timer.start();
+			};
+			if (m_profiling)
+			{
+				for (ThreadTimes & times : m_threadTimes) { times = ThreadTimes(); }
+				timer.start();
+			}
+			setDeferred(true);
+			// Phase 1: decisions are computed from the state of the previous step
+			forEachTwoPhase(0, [this, dt](Agent * agent)
+			{
+				agent->m_steered = isSteeringStep(*agent);
+				if (!agent->m_steered) { return; }
+				// The decision holds until the next steering step of the agent
+				double interval = dt * getUpdatePeriod(*agent);
+				if (!m_profiling) { agent->steer(interval); return; }
+				stdext::chrono::timer<> steerTimer;
+				steerTimer.start();
+				agent->steer(interval);
+				steerTimer.stop();
+				m_threadTimes.local().m_steer += steerTimer.elapsed_time().count();
+			});
+			if (m_profiling)
+			{
+				double steering = 0.0;
+				measure(steering);
+				double steer = 0.0, requests = 0.0;
+				for (const ThreadTimes & times : m_threadTimes) { steer += times.m_steer; requests += times.m_requests; }
+				double perception = steer > 0.0 ? steering * std::min(requests / steer, 1.0) : 0.0;
+				m_profile.m_perception += perception;
+				m_profile.m_steering += steering - perception;
+			}
+			// Phase 2: each agent only writes its own state
+			forEachTwoPhase(1, [dt](Agent * agent) { agent->commit(dt); });
+			measure(m_profile.m_integration);
+			setDeferred(false);
+			flush();
+			measure(m_profile.m_delivery);
 			for (auto it = m_agents.begin(), end = m_agents.end(); it != end; ++it)
 			{
-				if ((*it)->getStatus() == Agent::Status::running)
+				if ((*it)->getStatus() == Agent::Status::running && (*it)->getUpdateMode() == Agent::UpdateMode::sequential)
 				{
 					(*it)->update(dt);
 				}
 			}
-			auto updateNeighourhood = [this]() { m_neighbourhoodTree.recompute(); };
+			measure(m_profile.m_sequential);
+			auto updateNeighourhood = [this]()
+			{
+				stdext::chrono::timer<> rebuildTimer;
+				rebuildTimer.start();
+				rebuildIndexes();
+				rebuildTimer.stop();
+				if (m_profiling) { m_profile.m_rebuild += rebuildTimer.elapsed_time().count(); }
+			};
 			m_tasksGroup->run(updateNeighourhood);
 			m_time += dt;
+			++m_step;
+			if (m_profiling) { ++m_profile.m_steps; }
 		}
 
 		/// <summary>
@@ -104,9 +454,14 @@ namespace Crowds
 		{
 			m_tasksGroup->wait(); // We  cannot create an agent while the data structure is updated
 			static_assert(std::is_base_of<Agent, AgentType>::value, "AgentType must inherit from Agent!");
+			registerType<AgentType>();
 			std::shared_ptr<AgentType> agent(new AgentType(this, params...));
 			m_agents.push_back(agent);
-			m_neighbourhoodTree.add(agent);
+			m_neighbourhoodIndex->add(agent);
+			for (TypedIndex & typed : m_typedIndexes)
+			{
+				if (typed.m_index && typed.m_accepts(agent.get())) { typed.m_index->add(agent); }
+			}
 			return agent;
 		}
 
@@ -134,7 +489,10 @@ namespace Crowds
 		/// <returns></returns>
 		std::vector<std::shared_ptr<Agent>> selectEntities(const Math::Vector2f & position, float radius)
 		{
-			return m_neighbourhoodTree.select(position, radius);
+			RequestTimer requestTimer(*this);
+			std::vector<std::shared_ptr<Agent>> result;
+			m_neighbourhoodIndex->select(position, radius, result);
+			return result;
 		}
 
 		/// <summary>
@@ -147,20 +505,44 @@ namespace Crowds
 		std::vector<std::shared_ptr<EntityType>> selectEntities(const Math::Vector2f & position, float radius)
 		{
 			static_assert(std::is_base_of<Agent, EntityType>::value, "Base class of EntityType should be Agent");
-			std::vector<std::shared_ptr<Agent>> tmp = selectEntities(position, radius);
+			RequestTimer requestTimer(*this);
 			std::vector<std::shared_ptr<EntityType>> result;
-			result.reserve(tmp.size());
-			for (auto it = tmp.begin(), end = tmp.end(); it != end; ++it)
+			if (const NeighbourhoodIndex * typed = getNeighbourhoodIndex<EntityType>())
 			{
-				std::shared_ptr<EntityType> e = std::dynamic_pointer_cast<EntityType>(*it);
-				if (e)
-				{
-					result.push_back(e);
-				}
+				typed->forEach(position, radius, [&result](const std::shared_ptr<Agent> & agent) { result.push_back(std::static_pointer_cast<EntityType>(agent)); });
+				return result;
 			}
+			m_neighbourhoodIndex->forEach(position, radius, [&result](const std::shared_ptr<Agent> & agent)
+			{
+				if (dynamic_cast<EntityType*>(agent.get()) != nullptr) { result.push_back(std::static_pointer_cast<EntityType>(agent)); }
+			});
 			return result;
 		}
 
+		/// <summary>
+		/// Calls function(EntityType &amp;) for each agent of the provided type in the provided circle. Contrary to selectEntities, this
+		/// method neither allocates memory nor copies shared pointers.
+		/// </summary>
+		/// <param name="position">The position.</param>
+		/// <param name="radius">The radius.</param>
+		/// <param name="function">The function.</param>
+		template <typename EntityType = Agent, typename Function>
+		void forEachNeighbour(const Math::Vector2f & position, float radius, const Function & function) const
+		{
+			static_assert(std::is_base_of<Agent, EntityType>::value, "Base class of EntityType should be Agent");
+			RequestTimer requestTimer(*this);
+			if (const NeighbourhoodIndex * typed = getNeighbourhoodIndex<EntityType>())
+			{
+				typed->forEach(position, radius, [&function](const std::shared_ptr<Agent> & agent) { function(static_cast<EntityType&>(*agent)); });
+				return;
+			}
+			m_neighbourhoodIndex->forEach(position, radius, [&function](const std::shared_ptr<Agent> & agent)
+			{
+				EntityType * entity = dynamic_cast<EntityType*>(agent.get());
+				if (entity != nullptr) { function(*entity); }
+			});
+		}
+
 		/// <summary>
 		/// Gets the agents.
 		/// </summary>
@@ -178,11 +560,7 @@ namespace Crowds
 		template <typename MessageType>
 		void post(const MessageType & message, const Math::Vector2f & position, float radius)
 		{
-			std::vector<std::shared_ptr<Agent>> neighbours = selectEntities(position, radius);
-			std::vector<Agent*> agents;
-			agents.reserve(neighbours.size());
-			std::transform(neighbours.begin(), neighbours.end(), std::back_inserter(agents), [](const std::shared_ptr<Agent> & ptr) { return ptr.get();  });
-			post(message, agents);
+			forEachNeighbour(position, radius, [this, &message](Agent & agent) { message_handler::post(message, &agent); });
 		}
 	};
 }
\ No newline at end of file
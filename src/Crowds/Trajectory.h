@@ -0,0 +1,194 @@
+#pragma once
+
+#include <Crowds/KinematicStorage.h>
+#include <Math/Vectorf.h>
+#include <filesystem>
+#include <fstream>
+#include <vector>
+#include <cstdint>
+
+namespace Crowds
+{
+	class Simulator;
+
+	/// <summary>
+	/// The state of all the slots of a <see cref="KinematicStorage"/> at a simulation step, as decoded by a <see cref="TrajectoryReader"/>.
+	/// Positions, orientations and radii are quantized by the recorder.
+	/// </summary>
+	struct TrajectoryFrame
+	{
+		/// <summary>
+		/// Status of a free slot (the other values are the ones of Agent::Status).
+		/// </summary>
+		static constexpr std::uint8_t freeSlot = 0xFF;
+
+		double m_time;
+		std::vector<Math::Vector2f> m_positions;
+		std::vector<float> m_orientations;
+		std::vector<float> m_radii;
+		std::vector<std::uint8_t> m_statuses;
+
+		/// <summary>
+		/// Returns the number of slots.
+		/// </summary>
+		/// <returns></returns>
+		size_t size() const { return m_statuses.size(); }
+	};
+
+	/// <summary>
+	/// Entry of the index of the chunks of a trajectory file: offset of the chunk header, first frame and number of frames.
+	/// </summary>
+	struct TrajectoryChunk
+	{
+		std::uint64_t m_offset;
+		std::uint64_t m_firstFrame;
+		std::uint32_t m_frames;
+	};
+
+	/// <summary>
+	/// Streams the states of the agents of a simulation in a compact binary file, one frame per call to <see cref="record"/>.
+	/// Positions are quantized on a grid of step positionQuantum, orientations on 16 bits, radii on the position grid. Frames are
+	/// grouped in chunks of framesPerChunk frames: the first frame of a chunk is encoded from scratch (key frame), the others store
+	/// the differences with the previous frame as variable length integers and skip the unchanged values, so that a chunk is a
+	/// sequence of small, repetitive bytes that general purpose compressors handle well. An index of the chunks is appended when
+	/// the recorder is closed, a <see cref="TrajectoryReader"/> uses it to access any frame by decoding at most one chunk.
+	/// </summary>
+	class TrajectoryRecorder
+	{
+		std::ofstream m_output;
+		float m_positionQuantum;
+		std::uint32_t m_framesPerChunk;
+		/// <summary>
+		/// The payload of the current chunk.
+		/// </summary>
+		std::vector<std::uint8_t> m_chunk;
+		std::uint32_t m_chunkFrames;
+		std::uint64_t m_frames;
+		/// <summary>
+		/// The quantized values of the previous frame.
+		/// </summary>
+		std::vector<std::int32_t> m_x, m_y, m_orientations, m_radii;
+		std::vector<TrajectoryChunk> m_index;
+
+		/// <summary>
+		/// Writes the current chunk in the file.
+		/// </summary>
+		void flushChunk();
+
+	public:
+		/// <summary>
+		/// Creates the file and writes its header.
+		/// </summary>
+		/// <param name="file">The file.</param>
+		/// <param name="positionQuantum">The quantization step of the positions and radii.</param>
+		/// <param name="framesPerChunk">The number of frames of a chunk (the interval between two key frames).</param>
+		TrajectoryRecorder(const std::filesystem::path & file, float positionQuantum = 1.0f / 256.0f, std::uint32_t framesPerChunk = 64);
+
+		TrajectoryRecorder(const TrajectoryRecorder &) = delete;
+		TrajectoryRecorder & operator = (const TrajectoryRecorder &) = delete;
+
+		/// <summary>
+		/// Closes the file if needed.
+		/// </summary>
+		~TrajectoryRecorder();
+
+		/// <summary>
+		/// Records a frame from a kinematic storage.
+		/// </summary>
+		/// <param name="time">The simulation time.</param>
+		/// <param name="kinematics">The kinematic storage.</param>
+		void record(double time, const KinematicStorage & kinematics);
+
+		/// <summary>
+		/// Records the current state of a simulator. Must not be called during Simulator::update.
+		/// </summary>
+		/// <param name="simulator">The simulator.</param>
+		void record(const Simulator & simulator);
+
+		/// <summary>
+		/// Returns the number of recorded frames.
+		/// </summary>
+		/// <returns></returns>
+		std::uint64_t getFrameCount() const { return m_frames; }
+
+		/// <summary>
+		/// Writes the last chunk and the index of the chunks, then closes the file. No frame can be recorded after this call.
+		/// </summary>
+		void close();
+	};
+
+	/// <summary>
+	/// Reads a file written by a <see cref="TrajectoryRecorder"/>. Frames can be read in any order: reading the next frame only decodes
+	/// that frame, reading another one decodes its chunk from the key frame. A file whose recorder was not closed (e.g. after a crash)
+	/// has no index, its complete chunks are found by scanning the file.
+	/// </summary>
+	class TrajectoryReader
+	{
+		std::ifstream m_input;
+		std::uint64_t m_fileSize;
+		float m_positionQuantum;
+		std::vector<TrajectoryChunk> m_index;
+		std::uint64_t m_frames;
+
+		/// <summary>
+		/// The chunk being decoded, its payload and the position of the next frame in the payload.
+		/// </summary>
+		size_t m_chunk;
+		std::vector<std::uint8_t> m_payload;
+		size_t m_cursor;
+		/// <summary>
+		/// The index of the next frame of the chunk to decode.
+		/// </summary>
+		std::uint64_t m_next;
+		std::vector<std::int32_t> m_x, m_y, m_orientations, m_radii;
+		TrajectoryFrame m_current;
+
+		/// <summary>
+		/// Reads the index written when the recorder was closed.
+		/// </summary>
+		/// <returns>false if the file has no valid index.</returns>
+		bool readIndex();
+
+		/// <summary>
+		/// Builds the index of the chunks by scanning the file.
+		/// </summary>
+		/// <param name="begin">The offset of the first chunk.</param>
+		void scan(std::uint64_t begin);
+
+		/// <summary>
+		/// Loads the payload of a chunk and resets the decoding state.
+		/// </summary>
+		void loadChunk(size_t chunk);
+
+		/// <summary>
+		/// Decodes the next frame of the current chunk.
+		/// </summary>
+		void decodeFrame();
+
+	public:
+		/// <summary>
+		/// Opens a file.
+		/// </summary>
+		/// <param name="file">The file.</param>
+		TrajectoryReader(const std::filesystem::path & file);
+
+		/// <summary>
+		/// Returns the number of frames.
+		/// </summary>
+		/// <returns></returns>
+		std::uint64_t getFrameCount() const { return m_frames; }
+
+		/// <summary>
+		/// Gets the quantization step of the positions and radii.
+		/// </summary>
+		/// <returns></returns>
+		float getPositionQuantum() const { return m_positionQuantum; }
+
+		/// <summary>
+		/// Reads a frame. The returned reference is valid until the next call.
+		/// </summary>
+		/// <param name="frame">The index of the frame.</param>
+		/// <returns></returns>
+		const TrajectoryFrame & read(std::uint64_t frame);
+	};
+}
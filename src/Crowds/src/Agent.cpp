@@ -0,0 +1,32 @@
+#include <Crowds/Agent.h>
+#include <Crowds/Simulator.h>
+
+namespace Crowds
+{
+	namespace
+	{
+		/// <summary>
+		/// Mixes the seed of the simulator and the index of an agent (splitmix64 finalizer): minstd_rand seeded with consecutive values
+		/// produces nearly proportional first outputs, the streams of neighbouring agents would be correlated.
+		/// </summary>
+		std::uint32_t agentSeed(std::uint32_t seed, std::uint32_t index)
+		{
+			std::uint64_t z = (std::uint64_t(seed) << 32 | index) + 0x9E3779B97F4A7C15ull;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return std::uint32_t(z ^ (z >> 31));
+		}
+	}
+
+	Agent::Agent(Simulator * simulator, const Math::Vector2f & position, float radius)
+		: m_simulator(simulator), m_kinematics(&simulator->getKinematics()),
+		m_index(m_kinematics->create(this, position, radius, Math::Interval<float>(-Math::pi, Math::pi).random(), std::uint8_t(Status::running))),
+		m_updatePeriod(1), m_steered(false),
+		m_random(agentSeed(simulator->getSeed(), std::uint32_t(m_index)))
+	{}
+
+	Agent::~Agent()
+	{
+		m_kinematics->release(m_index);
+	}
+}
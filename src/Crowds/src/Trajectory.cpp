@@ -0,0 +1,405 @@
+#include <Crowds/Trajectory.h>
+#include <Crowds/Simulator.h>
+#include <Math/Constant.h>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+#include <cmath>
+#include <limits>
+
+namespace Crowds
+{
+	namespace
+	{
+		// File layout (little endian):
+		// - header: "CTRJ", version (u32), position quantum (f32), frames per chunk (u32)
+		// - chunks: "CHNK", number of frames (u32), first frame (u64), payload size (u64), payload
+		// - index (written by close): "CIDX", number of chunks (u64), per chunk: offset (u64), first frame (u64), number of frames (u32)
+		// - footer (written by close): offset of the index (u64), "CEND"
+		// Frame in a payload: time (f64), number of slots (varint), per slot: flags (u8) followed by the changed values (zigzag varints).
+		const char headerMagic[4] = { 'C', 'T', 'R', 'J' };
+		const char chunkMagic[4] = { 'C', 'H', 'N', 'K' };
+		const char indexMagic[4] = { 'C', 'I', 'D', 'X' };
+		const char footerMagic[4] = { 'C', 'E', 'N', 'D' };
+		const std::uint32_t version = 1;
+		const std::uint64_t headerSize = 16;
+		const std::uint64_t chunkHeaderSize = 24;
+		const std::uint64_t footerSize = 12;
+
+		// Flags of a slot: bits 0-1 status (0 free slot, 1 + Agent::Status otherwise), then the changed values
+		const std::uint8_t statusMask = 0x03;
+		const std::uint8_t positionChanged = 0x04;
+		const std::uint8_t orientationChanged = 0x08;
+		const std::uint8_t radiusChanged = 0x10;
+
+		/// <summary>
+		/// Number of quantization steps of the orientations (16 bits on [-pi;pi[).
+		/// </summary>
+		const float orientationSteps = 65536.0f;
+
+		void write(std::vector<std::uint8_t> & buffer, std::uint64_t value, size_t bytes)
+		{
+			for (size_t cpt = 0; cpt < bytes; ++cpt) { buffer.push_back(std::uint8_t(value >> (8 * cpt))); }
+		}
+
+		void writeMagic(std::vector<std::uint8_t> & buffer, const char(&magic)[4])
+		{
+			buffer.insert(buffer.end(), magic, magic + 4);
+		}
+
+		void writeFloat(std::vector<std::uint8_t> & buffer, float value)
+		{
+			std::uint32_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			write(buffer, bits, 4);
+		}
+
+		void writeDouble(std::vector<std::uint8_t> & buffer, double value)
+		{
+			std::uint64_t bits;
+			std::memcpy(&bits, &value, sizeof(bits));
+			write(buffer, bits, 8);
+		}
+
+		void writeVarint(std::vector<std::uint8_t> & buffer, std::uint64_t value)
+		{
+			while (value >= 0x80)
+			{
+				buffer.push_back(std::uint8_t(value | 0x80));
+				value >>= 7;
+			}
+			buffer.push_back(std::uint8_t(value));
+		}
+
+		void writeSigned(std::vector<std::uint8_t> & buffer, std::int32_t value)
+		{
+			// Zigzag encoding: small negative values are small unsigned values
+			writeVarint(buffer, (std::uint32_t(value) << 1) ^ std::uint32_t(value >> 31));
+		}
+
+		/// <summary>
+		/// Sequential reader of a byte buffer.
+		/// </summary>
+		class ByteReader
+		{
+			const std::vector<std::uint8_t> & m_buffer;
+			size_t & m_cursor;
+
+			void check(size_t bytes) const
+			{
+				if (m_cursor + bytes > m_buffer.size()) { throw std::runtime_error("Crowds::TrajectoryReader: corrupted chunk"); }
+			}
+
+		public:
+			ByteReader(const std::vector<std::uint8_t> & buffer, size_t & cursor)
+				: m_buffer(buffer), m_cursor(cursor)
+			{}
+
+			std::uint64_t read(size_t bytes)
+			{
+				check(bytes);
+				std::uint64_t result = 0;
+				for (size_t cpt = 0; cpt < bytes; ++cpt) { result |= std::uint64_t(m_buffer[m_cursor++]) << (8 * cpt); }
+				return result;
+			}
+
+			double readDouble()
+			{
+				std::uint64_t bits = read(8);
+				double result;
+				std::memcpy(&result, &bits, sizeof(result));
+				return result;
+			}
+
+			std::uint64_t readVarint()
+			{
+				std::uint64_t result = 0;
+				for (int shift = 0; shift < 64; shift += 7)
+				{
+					std::uint8_t byte = std::uint8_t(read(1));
+					result |= std::uint64_t(byte & 0x7F) << shift;
+					if ((byte & 0x80) == 0) { return result; }
+				}
+				throw std::runtime_error("Crowds::TrajectoryReader: corrupted chunk");
+			}
+
+			std::int32_t readSigned()
+			{
+				std::uint32_t value = std::uint32_t(readVarint());
+				return std::int32_t(value >> 1) ^ -std::int32_t(value & 1);
+			}
+		};
+
+		/// <summary>
+		/// Quantizes a coordinate, the values out of the int32 range (agents moved to infinity) are clamped.
+		/// </summary>
+		std::int32_t quantize(float value, float inverseQuantum)
+		{
+			const float limit = float(1 << 30);
+			float scaled = value * inverseQuantum;
+			if (!(scaled == scaled)) { return 0; } // NaN
+			return std::int32_t(std::lround(std::clamp(scaled, -limit, limit)));
+		}
+
+		/// <summary>
+		/// Wraps a quantized orientation (or a difference of orientations) in [-32768;32767].
+		/// </summary>
+		std::int32_t wrapOrientation(std::int32_t value)
+		{
+			return std::int32_t(std::int16_t(std::uint16_t(std::uint32_t(value) & 0xFFFF)));
+		}
+
+		std::int32_t quantizeOrientation(float orientation)
+		{
+			if (!(orientation == orientation)) { return 0; }
+			float scaled = std::fmod(orientation / (2.0f * float(Math::pi)), 1.0f) * orientationSteps;
+			return wrapOrientation(std::int32_t(std::lround(scaled)));
+		}
+
+		std::uint64_t readHeaderValue(std::ifstream & input, size_t bytes)
+		{
+			std::uint8_t buffer[8];
+			input.read(reinterpret_cast<char*>(buffer), std::streamsize(bytes));
+			std::uint64_t result = 0;
+			for (size_t cpt = 0; cpt < bytes; ++cpt) { result |= std::uint64_t(buffer[cpt]) << (8 * cpt); }
+			return result;
+		}
+
+		bool readHeaderMagic(std::ifstream & input, const char(&magic)[4])
+		{
+			char buffer[4];
+			input.read(buffer, 4);
+			return input && std::memcmp(buffer, magic, 4) == 0;
+		}
+	}
+
+	TrajectoryRecorder::TrajectoryRecorder(const std::filesystem::path & file, float positionQuantum, std::uint32_t framesPerChunk)
+		: m_output(file, std::ios::binary), m_positionQuantum(positionQuantum), m_framesPerChunk(std::max<std::uint32_t>(framesPerChunk, 1)),
+		m_chunkFrames(0), m_frames(0)
+	{
+		if (!m_output) { throw std::runtime_error("Crowds::TrajectoryRecorder: unable to write " + file.string()); }
+		if (!(positionQuantum > 0.0f)) { throw std::invalid_argument("Crowds::TrajectoryRecorder: the position quantum must be positive"); }
+		std::vector<std::uint8_t> header;
+		writeMagic(header, headerMagic);
+		write(header, version, 4);
+		writeFloat(header, m_positionQuantum);
+		write(header, m_framesPerChunk, 4);
+		m_output.write(reinterpret_cast<const char*>(header.data()), std::streamsize(header.size()));
+	}
+
+	TrajectoryRecorder::~TrajectoryRecorder()
+	{
+		try
+		{
+			close();
+		}
+		catch (const std::exception &)
+		{
+			// Destructors must not throw, the file is left without index (it can still be scanned)
+		}
+	}
+
+	void TrajectoryRecorder::flushChunk()
+	{
+		if (m_chunkFrames == 0) { return; }
+		TrajectoryChunk entry = { std::uint64_t(m_output.tellp()), m_frames - m_chunkFrames, m_chunkFrames };
+		std::vector<std::uint8_t> header;
+		writeMagic(header, chunkMagic);
+		write(header, entry.m_frames, 4);
+		write(header, entry.m_firstFrame, 8);
+		write(header, m_chunk.size(), 8);
+		m_output.write(reinterpret_cast<const char*>(header.data()), std::streamsize(header.size()));
+		m_output.write(reinterpret_cast<const char*>(m_chunk.data()), std::streamsize(m_chunk.size()));
+		if (!m_output) { throw std::runtime_error("Crowds::TrajectoryRecorder: write error"); }
+		m_index.push_back(entry);
+		m_chunk.clear();
+		m_chunkFrames = 0;
+	}
+
+	void TrajectoryRecorder::record(double time, const KinematicStorage & kinematics)
+	{
+		if (!m_output.is_open()) { throw std::logic_error("Crowds::TrajectoryRecorder: the recorder is closed"); }
+		if (m_chunkFrames == 0)
+		{
+			// Key frame: the differences are computed from a state where all slots are free and null
+			m_x.clear(); m_y.clear(); m_orientations.clear(); m_radii.clear();
+		}
+		size_t slots = kinematics.slots();
+		m_x.resize(slots, 0); m_y.resize(slots, 0); m_orientations.resize(slots, 0); m_radii.resize(slots, 0);
+		writeDouble(m_chunk, time);
+		writeVarint(m_chunk, slots);
+		float inverseQuantum = 1.0f / m_positionQuantum;
+		for (KinematicStorage::Index index = 0; index < slots; ++index)
+		{
+			if (kinematics.getAgent(index) == nullptr)
+			{
+				// The values of a free slot are kept for the next difference
+				m_chunk.push_back(0);
+				continue;
+			}
+			std::int32_t x = quantize(kinematics.position(index)[0], inverseQuantum);
+			std::int32_t y = quantize(kinematics.position(index)[1], inverseQuantum);
+			std::int32_t orientation = quantizeOrientation(kinematics.orientation(index));
+			std::int32_t radius = quantize(kinematics.radius(index), inverseQuantum);
+			std::uint8_t flags = std::uint8_t(1 + kinematics.status(index)) & statusMask;
+			if (x != m_x[index] || y != m_y[index]) { flags |= positionChanged; }
+			if (orientation != m_orientations[index]) { flags |= orientationChanged; }
+			if (radius != m_radii[index]) { flags |= radiusChanged; }
+			m_chunk.push_back(flags);
+			if (flags & positionChanged)
+			{
+				writeSigned(m_chunk, std::int32_t(std::uint32_t(x) - std::uint32_t(m_x[index])));
+				writeSigned(m_chunk, std::int32_t(std::uint32_t(y) - std::uint32_t(m_y[index])));
+			}
+			if (flags & orientationChanged) { writeSigned(m_chunk, wrapOrientation(orientation - m_orientations[index])); }
+			if (flags & radiusChanged) { writeSigned(m_chunk, std::int32_t(std::uint32_t(radius) - std::uint32_t(m_radii[index]))); }
+			m_x[index] = x; m_y[index] = y; m_orientations[index] = orientation; m_radii[index] = radius;
+		}
+		++m_frames;
+		if (++m_chunkFrames == m_framesPerChunk) { flushChunk(); }
+	}
+
+	void TrajectoryRecorder::record(const Simulator & simulator)
+	{
+		record(simulator.getTime(), simulator.getKinematics());
+	}
+
+	void TrajectoryRecorder::close()
+	{
+		if (!m_output.is_open()) { return; }
+		flushChunk();
+		std::vector<std::uint8_t> index;
+		std::uint64_t indexOffset = std::uint64_t(m_output.tellp());
+		writeMagic(index, indexMagic);
+		write(index, m_index.size(), 8);
+		for (const TrajectoryChunk & entry : m_index)
+		{
+			write(index, entry.m_offset, 8);
+			write(index, entry.m_firstFrame, 8);
+			write(index, entry.m_frames, 4);
+		}
+		write(index, indexOffset, 8);
+		writeMagic(index, footerMagic);
+		m_output.write(reinterpret_cast<const char*>(index.data()), std::streamsize(index.size()));
+		bool failed = !m_output;
+		m_output.close();
+		if (failed) { throw std::runtime_error("Crowds::TrajectoryRecorder: write error"); }
+	}
+
+	TrajectoryReader::TrajectoryReader(const std::filesystem::path & file)
+		: m_input(file, std::ios::binary), m_fileSize(0), m_positionQuantum(1.0f), m_frames(0),
+		m_chunk(std::numeric_limits<size_t>::max()), m_cursor(0), m_next(0)
+	{
+		if (!m_input) { throw std::runtime_error("Crowds::TrajectoryReader: unable to read " + file.string()); }
+		m_input.seekg(0, std::ios::end);
+		m_fileSize = std::uint64_t(m_input.tellg());
+		m_input.seekg(0);
+		if (m_fileSize < headerSize || !readHeaderMagic(m_input, headerMagic) || readHeaderValue(m_input, 4) != version)
+		{
+			throw std::runtime_error("Crowds::TrajectoryReader: " + file.string() + " is not a trajectory file");
+		}
+		std::uint32_t bits = std::uint32_t(readHeaderValue(m_input, 4));
+		std::memcpy(&m_positionQuantum, &bits, sizeof(bits));
+		readHeaderValue(m_input, 4); // frames per chunk, the chunks store their own number of frames
+		if (!readIndex()) { scan(headerSize); }
+		for (const TrajectoryChunk & entry : m_index) { m_frames += entry.m_frames; }
+	}
+
+	bool TrajectoryReader::readIndex()
+	{
+		if (m_fileSize < headerSize + footerSize) { return false; }
+		m_input.clear();
+		m_input.seekg(std::streamoff(m_fileSize - footerSize));
+		std::uint64_t indexOffset = readHeaderValue(m_input, 8);
+		if (!readHeaderMagic(m_input, footerMagic) || indexOffset < headerSize || indexOffset + 12 > m_fileSize - footerSize) { return false; }
+		m_input.seekg(std::streamoff(indexOffset));
+		if (!readHeaderMagic(m_input, indexMagic)) { return false; }
+		std::uint64_t chunks = readHeaderValue(m_input, 8);
+		if (indexOffset + 12 + chunks * 20 != m_fileSize - footerSize) { return false; }
+		m_index.resize(size_t(chunks));
+		for (TrajectoryChunk & entry : m_index)
+		{
+			entry.m_offset = readHeaderValue(m_input, 8);
+			entry.m_firstFrame = readHeaderValue(m_input, 8);
+			entry.m_frames = std::uint32_t(readHeaderValue(m_input, 4));
+		}
+		if (!m_input) { m_index.clear(); return false; }
+		return true;
+	}
+
+	void TrajectoryReader::scan(std::uint64_t begin)
+	{
+		m_index.clear();
+		std::uint64_t offset = begin, firstFrame = 0;
+		while (offset + chunkHeaderSize <= m_fileSize)
+		{
+			m_input.clear();
+			m_input.seekg(std::streamoff(offset));
+			if (!readHeaderMagic(m_input, chunkMagic)) { break; }
+			std::uint32_t frames = std::uint32_t(readHeaderValue(m_input, 4));
+			readHeaderValue(m_input, 8);
+			std::uint64_t payload = readHeaderValue(m_input, 8);
+			// The last chunk of an interrupted recording may be incomplete
+			if (!m_input || payload > m_fileSize - offset - chunkHeaderSize) { break; }
+			m_index.push_back(TrajectoryChunk{ offset, firstFrame, frames });
+			firstFrame += frames;
+			offset += chunkHeaderSize + payload;
+		}
+	}
+
+	void TrajectoryReader::loadChunk(size_t chunk)
+	{
+		const TrajectoryChunk & entry = m_index[chunk];
+		m_input.clear();
+		m_input.seekg(std::streamoff(entry.m_offset + chunkHeaderSize - 8));
+		std::uint64_t payload = readHeaderValue(m_input, 8);
+		m_payload.resize(size_t(payload));
+		m_input.read(reinterpret_cast<char*>(m_payload.data()), std::streamsize(payload));
+		if (!m_input) { throw std::runtime_error("Crowds::TrajectoryReader: read error"); }
+		m_chunk = chunk;
+		m_cursor = 0;
+		m_next = entry.m_firstFrame;
+		// Key frame: same initial state as the recorder
+		m_x.clear(); m_y.clear(); m_orientations.clear(); m_radii.clear();
+		m_current.m_statuses.clear();
+	}
+
+	void TrajectoryReader::decodeFrame()
+	{
+		ByteReader reader(m_payload, m_cursor);
+		m_current.m_time = reader.readDouble();
+		size_t slots = size_t(reader.readVarint());
+		m_x.resize(slots, 0); m_y.resize(slots, 0); m_orientations.resize(slots, 0); m_radii.resize(slots, 0);
+		m_current.m_statuses.resize(slots, TrajectoryFrame::freeSlot);
+		m_current.m_positions.resize(slots);
+		m_current.m_orientations.resize(slots);
+		m_current.m_radii.resize(slots);
+		for (size_t index = 0; index < slots; ++index)
+		{
+			std::uint8_t flags = std::uint8_t(reader.read(1));
+			if (flags & positionChanged)
+			{
+				m_x[index] = std::int32_t(std::uint32_t(m_x[index]) + std::uint32_t(reader.readSigned()));
+				m_y[index] = std::int32_t(std::uint32_t(m_y[index]) + std::uint32_t(reader.readSigned()));
+			}
+			if (flags & orientationChanged) { m_orientations[index] = wrapOrientation(m_orientations[index] + reader.readSigned()); }
+			if (flags & radiusChanged) { m_radii[index] = std::int32_t(std::uint32_t(m_radii[index]) + std::uint32_t(reader.readSigned())); }
+			std::uint8_t status = flags & statusMask;
+			m_current.m_statuses[index] = status == 0 ? TrajectoryFrame::freeSlot : std::uint8_t(status - 1);
+			m_current.m_positions[index] = Math::makeVector(float(m_x[index]) * m_positionQuantum, float(m_y[index]) * m_positionQuantum);
+			m_current.m_orientations[index] = float(m_orientations[index]) * (2.0f * float(Math::pi) / orientationSteps);
+			m_current.m_radii[index] = float(m_radii[index]) * m_positionQuantum;
+		}
+		++m_next;
+	}
+
+	const TrajectoryFrame & TrajectoryReader::read(std::uint64_t frame)
+	{
+		if (frame >= m_frames) { throw std::out_of_range("Crowds::TrajectoryReader: no frame " + std::to_string(frame)); }
+		auto next = std::upper_bound(m_index.begin(), m_index.end(), frame, [](std::uint64_t value, const TrajectoryChunk & entry) { return value < entry.m_firstFrame; });
+		size_t chunk = size_t(next - m_index.begin()) - 1;
+		if (chunk != m_chunk || frame + 1 < m_next) { loadChunk(chunk); }
+		while (m_next <= frame) { decodeFrame(); }
+		return m_current;
+	}
+}
@@ -1,6 +1,7 @@
 #pragma once
 #include <random>
 #include <cassert>
+#include <cstdint>
 
 namespace Math
 {	
@@ -16,7 +17,24 @@ namespace Math
 		/// Initializes a new instance of the <see cref="UniformRandom"/> class.
 		/// </summary>
 		UniformRandom() {}
-		
+
+		/// <summary>
+		/// Initializes a new instance of the <see cref="UniformRandom"/> class with the provided seed.
+		/// </summary>
+		/// <param name="seed">The seed.</param>
+		explicit UniformRandom(std::uint64_t seed)
+			: m_generator(seed)
+		{}
+
+		/// <summary>
+		/// Reseeds the generator. The generated sequence is then fully determined by the seed.
+		/// </summary>
+		/// <param name="seed">The seed.</param>
+		void seed(std::uint64_t seed) const
+		{
+			m_generator.seed(seed);
+		}
+
 		/// <summary>
 		/// Generates a random number in the interval [min,max].
 		/// </summary>
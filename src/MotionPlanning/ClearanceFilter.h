@@ -0,0 +1,103 @@
+#pragma once
+
+#include <MotionPlanning/CollisionManager.h>
+#include <Math/Quaternion.h>
+#include <vector>
+#include <utility>
+
+namespace MotionPlanning
+{
+	/// <summary>
+	/// Conservative pre-filter of collision tests. The static world is summarized by a grid storing, for each cell, a lower bound of the
+	/// distance between the points of the cell and the static objects. The mobile is bounded by a hierarchy of spheres: one sphere bounding
+	/// the whole mobile, then a set of smaller spheres bounding clusters of its triangles. A configuration is declared free when the
+	/// bounding sphere (or all the smaller spheres) lie in cells whose clearance is greater than their radius. The filter never declares free
+	/// a colliding configuration, other configurations must be tested by fcl.
+	/// </summary>
+	class ClearanceFilter
+	{
+	public:
+		/// <summary>
+		/// A sphere expressed in the local frame of the mobile.
+		/// </summary>
+		struct Sphere
+		{
+			Math::Vector3f m_center;
+			float m_radius;
+		};
+
+	private:
+		/// <summary>
+		/// The sphere bounding the whole mobile.
+		/// </summary>
+		Sphere m_bound;
+		/// <summary>
+		/// The spheres bounding clusters of triangles of the mobile.
+		/// </summary>
+		std::vector<Sphere> m_spheres;
+		/// <summary>
+		/// The corner of the grid with minimal coordinates.
+		/// </summary>
+		Math::Vector3f m_origin;
+		/// <summary>
+		/// The size of a cell.
+		/// </summary>
+		float m_cellSize;
+		/// <summary>
+		/// The number of cells along each axis.
+		/// </summary>
+		size_t m_cells[3];
+		/// <summary>
+		/// The lower bound of the clearance of each cell (x major, z minor).
+		/// </summary>
+		std::vector<float> m_clearance;
+
+		/// <summary>
+		/// Computes the sphere hierarchy of the mobile.
+		/// </summary>
+		/// <param name="triangles">The triangles of the mobile.</param>
+		/// <param name="splits">The number of clusters along each axis.</param>
+		void buildSpheres(const std::vector<std::array<Math::Vector3f, 3>> & triangles, size_t splits);
+
+		/// <summary>
+		/// Computes the clearance of the cells. Cells are processed in parallel.
+		/// </summary>
+		/// <param name="manager">The collision manager.</param>
+		void buildGrid(const CollisionManager & manager);
+
+		/// <summary>
+		/// Tests if a sphere of the mobile is certainly free.
+		/// </summary>
+		/// <param name="sphere">The sphere.</param>
+		/// <param name="translation">The translation of the mobile.</param>
+		/// <param name="orientation">The orientation of the mobile.</param>
+		/// <returns></returns>
+		bool isFree(const Sphere & sphere, const Math::Vector3f & translation, const Math::Quaternion<float> & orientation) const;
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="ClearanceFilter"/> class. The collision manager is initialized if needed.
+		/// </summary>
+		/// <param name="manager">The collision manager (static objects must not be modified while the filter is used).</param>
+		/// <param name="mobile">The mobile.</param>
+		/// <param name="intervals">The search intervals of the planner (only the three translation intervals are used).</param>
+		/// <param name="cellSize">The size of a cell of the clearance grid.</param>
+		/// <param name="splits">The number of clusters of triangles of the mobile along each axis of its bounding box.</param>
+		ClearanceFilter(CollisionManager & manager, const CollisionManager::DynamicCollisionObject & mobile, const std::vector<std::pair<float, float>> & intervals,
+			float cellSize, size_t splits = 2);
+
+		/// <summary>
+		/// Tests if the mobile placed at the provided position is certainly free. false means that the filter can not decide.
+		/// </summary>
+		/// <param name="translation">The translation of the mobile.</param>
+		/// <param name="orientation">The orientation of the mobile.</param>
+		/// <returns></returns>
+		bool isFree(const Math::Vector3f & translation, const Math::Quaternion<float> & orientation) const;
+
+		/// <summary>
+		/// Gets the spheres bounding the clusters of triangles of the mobile.
+		/// </summary>
+		/// <returns></returns>
+		const std::vector<Sphere> & getSpheres() const { return m_spheres; }
+	};
+}
@@ -3,6 +3,9 @@
 #include <MotionPlanning/converter.h>
 #include <unordered_map>
 #include <unordered_set>
+#include <array>
+#include <memory>
+#include <tbb/enumerable_thread_specific.h>
 #pragma warning(push, 0)        
 #include <fcl/fcl.h>
 #pragma warning(pop)
@@ -166,13 +169,41 @@ namespace MotionPlanning
 		fcl::DynamicAABBTreeCollisionManager<float> m_staticManager;
 		fcl::DynamicAABBTreeCollisionManager<float> m_dynamicManager;
 		bool m_isInitialized;
+		/// <summary>
+		/// The query objects of the concurrent collision tests: per thread, a copy of each tested dynamic object. A copy shares the geometry
+		/// of the object and its local bounding box, computed once when the object is registered; a query only changes its transform.
+		/// </summary>
+		mutable tbb::enumerable_thread_specific<std::unordered_map<const fcl::CollisionObject<float> *, std::unique_ptr<fcl::CollisionObject<float>>>> m_queryObjects;
 
 		static bool recordCollisionCallback(fcl::CollisionObject<float> * o1, fcl::CollisionObject<float> * o2, void * data);
 
 		static bool doCollideCallback(fcl::CollisionObject<float> * o1, fcl::CollisionObject<float> * o2, void * data);
 
+		/// <summary>
+		/// Distance callback of the broad phase: data points to the minimal distance found so far, which is written back in dist to
+		/// let the broad phase prune the farther pairs.
+		/// </summary>
 		static bool distanceCallback(fcl::CollisionObject<float> * o1, fcl::CollisionObject<float> * o2, void * data, float & dist);
 
+		/// <summary>
+		/// Data of <see cref="continuousCollisionCallback"/>: the geometry of the moving object, its motion and the result of the test.
+		/// </summary>
+		struct ContinuousCollisionData
+		{
+			const fcl::CollisionObject<float> * m_bound;
+			const fcl::CollisionGeometry<float> * m_geometry;
+			fcl::Transform3f m_start;
+			fcl::Transform3f m_end;
+			bool m_result;
+		};
+
+		static bool continuousCollisionCallback(fcl::CollisionObject<float> * o1, fcl::CollisionObject<float> * o2, void * data);
+
+		/// <summary>
+		/// Converts a translation and an orientation into a fcl transform.
+		/// </summary>
+		static fcl::Transform3f toTransform(const Math::Vector3f & translation, const Math::Quaternion<float> & orientation);
+
 	public:				
 		/// <summary>
 		/// Initializes a new instance of the <see cref="CollisionManager"/> class.
@@ -208,17 +239,66 @@ namespace MotionPlanning
 		void unregister(const StaticCollisionObject & object);
 
 		
+		/// <summary>
+		/// Builds the broad phase structures. Called automatically by <see cref="doCollide()"/> and <see cref="computeDistance"/>, must be
+		/// called before concurrent calls to <see cref="doCollide(const DynamicCollisionObject &, const Math::Vector3f &, const Math::Quaternion<float> &)"/>.
+		/// </summary>
+		void initialize();
+
 		/// <summary>
 		/// Tests if dynamic objects collide together or with static objects.
 		/// </summary>
 		/// <returns></returns>
 		bool doCollide() ;
 
+		/// <summary>
+		/// Tests if a dynamic object placed at the provided position collides with static objects. The object itself is not moved,
+		/// and this method can be called concurrently as long as static objects are not modified (see <see cref="initialize"/>).
+		/// </summary>
+		/// <param name="object">The dynamic object.</param>
+		/// <param name="translation">The translation of the object.</param>
+		/// <param name="orientation">The orientation of the object.</param>
+		/// <returns></returns>
+		bool doCollide(const DynamicCollisionObject & object, const Math::Vector3f & translation, const Math::Quaternion<float> & orientation) const;
+
+		/// <summary>
+		/// Continuous collision test: tests if a dynamic object moving from a start to an end placement collides with static objects.
+		/// The translation is linearly interpolated and the orientation rotates at constant speed around a fixed axis (i.e. the motion
+		/// of <see cref="SixDofPlannerBase::Configuration::interpolate"/>). Static objects are culled with a sphere bounding the swept volume,
+		/// the remaining ones are tested with the conservative advancement of fcl, which never misses a contact (up to the time of contact
+		/// tolerance) whatever the length of the motion. Thread safe under the same conditions as
+		/// <see cref="doCollide(const DynamicCollisionObject &, const Math::Vector3f &, const Math::Quaternion<float> &)"/>.
+		/// </summary>
+		/// <param name="object">The dynamic object.</param>
+		/// <param name="startTranslation">The start translation.</param>
+		/// <param name="startOrientation">The start orientation.</param>
+		/// <param name="endTranslation">The end translation.</param>
+		/// <param name="endOrientation">The end orientation.</param>
+		/// <returns></returns>
+		bool doCollide(const DynamicCollisionObject & object, const Math::Vector3f & startTranslation, const Math::Quaternion<float> & startOrientation,
+			const Math::Vector3f & endTranslation, const Math::Quaternion<float> & endOrientation) const;
+
 		/// <summary>
 		/// returns the minimal distance between the mobile and the environment / other mobile objects.
 		/// </summary>
 		/// <returns></returns>
 		float computeDistance() ;
 
+		/// <summary>
+		/// Returns the minimal distance between a sphere and the static objects (0 if they intersect). Thread safe under the same conditions
+		/// as <see cref="doCollide(const DynamicCollisionObject &, const Math::Vector3f &, const Math::Quaternion<float> &)"/>.
+		/// </summary>
+		/// <param name="center">The center of the sphere.</param>
+		/// <param name="radius">The radius of the sphere.</param>
+		/// <returns></returns>
+		float computeDistance(const Math::Vector3f & center, float radius) const;
+
+		/// <summary>
+		/// Gets the triangles of a collision object, expressed in the local frame of the object.
+		/// </summary>
+		/// <param name="object">The collision object.</param>
+		/// <returns></returns>
+		std::vector<std::array<Math::Vector3f, 3>> getTriangles(const CollisionObject & object) const;
+
 	};
 }
\ No newline at end of file
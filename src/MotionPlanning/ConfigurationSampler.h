@@ -0,0 +1,286 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <random>
+#include <cstdint>
+#include <cmath>
+#include <algorithm>
+#include <cassert>
+
+namespace MotionPlanning
+{
+	/// <summary>
+	/// Base class for samplers of the six dimensional unit hypercube [0;1[^6. The planners map the generated points onto
+	/// their search intervals (translation) and onto SO(3) (orientation). All samplers are deterministic: the same seed
+	/// always produces the same sequence.
+	/// </summary>
+	class ConfigurationSampler
+	{
+	public:
+		/// <summary>
+		/// A point in the unit hypercube.
+		/// </summary>
+		using Point = std::array<float, 6>;
+
+		virtual ~ConfigurationSampler() {}
+
+		/// <summary>
+		/// Generates the next point of the sequence.
+		/// </summary>
+		/// <returns></returns>
+		virtual Point next() = 0;
+
+		/// <summary>
+		/// Restarts the sequence from the provided seed.
+		/// </summary>
+		/// <param name="seed">The seed.</param>
+		virtual void seed(std::uint64_t seed) = 0;
+
+		/// <summary>
+		/// Creates a new sampler of the same kind generating an independent deterministic stream. Used to provide one sampler per thread:
+		/// the sequence generated by a stream only depends on the seed and the stream index, not on thread scheduling.
+		/// </summary>
+		/// <param name="seed">The seed.</param>
+		/// <param name="stream">The index of the stream.</param>
+		/// <returns></returns>
+		virtual std::unique_ptr<ConfigurationSampler> stream(std::uint64_t seed, std::uint64_t stream) const = 0;
+
+		/// <summary>
+		/// Mixes a seed and a stream index into a well distributed 64 bits value (splitmix64 finalizer).
+		/// </summary>
+		/// <param name="seed">The seed.</param>
+		/// <param name="stream">The stream.</param>
+		/// <returns></returns>
+		static std::uint64_t mix(std::uint64_t seed, std::uint64_t stream)
+		{
+			std::uint64_t z = seed + (stream + 1) * 0x9E3779B97F4A7C15ull;
+			z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+			z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+			return z ^ (z >> 31);
+		}
+	};
+
+	/// <summary>
+	/// Pseudo random sampler based on the mersenne twister algorithm.
+	/// </summary>
+	/// <seealso cref="ConfigurationSampler" />
+	class UniformSampler : public ConfigurationSampler
+	{
+		std::mt19937_64 m_generator;
+		std::uniform_real_distribution<float> m_distribution;
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="UniformSampler"/> class.
+		/// </summary>
+		/// <param name="seed">The seed.</param>
+		UniformSampler(std::uint64_t seed = std::mt19937_64::default_seed)
+			: m_generator(seed), m_distribution(0.0f, 1.0f)
+		{}
+
+		virtual Point next()
+		{
+			Point result;
+			for (size_t cpt = 0; cpt < result.size(); ++cpt)
+			{
+				result[cpt] = m_distribution(m_generator);
+			}
+			return result;
+		}
+
+		virtual void seed(std::uint64_t seed)
+		{
+			m_generator.seed(seed);
+			m_distribution.reset();
+		}
+
+		virtual std::unique_ptr<ConfigurationSampler> stream(std::uint64_t seed, std::uint64_t stream) const
+		{
+			return std::unique_ptr<ConfigurationSampler>(new UniformSampler(mix(seed, stream)));
+		}
+	};
+
+	/// <summary>
+	/// Base class for low discrepancy sequences. The sequence is randomized with a Cranley-Patterson rotation (a random offset modulo 1)
+	/// computed from the seed. The seed 0 provides the original sequence. Independent streams use independent rotations.
+	/// </summary>
+	/// <seealso cref="ConfigurationSampler" />
+	class LowDiscrepancySampler : public ConfigurationSampler
+	{
+	protected:
+		std::uint32_t m_index;
+		Point m_offset;
+
+		/// <summary>
+		/// Computes the point of index m_index of the sequence (without rotation).
+		/// </summary>
+		/// <returns></returns>
+		virtual Point point() const = 0;
+
+		/// <summary>
+		/// Converts a value of [0;1[ computed in double precision to float. Values just below 1 would be rounded to 1.
+		/// </summary>
+		/// <param name="value">The value.</param>
+		/// <returns>The value in [0;1[.</returns>
+		static float toUnitFloat(double value)
+		{
+			return std::min(static_cast<float>(value), std::nextafter(1.0f, 0.0f));
+		}
+
+	public:
+		LowDiscrepancySampler()
+			: m_index(0)
+		{
+			m_offset.fill(0.0f);
+		}
+
+		virtual Point next()
+		{
+			Point result = point();
+			++m_index;
+			for (size_t cpt = 0; cpt < result.size(); ++cpt)
+			{
+				result[cpt] += m_offset[cpt];
+				if (result[cpt] >= 1.0f) { result[cpt] -= 1.0f; }
+			}
+			return result;
+		}
+
+		virtual void seed(std::uint64_t seed)
+		{
+			// The first point of the sequences is always 0 and is skipped
+			m_index = 1;
+			if (seed == 0) { m_offset.fill(0.0f); return; }
+			UniformSampler random(seed);
+			m_offset = random.next();
+		}
+	};
+
+	/// <summary>
+	/// Halton sequence using the six first prime numbers as bases.
+	/// </summary>
+	/// <seealso cref="LowDiscrepancySampler" />
+	class HaltonSampler : public LowDiscrepancySampler
+	{
+		/// <summary>
+		/// The radical inverse of index in the provided base.
+		/// </summary>
+		static float radicalInverse(std::uint32_t index, std::uint32_t base)
+		{
+			double inverseBase = 1.0 / base;
+			double factor = inverseBase;
+			double result = 0.0;
+			while (index > 0)
+			{
+				result += (index % base) * factor;
+				index /= base;
+				factor *= inverseBase;
+			}
+			return toUnitFloat(result);
+		}
+
+	protected:
+		virtual Point point() const
+		{
+			static const std::uint32_t bases[6] = { 2, 3, 5, 7, 11, 13 };
+			Point result;
+			for (size_t cpt = 0; cpt < result.size(); ++cpt)
+			{
+				result[cpt] = radicalInverse(m_index, bases[cpt]);
+			}
+			return result;
+		}
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="HaltonSampler"/> class.
+		/// </summary>
+		/// <param name="seed">The seed (0 for the non randomized sequence).</param>
+		HaltonSampler(std::uint64_t seed = 0)
+		{
+			this->seed(seed);
+		}
+
+		virtual std::unique_ptr<ConfigurationSampler> stream(std::uint64_t seed, std::uint64_t stream) const
+		{
+			return std::unique_ptr<ConfigurationSampler>(new HaltonSampler(mix(seed, stream)));
+		}
+	};
+
+	/// <summary>
+	/// Sobol sequence in six dimensions (direction numbers from S. Joe and F. Y. Kuo).
+	/// </summary>
+	/// <seealso cref="LowDiscrepancySampler" />
+	class SobolSampler : public LowDiscrepancySampler
+	{
+		std::array<std::array<std::uint32_t, 32>, 6> m_directions;
+
+		/// <summary>
+		/// Computes the direction numbers.
+		/// </summary>
+		void initializeDirections()
+		{
+			// Degree, coefficients and initial direction numbers of the primitive polynomials of dimensions 2 to 6
+			static const std::uint32_t degrees[5] = { 1, 2, 3, 3, 4 };
+			static const std::uint32_t coefficients[5] = { 0, 1, 1, 2, 1 };
+			static const std::uint32_t initial[5][4] = { { 1 }, { 1, 3 }, { 1, 3, 1 }, { 1, 1, 1 }, { 1, 1, 3, 3 } };
+			// First dimension: van der Corput sequence in base 2
+			for (std::uint32_t bit = 0; bit < 32; ++bit)
+			{
+				m_directions[0][bit] = 1u << (31 - bit);
+			}
+			for (size_t dimension = 1; dimension < 6; ++dimension)
+			{
+				std::array<std::uint32_t, 32> & v = m_directions[dimension];
+				std::uint32_t s = degrees[dimension - 1];
+				std::uint32_t a = coefficients[dimension - 1];
+				for (std::uint32_t bit = 0; bit < s; ++bit)
+				{
+					v[bit] = initial[dimension - 1][bit] << (31 - bit);
+				}
+				for (std::uint32_t bit = s; bit < 32; ++bit)
+				{
+					v[bit] = v[bit - s] ^ (v[bit - s] >> s);
+					for (std::uint32_t k = 1; k < s; ++k)
+					{
+						v[bit] ^= ((a >> (s - 1 - k)) & 1u) * v[bit - k];
+					}
+				}
+			}
+		}
+
+	protected:
+		virtual Point point() const
+		{
+			Point result;
+			for (size_t dimension = 0; dimension < result.size(); ++dimension)
+			{
+				std::uint32_t value = 0;
+				std::uint32_t index = m_index;
+				for (std::uint32_t bit = 0; index != 0; ++bit, index >>= 1)
+				{
+					if (index & 1u) { value ^= m_directions[dimension][bit]; }
+				}
+				result[dimension] = toUnitFloat(value * (1.0 / 4294967296.0));
+			}
+			return result;
+		}
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="SobolSampler"/> class.
+		/// </summary>
+		/// <param name="seed">The seed (0 for the non randomized sequence).</param>
+		SobolSampler(std::uint64_t seed = 0)
+		{
+			initializeDirections();
+			this->seed(seed);
+		}
+
+		virtual std::unique_ptr<ConfigurationSampler> stream(std::uint64_t seed, std::uint64_t stream) const
+		{
+			return std::unique_ptr<ConfigurationSampler>(new SobolSampler(mix(seed, stream)));
+		}
+	};
+}
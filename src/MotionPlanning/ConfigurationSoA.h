@@ -0,0 +1,197 @@
+#pragma once
+
+#include <MotionPlanning/SixDofPlannerBase.h>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MOTION_PLANNING_USE_SSE
+#include <immintrin.h>
+#endif
+
+namespace MotionPlanning
+{
+	/// <summary>
+	/// Structure of arrays storage of configurations (translation x, y, z and quaternion w, x, y, z in separate arrays).
+	/// Distances from one configuration to all stored configurations are computed by a vectorized kernel (SSE, four
+	/// configurations at a time) using the same formula as <see cref="SixDofPlannerBase::configurationDistance"/>. The two paths may round
+	/// differently (operation order, contraction), near ties within a few ulps may be ordered differently by the two kernels.
+	/// </summary>
+	class ConfigurationSoA
+	{
+		std::vector<float> m_tx, m_ty, m_tz;
+		std::vector<float> m_qw, m_qx, m_qy, m_qz;
+
+	public:
+		/// <summary>
+		/// Returns the number of stored configurations.
+		/// </summary>
+		/// <returns></returns>
+		size_t size() const { return m_tx.size(); }
+
+		/// <summary>
+		/// Reserves memory for the provided number of configurations.
+		/// </summary>
+		/// <param name="size">The size.</param>
+		void reserve(size_t size)
+		{
+			m_tx.reserve(size); m_ty.reserve(size); m_tz.reserve(size);
+			m_qw.reserve(size); m_qx.reserve(size); m_qy.reserve(size); m_qz.reserve(size);
+		}
+
+		/// <summary>
+		/// Removes all the configurations.
+		/// </summary>
+		void clear()
+		{
+			m_tx.clear(); m_ty.clear(); m_tz.clear();
+			m_qw.clear(); m_qx.clear(); m_qy.clear(); m_qz.clear();
+		}
+
+		/// <summary>
+		/// Appends a configuration.
+		/// </summary>
+		/// <param name="configuration">The configuration.</param>
+		void push_back(const SixDofPlannerBase::Configuration & configuration)
+		{
+			m_tx.push_back(configuration.m_translation[0]);
+			m_ty.push_back(configuration.m_translation[1]);
+			m_tz.push_back(configuration.m_translation[2]);
+			m_qw.push_back(configuration.m_orientation.s());
+			m_qx.push_back(configuration.m_orientation.v()[0]);
+			m_qy.push_back(configuration.m_orientation.v()[1]);
+			m_qz.push_back(configuration.m_orientation.v()[2]);
+		}
+
+		/// <summary>
+		/// Gets the configuration at the provided index.
+		/// </summary>
+		/// <param name="index">The index.</param>
+		/// <returns></returns>
+		SixDofPlannerBase::Configuration operator[] (size_t index) const
+		{
+			return SixDofPlannerBase::Configuration(Math::makeVector(m_tx[index], m_ty[index], m_tz[index]),
+				Math::Quaternion<float>(m_qw[index], Math::makeVector(m_qx[index], m_qy[index], m_qz[index])));
+		}
+
+		/// <summary>
+		/// Computes the distance between a configuration and the configuration at the provided index.
+		/// </summary>
+		/// <param name="index">The index.</param>
+		/// <param name="query">The configuration.</param>
+		/// <returns></returns>
+		float distance(size_t index, const SixDofPlannerBase::Configuration & query) const
+		{
+			float dx = m_tx[index] - query.m_translation[0];
+			float dy = m_ty[index] - query.m_translation[1];
+			float dz = m_tz[index] - query.m_translation[2];
+			float dot = m_qw[index] * query.m_orientation.s() + m_qx[index] * query.m_orientation.v()[0]
+				+ m_qy[index] * query.m_orientation.v()[1] + m_qz[index] * query.m_orientation.v()[2];
+			dot = std::min(std::fabs(dot), 1.0f);
+			return std::sqrt(dx*dx + dy*dy + dz*dz) + SixDofPlannerBase::fastAcos(dot) * SixDofPlannerBase::inverseHalfPi();
+		}
+
+		/// <summary>
+		/// Computes the distances between a configuration and all stored configurations.
+		/// </summary>
+		/// <param name="query">The configuration.</param>
+		/// <param name="result">The distances (must be able to store size() values).</param>
+		void distances(const SixDofPlannerBase::Configuration & query, float * result) const
+		{
+			size_t index = 0;
+#ifdef MOTION_PLANNING_USE_SSE
+			const __m128 tx = _mm_set1_ps(query.m_translation[0]);
+			const __m128 ty = _mm_set1_ps(query.m_translation[1]);
+			const __m128 tz = _mm_set1_ps(query.m_translation[2]);
+			const __m128 qw = _mm_set1_ps(query.m_orientation.s());
+			const __m128 qx = _mm_set1_ps(query.m_orientation.v()[0]);
+			const __m128 qy = _mm_set1_ps(query.m_orientation.v()[1]);
+			const __m128 qz = _mm_set1_ps(query.m_orientation.v()[2]);
+			const __m128 one = _mm_set1_ps(1.0f);
+			const __m128 absMask = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+			const __m128 a0 = _mm_set1_ps(SixDofPlannerBase::fastAcosCoefficients()[0]);
+			const __m128 a1 = _mm_set1_ps(SixDofPlannerBase::fastAcosCoefficients()[1]);
+			const __m128 a2 = _mm_set1_ps(SixDofPlannerBase::fastAcosCoefficients()[2]);
+			const __m128 a3 = _mm_set1_ps(SixDofPlannerBase::fastAcosCoefficients()[3]);
+			const __m128 rotationScale = _mm_set1_ps(SixDofPlannerBase::inverseHalfPi());
+			for (size_t end = size() & ~size_t(3); index < end; index += 4)
+			{
+				__m128 dx = _mm_sub_ps(_mm_loadu_ps(&m_tx[index]), tx);
+				__m128 dy = _mm_sub_ps(_mm_loadu_ps(&m_ty[index]), ty);
+				__m128 dz = _mm_sub_ps(_mm_loadu_ps(&m_tz[index]), tz);
+				__m128 translation = _mm_sqrt_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz)));
+				__m128 dot = _mm_add_ps(_mm_add_ps(_mm_add_ps(_mm_mul_ps(_mm_loadu_ps(&m_qw[index]), qw), _mm_mul_ps(_mm_loadu_ps(&m_qx[index]), qx)),
+					_mm_mul_ps(_mm_loadu_ps(&m_qy[index]), qy)), _mm_mul_ps(_mm_loadu_ps(&m_qz[index]), qz));
+				dot = _mm_min_ps(_mm_and_ps(dot, absMask), one);
+				// fastAcos: sqrt(1-x) * (a0 + x * (a1 + x * (a2 + x * a3)))
+				__m128 polynomial = _mm_add_ps(a0, _mm_mul_ps(dot, _mm_add_ps(a1, _mm_mul_ps(dot, _mm_add_ps(a2, _mm_mul_ps(dot, a3))))));
+				__m128 angle = _mm_mul_ps(_mm_sqrt_ps(_mm_sub_ps(one, dot)), polynomial);
+				_mm_storeu_ps(result + index, _mm_add_ps(translation, _mm_mul_ps(angle, rotationScale)));
+			}
+#endif
+			for (; index < size(); ++index)
+			{
+				result[index] = distance(index, query);
+			}
+		}
+
+		/// <summary>
+		/// Linear scan for the nearest configuration.
+		/// </summary>
+		/// <param name="query">The configuration.</param>
+		/// <param name="nearestDistance">The distance to the nearest configuration.</param>
+		/// <returns>The index of the nearest configuration, size() if the storage is empty. If no distance is comparable (NaN, e.g. for a
+		/// degenerate quaternion), the first configuration is returned.</returns>
+		size_t nearest(const SixDofPlannerBase::Configuration & query, float & nearestDistance) const
+		{
+			thread_local std::vector<float> buffer;
+			buffer.resize(size());
+			distances(query, buffer.data());
+			size_t result = size();
+			nearestDistance = std::numeric_limits<float>::max();
+			for (size_t cpt = 0; cpt < buffer.size(); ++cpt)
+			{
+				if (buffer[cpt] < nearestDistance) { nearestDistance = buffer[cpt]; result = cpt; }
+			}
+			// Callers index their nodes with the result: a non empty storage always returns a valid index
+			if (result == size() && !buffer.empty())
+			{
+				result = 0;
+				nearestDistance = buffer[0];
+			}
+			return result;
+		}
+	};
+
+	/// <summary>
+	/// Bucket mirror of a <see cref="VPTree"/> of nodes (providing a getConfiguration method): the configurations of the nodes of a bucket,
+	/// stored when the nodes are inserted.
+	/// </summary>
+	template <typename Node>
+	class NodeConfigurationBucket : public ConfigurationSoA
+	{
+	public:
+		void push_back(const Node * node) { ConfigurationSoA::push_back(node->getConfiguration()); }
+	};
+
+	/// <summary>
+	/// Distance between a node (providing a getConfiguration method) and a configuration. The functor also computes the distances between a
+	/// configuration and the nodes of a bucket of <see cref="VPTree"/> with the vectorized kernel of <see cref="ConfigurationSoA"/>, directly
+	/// on the <see cref="NodeConfigurationBucket"/> mirror of the bucket.
+	/// </summary>
+	template <typename Node>
+	struct NodeConfigurationDistance
+	{
+		float operator() (const Node * node, const SixDofPlannerBase::Configuration & configuration) const
+		{
+			return SixDofPlannerBase::configurationDistance(node->getConfiguration(), configuration);
+		}
+
+		void operator() (const NodeConfigurationBucket<Node> & bucket, const SixDofPlannerBase::Configuration & configuration, float * result) const
+		{
+			bucket.distances(configuration, result);
+		}
+	};
+}
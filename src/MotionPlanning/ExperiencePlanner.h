@@ -0,0 +1,278 @@
+#pragma once
+
+#include <MotionPlanning/SixDofPlannerBase.h>
+#include <MotionPlanning/VPTree.h>
+#include <stdext/arena.h>
+#include <stdext/chrono/timer.h>
+#include <vector>
+#include <memory>
+#include <functional>
+#include <algorithm>
+
+namespace MotionPlanning
+{
+	/// <summary>
+	/// Experience based planner (retrieve and repair). Solved queries are stored in a path library indexed by a VPTree over their
+	/// (start, target) endpoints. A new query retrieves the path whose endpoints are the closest ones, connects the query endpoints to it
+	/// and repairs the invalid segments with a local planner. If no path is close enough or if the repair fails, the query is solved from
+	/// scratch by a planner and the solution is added to the library.
+	/// </summary>
+	/// <seealso cref="SixDofPlannerBase" />
+	class ExperiencePlanner : public SixDofPlannerBase
+	{
+	public:
+		/// <summary>
+		/// Creates the planners used to repair retrieved paths and to solve the queries from scratch.
+		/// </summary>
+		using PlannerFactory = std::function<std::unique_ptr<SixDofPlannerBase>()>;
+
+		/// <summary>
+		/// Statistics of the path library, accumulated over all queries.
+		/// </summary>
+		struct LibraryStatistics
+		{
+			/// <summary>
+			/// The number of queries.
+			/// </summary>
+			size_t m_queries = 0;
+			/// <summary>
+			/// The number of queries solved from a retrieved path.
+			/// </summary>
+			size_t m_hits = 0;
+			/// <summary>
+			/// The number of retrieved paths that could not be repaired.
+			/// </summary>
+			size_t m_repairFailures = 0;
+			/// <summary>
+			/// The number of segments repaired by the local planner.
+			/// </summary>
+			size_t m_repairedSegments = 0;
+			/// <summary>
+			/// The number of queries solved from scratch.
+			/// </summary>
+			size_t m_plannings = 0;
+			/// <summary>
+			/// The time spent in queries solved from a retrieved path (seconds).
+			/// </summary>
+			double m_retrievalTime = 0.0;
+			/// <summary>
+			/// The time spent in queries solved from scratch, including failed repairs (seconds).
+			/// </summary>
+			double m_planningTime = 0.0;
+
+			/// <summary>
+			/// The ratio of queries solved from a retrieved path.
+			/// </summary>
+			/// <returns></returns>
+			float hitRate() const { return m_queries == 0 ? 0.0f : float(m_hits) / float(m_queries); }
+
+			/// <summary>
+			/// Estimates the time saved by the library: the time the hits would have needed at the average planning time, minus their actual time.
+			/// </summary>
+			/// <returns></returns>
+			double savedTime() const { return m_plannings == 0 ? 0.0 : m_hits * (m_planningTime / m_plannings) - m_retrievalTime; }
+		};
+
+	private:
+		/// <summary>
+		/// A path of the library. Each path is stored twice, once per direction.
+		/// </summary>
+		struct Experience
+		{
+			std::shared_ptr<const std::vector<Configuration>> m_path;
+			bool m_reversed;
+
+			const Configuration & start() const { return m_reversed ? m_path->back() : m_path->front(); }
+			const Configuration & target() const { return m_reversed ? m_path->front() : m_path->back(); }
+		};
+
+		/// <summary>
+		/// The endpoints of a query (start, target).
+		/// </summary>
+		using Endpoints = std::pair<Configuration, Configuration>;
+
+		/// <summary>
+		/// Distance between the endpoints of two queries (maximum of the distances between starts and between targets).
+		/// </summary>
+		static float endpointsDistance(const Configuration & start1, const Configuration & target1, const Configuration & start2, const Configuration & target2)
+		{
+			return std::max(configurationDistance(start1, start2), configurationDistance(target1, target2));
+		}
+
+		/// <summary>
+		/// The stored paths
+		/// </summary>
+		stdext::arena<Experience> m_experiences;
+		/// <summary>
+		/// The index of the stored paths
+		/// </summary>
+		VPTree<Experience*, Endpoints> m_library;
+		/// <summary>
+		/// The factory of local and global planners
+		/// </summary>
+		PlannerFactory m_factory;
+		/// <summary>
+		/// The maximum endpoints distance of a retrieved path
+		/// </summary>
+		float m_retrievalRadius;
+		/// <summary>
+		/// The sample limit of the local planner repairing a segment
+		/// </summary>
+		size_t m_repairSampleLimit;
+		/// <summary>
+		/// The statistics of the library
+		/// </summary>
+		LibraryStatistics m_libraryStatistics;
+
+		/// <summary>
+		/// Creates a planner with the provided sample limit.
+		/// </summary>
+		std::unique_ptr<SixDofPlannerBase> createPlanner(size_t sampleLimit) const
+		{
+			std::unique_ptr<SixDofPlannerBase> result = m_factory();
+			result->setSampleLimit(sampleLimit);
+			return result;
+		}
+
+		/// <summary>
+		/// Planners do not agree on the direction of their results: ensures that the path begins at the provided start.
+		/// </summary>
+		static void orient(std::vector<Configuration> & path, const Configuration & start)
+		{
+			if (!path.empty() && configurationDistance(path.back(), start) < configurationDistance(path.front(), start))
+			{
+				std::reverse(path.begin(), path.end());
+			}
+		}
+
+		/// <summary>
+		/// Adds a path in the library.
+		/// </summary>
+		void store(const std::vector<Configuration> & path)
+		{
+			std::shared_ptr<const std::vector<Configuration>> shared = std::make_shared<const std::vector<Configuration>>(path);
+			m_library.add(m_experiences.create(Experience{ shared, false }));
+			m_library.add(m_experiences.create(Experience{ shared, true }));
+		}
+
+		/// <summary>
+		/// Connects the query to a stored path and repairs the colliding segments with a local planner.
+		/// </summary>
+		/// <returns>true if the repaired path is valid, false otherwise.</returns>
+		bool repair(const Experience & experience, const Configuration & start, const Configuration & target, float radius, float dq, std::vector<Configuration> & result)
+		{
+			std::vector<Configuration> waypoints;
+			waypoints.reserve(experience.m_path->size() + 2);
+			waypoints.push_back(start);
+			if (experience.m_reversed) { waypoints.insert(waypoints.end(), experience.m_path->rbegin(), experience.m_path->rend()); }
+			else { waypoints.insert(waypoints.end(), experience.m_path->begin(), experience.m_path->end()); }
+			waypoints.push_back(target);
+			// Waypoints invalidated by the environment are skipped, the resulting segments are repaired
+			waypoints.erase(std::remove_if(waypoints.begin() + 1, waypoints.end() - 1, [this](const Configuration & c) { return doCollide(c); }), waypoints.end() - 1);
+			result.clear();
+			result.push_back(start);
+			for (size_t cpt = 1; cpt < waypoints.size(); ++cpt)
+			{
+				if (!doCollide(waypoints[cpt - 1], waypoints[cpt], dq))
+				{
+					result.push_back(waypoints[cpt]);
+					continue;
+				}
+				++m_libraryStatistics.m_repairedSegments;
+				std::vector<Configuration> segment;
+				std::unique_ptr<SixDofPlannerBase> planner = createPlanner(m_repairSampleLimit);
+				bool repaired = planner->plan(waypoints[cpt - 1], waypoints[cpt], radius, dq, segment);
+				m_statistics += planner->getStatistics();
+				if (!repaired || segment.empty()) { return false; }
+				orient(segment, waypoints[cpt - 1]);
+				result.insert(result.end(), segment.begin() + 1, segment.end());
+			}
+			return true;
+		}
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="ExperiencePlanner"/> class.
+		/// </summary>
+		/// <param name="collisionManager">The collision manager.</param>
+		/// <param name="object">The mobile.</param>
+		/// <param name="factory">The factory of the planners used to repair paths and to solve queries from scratch.</param>
+		/// <param name="retrievalRadius">The maximum distance between the endpoints of a query and of a retrieved path.</param>
+		/// <param name="repairSampleLimit">The sample limit of the local planner repairing a segment.</param>
+		ExperiencePlanner(MotionPlanning::CollisionManager* collisionManager, MotionPlanning::CollisionManager::DynamicCollisionObject object, PlannerFactory factory,
+			float retrievalRadius = 0.5f, size_t repairSampleLimit = 1000)
+			: SixDofPlannerBase(collisionManager, object),
+			m_library([](Experience * e1, Experience * e2) { return endpointsDistance(e1->start(), e1->target(), e2->start(), e2->target()); },
+				[](Experience * e, const Endpoints & query) { return endpointsDistance(e->start(), e->target(), query.first, query.second); }),
+			m_factory(factory), m_retrievalRadius(retrievalRadius), m_repairSampleLimit(repairSampleLimit)
+		{}
+
+		/// <summary>
+		/// Gets the statistics of the path library.
+		/// </summary>
+		/// <returns></returns>
+		const LibraryStatistics & getLibraryStatistics() const { return m_libraryStatistics; }
+
+		/// <summary>
+		/// Returns the number of paths in the library.
+		/// </summary>
+		/// <returns></returns>
+		size_t size() const { return m_experiences.size() / 2; }
+
+		/// <summary>
+		/// Removes all the paths of the library.
+		/// </summary>
+		void clear()
+		{
+			m_library.clear();
+			m_experiences.clear();
+		}
+
+		/// <summary>
+		/// Solves a query with the library, or from scratch if no stored path can be repaired.
+		/// </summary>
+		/// <param name="start">The start configuration.</param>
+		/// <param name="target">The target configuration.</param>
+		/// <param name="radius">The extension radius of the planners.</param>
+		/// <param name="dq">The resolution of local paths.</param>
+		/// <param name="result">The path from start to target.</param>
+		/// <returns></returns>
+		virtual bool plan(const Configuration & start, const Configuration & target, float radius, float dq, std::vector<Configuration> & result)
+		{
+			++m_libraryStatistics.m_queries;
+			if (doCollide(start) || doCollide(target)) { return false; }
+			stdext::chrono::timer<> timer;
+			timer.start();
+			if (!m_experiences.empty())
+			{
+				Endpoints query(start, target);
+				Experience * nearest = m_library.nearestNeighbour(query);
+				if (endpointsDistance(nearest->start(), nearest->target(), start, target) <= m_retrievalRadius)
+				{
+					if (repair(*nearest, start, target, radius, dq, result))
+					{
+						timer.stop();
+						++m_libraryStatistics.m_hits;
+						++m_statistics.m_libraryHits;
+						m_libraryStatistics.m_retrievalTime += timer.elapsed_time().count();
+						return true;
+					}
+					++m_libraryStatistics.m_repairFailures;
+				}
+			}
+			result.clear();
+			std::unique_ptr<SixDofPlannerBase> planner = createPlanner(m_sampleLimit);
+			bool success = planner->plan(start, target, radius, dq, result);
+			m_statistics += planner->getStatistics();
+			if (success)
+			{
+				orient(result, start);
+				store(result);
+			}
+			timer.stop();
+			++m_libraryStatistics.m_plannings;
+			m_libraryStatistics.m_planningTime += timer.elapsed_time().count();
+			return success;
+		}
+	};
+}
@@ -8,8 +8,12 @@
 #include <Math/Quaternion.h>
 #include <MotionPlanning/CollisionManager.h>
 #include <Math/Constant.h>
+#include <stdext/chrono/timer.h>
 #include <vector>
 #include <queue>
+#include <unordered_map>
+#include <functional>
+#include <tbb/parallel_for.h>
 
 namespace MotionPlanning
 {
@@ -33,13 +37,15 @@ namespace MotionPlanning
 		void 	grow(size_t nbNodes, size_t k, float dq, size_t maxSamples = std::numeric_limits< size_t >::max()) {
 			size_t current_nbNodes = 0;
 			size_t current_sample = 0;
-			while (current_nbNodes < nbNodes && current_sample < maxSamples) {
+			while (current_nbNodes < nbNodes && current_sample < maxSamples && !isSampleLimitReached()) {
 				//On cree une nouvelle config
-				Configuration rnd_Config = randomConfiguration();
+				Configuration rnd_Config;
+				if (!randomConfiguration(rnd_Config)) { break; }
 				current_sample++;
 				//Si elle est sur le free space on l'ajoute au graphe
 				if (!doCollide(rnd_Config)) {
 					MotionPlanning::SixDofConfigurationGraph::Node * newNode = graphe.add(rnd_Config);
+					++m_statistics.m_nodes;
 					current_nbNodes++;
 					//On la relie a ses k voisin si c'est possible 
 					for (MotionPlanning::SixDofConfigurationGraph::Node * c : graphe.kNearestNeighbours(rnd_Config, k)) {
@@ -74,7 +80,185 @@ namespace MotionPlanning
 			}
 			return aEtoile(nodeStart, nodeTarget, dq, k, result);
 		}
+
+		/// <summary>
+		/// A planning query.
+		/// </summary>
+		struct Query
+		{
+			Configuration m_start;
+			Configuration m_target;
+		};
+
+		/// <summary>
+		/// The result of a query of a batch.
+		/// </summary>
+		struct QueryResult
+		{
+			/// <summary>
+			/// True if a path has been found.
+			/// </summary>
+			bool m_success = false;
+			/// <summary>
+			/// The path from start to target.
+			/// </summary>
+			std::vector<Configuration> m_path;
+			/// <summary>
+			/// The time needed to answer the query (in seconds).
+			/// </summary>
+			double m_time = 0.0;
+			/// <summary>
+			/// The statistics of the query.
+			/// </summary>
+			Statistics m_statistics;
+		};
+
+		/// <summary>
+		/// Answers a batch of queries in parallel over the current roadmap. Start and target configurations are connected to the roadmap
+		/// through temporary overlay nodes: the roadmap is neither modified nor grown, it must be built with <see cref="grow"/> beforehand.
+		/// </summary>
+		/// <param name="queries">The queries.</param>
+		/// <param name="dq">The maximum distance between two samples along a local path.</param>
+		/// <param name="k">The number of roadmap nodes start and target are connected to.</param>
+		/// <returns>The result of each query.</returns>
+		std::vector<QueryResult> plan(const std::vector<Query> & queries, float dq, size_t k = 5) const
+		{
+			getCollisionManager()->initialize();
+			// The disjoint set compresses paths during lookups, a snapshot of the connected components is shared between threads instead
+			std::unordered_map<const Node*, SixDofConfigurationGraph::ConnectedComponentnId> components;
+			for (Node * node : graphe.getNodes())
+			{
+				components[node] = graphe.getConnectedComponent(node);
+			}
+			std::vector<QueryResult> results(queries.size());
+			tbb::parallel_for(tbb::blocked_range<size_t>(0, queries.size()), [&](const tbb::blocked_range<size_t> & range)
+			{
+				for (size_t cpt = range.begin(); cpt != range.end(); ++cpt)
+				{
+					results[cpt] = answer(queries[cpt], dq, k, components);
+				}
+			});
+			return results;
+		}
+
 	private:
+		using Node = SixDofConfigurationGraph::Node;
+
+		/// <summary>
+		/// Answers a query without modifying the roadmap (thread safe).
+		/// </summary>
+		QueryResult answer(const Query & query, float dq, size_t k, const std::unordered_map<const Node*, SixDofConfigurationGraph::ConnectedComponentnId> & components) const
+		{
+			QueryResult result;
+			stdext::chrono::timer<> timer;
+			timer.start();
+			if (!doCollide(query.m_start, result.m_statistics) && !doCollide(query.m_target, result.m_statistics))
+			{
+				if (!doCollide(query.m_start, query.m_target, dq, result.m_statistics))
+				{
+					result.m_path = { query.m_start, query.m_target };
+					result.m_success = true;
+				}
+				else
+				{
+					std::vector<Node*> targetNeighbours = overlay(query.m_target, dq, k, nullptr, result.m_statistics);
+					std::unordered_map<SixDofConfigurationGraph::ConnectedComponentnId, bool> targetComponents;
+					for (Node * node : targetNeighbours) { targetComponents[components.find(node)->second] = true; }
+					// Only roadmap nodes in a connected component reachable from the target are connected to the start
+					std::vector<Node*> startNeighbours = overlay(query.m_start, dq, k, [&](Node * node) { return targetComponents.count(components.find(node)->second) > 0; }, result.m_statistics);
+					result.m_success = search(query, startNeighbours, targetNeighbours, result.m_path);
+				}
+			}
+			timer.stop();
+			result.m_time = timer.elapsed_time().count();
+			return result;
+		}
+
+		/// <summary>
+		/// Computes the roadmap nodes an overlay node located at the provided configuration would be connected to.
+		/// </summary>
+		/// <param name="configuration">The configuration of the overlay node.</param>
+		/// <param name="dq">The maximum distance between two samples along a local path.</param>
+		/// <param name="k">The number of neighbours.</param>
+		/// <param name="filter">Filters the candidate neighbours before the (costly) local path validation, can be nullptr.</param>
+		/// <param name="statistics">The statistics of the query.</param>
+		/// <returns></returns>
+		std::vector<Node*> overlay(const Configuration & configuration, float dq, size_t k, const std::function<bool(Node*)> & filter, Statistics & statistics) const
+		{
+			std::vector<Node*> result;
+			for (Node * node : graphe.kNearestNeighbours(configuration, k))
+			{
+				if ((!filter || filter(node)) && !doCollide(configuration, node->getConfiguration(), dq, statistics))
+				{
+					result.push_back(node);
+				}
+			}
+			return result;
+		}
+
+		/// <summary>
+		/// A* search between the overlay nodes of the start and of the target configurations.
+		/// </summary>
+		/// <param name="query">The query.</param>
+		/// <param name="startNeighbours">The roadmap nodes connected to the start configuration.</param>
+		/// <param name="targetNeighbours">The roadmap nodes connected to the target configuration.</param>
+		/// <param name="path">The resulting path.</param>
+		/// <returns> true if a path has been found. </returns>
+		bool search(const Query & query, const std::vector<Node*> & startNeighbours, const std::vector<Node*> & targetNeighbours, std::vector<Configuration> & path) const
+		{
+			using Entry = std::pair<float, Node*>;
+			std::unordered_map<Node*, float> cost;
+			std::unordered_map<Node*, Node*> predecessor;
+			std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open;
+			auto heuristic = [&query](Node * node) { return configurationDistance(node->getConfiguration(), query.m_target); };
+			for (Node * node : startNeighbours)
+			{
+				cost[node] = configurationDistance(query.m_start, node->getConfiguration());
+				predecessor[node] = nullptr;
+				open.push(Entry(cost[node] + heuristic(node), node));
+			}
+			// The heuristic is the distance to the target i.e. the cost of the overlay edge from a target neighbour to the target
+			std::unordered_map<Node*, float> exits;
+			for (Node * node : targetNeighbours) { exits[node] = heuristic(node); }
+			Node * best = nullptr;
+			float bestCost = std::numeric_limits<float>::max();
+			while (!open.empty() && open.top().first < bestCost)
+			{
+				Entry current = open.top();
+				open.pop();
+				Node * node = current.second;
+				float nodeCost = cost[node];
+				if (current.first > nodeCost + heuristic(node)) { continue; } // Outdated entry
+				auto exit = exits.find(node);
+				if (exit != exits.end() && nodeCost + exit->second < bestCost)
+				{
+					bestCost = nodeCost + exit->second;
+					best = node;
+				}
+				for (const Node::Transition & transition : node->getOutgoingTransitions())
+				{
+					float newCost = nodeCost + transition.m_distance;
+					auto it = cost.find(transition.m_extremity);
+					if (it == cost.end() || newCost < it->second)
+					{
+						cost[transition.m_extremity] = newCost;
+						predecessor[transition.m_extremity] = node;
+						open.push(Entry(newCost + heuristic(transition.m_extremity), transition.m_extremity));
+					}
+				}
+			}
+			if (best == nullptr) { return false; }
+			path.clear();
+			path.push_back(query.m_target);
+			for (Node * node = best; node != nullptr; node = predecessor[node])
+			{
+				path.push_back(node->getConfiguration());
+			}
+			path.push_back(query.m_start);
+			std::reverse(path.begin(), path.end());
+			return true;
+		}
+
 		bool aEtoile(MotionPlanning::SixDofConfigurationGraph::Node *  start, MotionPlanning::SixDofConfigurationGraph::Node * target, float dq, size_t k, std::vector< Configuration > &result) {
 			while (true) {
 				//Si target et start sont dans la mme composante connexe alors une solution existe, sinon non, on refait grossir le graphe
@@ -117,6 +301,9 @@ namespace MotionPlanning
 					std::cout << "ERREUR :pas de chemin trouver " << std::endl;
 					return false;
 				}
+				else if (isSampleLimitReached()) {
+					return false;
+				}
 				else {
 					std::cout << "le start et le target ne font pas partie de la meme composante connexe --> on refais grossir le graphe" << std::endl;
 					std::cout << "k =" << k << std::endl;
@@ -31,12 +31,14 @@ namespace MotionPlanning
 
 		bool plan(const Configuration & start, const Configuration & target, float radius, float dq, std::vector<Configuration> & result) {
 			arbre.createNode(start);
+			++m_statistics.m_nodes;
 			bool linked = false;
 			int cpt = 0;
 			int maxIter = 1000000;
-			while (!linked && cpt<maxIter) {
+			while (!linked && cpt<maxIter && !isSampleLimitReached()) {
 				//On crer Qrand
-				Configuration rnd_Config = randomConfiguration();
+				Configuration rnd_Config;
+				if (!randomConfiguration(rnd_Config)) { break; }
 				MotionPlanning::SixDofConfigurationTree::Node * nearest = arbre.nearest(rnd_Config);
 				if (nearest == nullptr) {
 					std::cout << "NULLPTR";
@@ -54,6 +56,7 @@ namespace MotionPlanning
 				if (!doCollide(qNew)) {
 					if (!doCollide(qNew, nearest->getConfiguration(), dq)) {
 						MotionPlanning::SixDofConfigurationTree::Node * node_qNew =arbre.createNode(qNew, nearest);
+						++m_statistics.m_nodes;
 						//std::cout << "AJOUT" << std::endl;
 						//On regarde si l'on peut relier notre nouvelle config et notre target
 						if (true || configurationDistance(qNew, target)<radius) {
@@ -61,6 +64,7 @@ namespace MotionPlanning
 							if (!doCollide(qNew, target, dq)) {
 								std::cout << "Trouve" << std::endl;
 								MotionPlanning::SixDofConfigurationTree::Node * node_final = arbre.createNode(target, node_qNew);
+								++m_statistics.m_nodes;
 								creationVecteurResult(node_final,result);
 								linked = true;
 							}
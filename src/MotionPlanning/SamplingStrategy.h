@@ -0,0 +1,157 @@
+#pragma once
+
+#include <MotionPlanning/SixDofPlannerBase.h>
+#include <random>
+#include <cstdint>
+#include <algorithm>
+
+namespace MotionPlanning
+{
+	/// <summary>
+	/// Base class for sampling strategies. A strategy draws candidate configurations from the sampler of a planner and uses
+	/// the collision manager of the planner to accept or reject them (e.g. to favour configurations near obstacles).
+	/// Each call to <see cref="sample"/> counts as one candidate in the statistics of the planner (<see cref="SixDofPlannerBase::Statistics::m_candidates"/>).
+	/// </summary>
+	class SamplingStrategy
+	{
+	protected:
+		/// <summary>
+		/// Random generator used for gaussian perturbations.
+		/// </summary>
+		std::mt19937_64 m_generator;
+		/// <summary>
+		/// The standard deviation of gaussian perturbations (in configuration distance units).
+		/// </summary>
+		float m_sigma;
+
+		/// <summary>
+		/// Returns a configuration in the neighbourhood of the provided one. The translation is perturbed by a gaussian noise and clamped to the search
+		/// intervals, the orientation is rotated around a random axis by a gaussian angle.
+		/// </summary>
+		/// <param name="planner">The planner.</param>
+		/// <param name="configuration">The configuration.</param>
+		/// <returns></returns>
+		SixDofPlannerBase::Configuration gaussianNeighbour(const SixDofPlannerBase & planner, const SixDofPlannerBase::Configuration & configuration)
+		{
+			std::normal_distribution<float> normal(0.0f, m_sigma);
+			const std::vector<std::pair<float, float>> & intervals = planner.getIntervals();
+			Math::Vector3f translation = configuration.m_translation;
+			for (size_t cpt = 0; cpt < 3; ++cpt)
+			{
+				translation[cpt] = std::clamp(translation[cpt] + normal(m_generator), intervals[cpt].first, intervals[cpt].second);
+			}
+			std::normal_distribution<float> axisDistribution(0.0f, 1.0f);
+			Math::Vector3f axis = Math::makeVector(axisDistribution(m_generator), axisDistribution(m_generator), axisDistribution(m_generator));
+			if (axis.norm() < 1e-6f) { return SixDofPlannerBase::Configuration(translation, configuration.m_orientation); }
+			// configurationDistance maps a rotation of angle pi onto a unit distance
+			float angle = normal(m_generator) * float(Math::pi);
+			return SixDofPlannerBase::Configuration(translation, Math::Quaternion<float>(axis.normalized(), angle) * configuration.m_orientation);
+		}
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="SamplingStrategy"/> class.
+		/// </summary>
+		/// <param name="sigma">The standard deviation of gaussian perturbations.</param>
+		SamplingStrategy(float sigma = 0.1f)
+			: m_sigma(sigma)
+		{}
+
+		virtual ~SamplingStrategy() {}
+
+		/// <summary>
+		/// Seeds the random generator of the strategy.
+		/// </summary>
+		/// <param name="seed">The seed.</param>
+		void seed(std::uint64_t seed) { m_generator.seed(seed); }
+
+		/// <summary>
+		/// Tries to generate a configuration.
+		/// </summary>
+		/// <param name="planner">The planner providing candidate configurations and collision tests.</param>
+		/// <param name="result">The generated configuration (the last candidate if rejected).</param>
+		/// <returns> true if the configuration is accepted, false if the candidate has been rejected. </returns>
+		virtual bool sample(const SixDofPlannerBase & planner, SixDofPlannerBase::Configuration & result) = 0;
+	};
+
+	/// <summary>
+	/// Gaussian sampling (Boor, Overmars, van der Stappen). A pair of configurations at a gaussian distance is generated, the free one is kept
+	/// if the other one collides. Samples concentrate near the surface of obstacles.
+	/// </summary>
+	/// <seealso cref="SamplingStrategy" />
+	class GaussianStrategy : public SamplingStrategy
+	{
+	public:
+		GaussianStrategy(float sigma = 0.1f)
+			: SamplingStrategy(sigma)
+		{}
+
+		virtual bool sample(const SixDofPlannerBase & planner, SixDofPlannerBase::Configuration & result)
+		{
+			SixDofPlannerBase::Configuration first = planner.uniformConfiguration();
+			SixDofPlannerBase::Configuration second = gaussianNeighbour(planner, first);
+			bool firstCollides = planner.doCollide(first);
+			bool secondCollides = planner.doCollide(second);
+			result = firstCollides ? second : first;
+			return firstCollides != secondCollides;
+		}
+	};
+
+	/// <summary>
+	/// Bridge test (Hsu et al.). Two colliding configurations at a gaussian distance are generated, their midpoint is kept if it is free.
+	/// Samples concentrate in narrow passages.
+	/// </summary>
+	/// <seealso cref="SamplingStrategy" />
+	class BridgeTestStrategy : public SamplingStrategy
+	{
+	public:
+		BridgeTestStrategy(float sigma = 0.1f)
+			: SamplingStrategy(sigma)
+		{}
+
+		virtual bool sample(const SixDofPlannerBase & planner, SixDofPlannerBase::Configuration & result)
+		{
+			SixDofPlannerBase::Configuration first = planner.uniformConfiguration();
+			result = first;
+			if (!planner.doCollide(first)) { return false; }
+			SixDofPlannerBase::Configuration second = gaussianNeighbour(planner, first);
+			if (!planner.doCollide(second)) { return false; }
+			result = first.interpolate(second, 0.5f);
+			return !planner.doCollide(result);
+		}
+	};
+
+	/// <summary>
+	/// Obstacle based sampling (Amato et al., OBPRM). From a colliding configuration, the strategy walks towards a random configuration
+	/// and keeps the first free configuration found, i.e. a configuration close to the surface of the obstacle.
+	/// </summary>
+	/// <seealso cref="SamplingStrategy" />
+	class ObstacleBasedStrategy : public SamplingStrategy
+	{
+		/// <summary>
+		/// The distance between two configurations tested along the walk.
+		/// </summary>
+		float m_step;
+
+	public:
+		ObstacleBasedStrategy(float step = 0.02f)
+			: m_step(step)
+		{}
+
+		virtual bool sample(const SixDofPlannerBase & planner, SixDofPlannerBase::Configuration & result)
+		{
+			SixDofPlannerBase::Configuration inside = planner.uniformConfiguration();
+			result = inside;
+			if (!planner.doCollide(inside)) { return false; }
+			SixDofPlannerBase::Configuration direction = planner.uniformConfiguration();
+			float distance = SixDofPlannerBase::configurationDistance(inside, direction);
+			size_t steps = std::max<size_t>(size_t(distance / m_step), 1);
+			for (size_t cpt = 1; cpt <= steps; ++cpt)
+			{
+				result = inside.interpolate(direction, float(cpt) / float(steps));
+				if (!planner.doCollide(result)) { return true; }
+			}
+			return false;
+		}
+	};
+}
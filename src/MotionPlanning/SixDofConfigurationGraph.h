@@ -2,8 +2,10 @@
 
 #include <MotionPlanning/SixDofPlannerBase.h>
 #include <MotionPlanning/VPTree.h>
+#include <MotionPlanning/ConfigurationSoA.h>
 #include <unordered_set>
 #include <stdext/disjoint_set.h>
+#include <stdext/arena.h>
 
 namespace MotionPlanning
 {
@@ -26,6 +28,7 @@ namespace MotionPlanning
 		class Node
 		{
 			friend class SixDofConfigurationGraph;
+			template <typename, size_t> friend class stdext::arena;
 
 		public:
 			struct Transition
@@ -90,7 +93,12 @@ namespace MotionPlanning
 		/// <summary>
 		/// The tree used for neighbouhood search.
 		/// </summary>
-		VPTree<Node*, SixDofPlannerBase::Configuration> * m_tree;
+		VPTree<Node*, SixDofPlannerBase::Configuration, NodeConfigurationBucket<Node>> * m_tree;
+
+		/// <summary>
+		/// The arena owning the nodes of the graph
+		/// </summary>
+		stdext::arena<Node> m_arena;
 
 		/// <summary>
 		/// The nodes contained in the graph
@@ -113,19 +121,12 @@ namespace MotionPlanning
 			: m_nbEdges(0)
 		{
 			auto distanceNode = [](Node * n1, Node * n2) { return SixDofPlannerBase::configurationDistance(n1->getConfiguration(), n2->getConfiguration()); };
-			auto distanceNodeConfiguration = [](Node * n1, const SixDofPlannerBase::Configuration & configuration)
-			{
-				return SixDofPlannerBase::configurationDistance(n1->getConfiguration(), configuration);
-			};
-			m_tree = new VPTree<Node*, SixDofPlannerBase::Configuration>(distanceNode, distanceNodeConfiguration);
+			m_tree = new VPTree<Node*, SixDofPlannerBase::Configuration, NodeConfigurationBucket<Node>>(distanceNode, NodeConfigurationDistance<Node>());
 		}
 
 		~SixDofConfigurationGraph()
 		{
-			for (auto it = m_nodes.begin(), end = m_nodes.end(); it != end; ++it)
-			{
-				delete (*it);
-			}
+			delete m_tree;
 		}
 
 		SixDofConfigurationGraph(const SixDofConfigurationGraph &) = delete;
@@ -138,7 +139,7 @@ namespace MotionPlanning
 		/// <returns></returns>
 		Node * add(const SixDofPlannerBase::Configuration & configuration, ConfigurationSpaceQualifier space = ConfigurationSpaceQualifier::cFree)
 		{
-			Node * node = new Node(configuration, space);
+			Node * node = m_arena.create(configuration, space);
 			m_nodes.push_back(node);
 			m_tree->add(node);
 			m_connectedComponents.insert(node);
@@ -158,6 +159,12 @@ namespace MotionPlanning
 			++m_nbEdges;
 		}
 
+		/// <summary>
+		/// Gets the nodes of the graph.
+		/// </summary>
+		/// <returns></returns>
+		const std::vector<Node*> & getNodes() const { return m_nodes; }
+
 		/// <summary>
 		/// Returns the number of nodes
 		/// </summary>
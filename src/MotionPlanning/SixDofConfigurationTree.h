@@ -2,6 +2,8 @@
 
 #include <MotionPlanning/SixDofPlannerBase.h>
 #include <MotionPlanning/VPTree.h>
+#include <MotionPlanning/ConfigurationSoA.h>
+#include <stdext/arena.h>
 #include <unordered_set>
 
 namespace MotionPlanning
@@ -19,6 +21,7 @@ namespace MotionPlanning
 		{
 		private:
 			friend class SixDofConfigurationTree;
+			template <typename, size_t> friend class stdext::arena;
 			
 			SixDofPlannerBase::Configuration m_configuration;
 			std::vector<Node *> m_sons;
@@ -43,27 +46,27 @@ namespace MotionPlanning
 			}
 
 			/// <summary>
-			/// Reverts the branch such as the node with the nullptr parameter value becomes the new root of the tree/
+			/// Reverts the branch from the root to this node such as this node becomes the new root of the tree.
+			/// The branch is processed iteratively (no recursion on deep trees).
 			/// </summary>
-			/// <param name="newFather">The new father.</param>
-			void markAsRoot(Node * newFather = nullptr)
+			void markAsRoot()
 			{
-				if (m_father != nullptr)
+				std::vector<Node*> branch;
+				for (Node * node = this; node != nullptr; node = node->m_father)
 				{
-					m_father->markAsRoot(this);
+					branch.push_back(node);
 				}
-				if (newFather != nullptr)
+				for (size_t cpt = branch.size() - 1; cpt > 0; --cpt)
 				{
-					newFather->addSon(this);
-					auto it = std::find(m_sons.begin(), m_sons.end(), newFather);
-					assert(it != m_sons.end());
-					(*it) = m_sons.back();
-					m_sons.pop_back();
-				}
-				else
-				{
-					m_father = nullptr;
+					Node * father = branch[cpt];
+					Node * son = branch[cpt - 1];
+					auto it = std::find(father->m_sons.begin(), father->m_sons.end(), son);
+					assert(it != father->m_sons.end());
+					(*it) = father->m_sons.back();
+					father->m_sons.pop_back();
+					son->addSon(father);
 				}
+				m_father = nullptr;
 			}
 
 		public:
@@ -87,21 +90,14 @@ namespace MotionPlanning
 			{
 				return m_configuration;
 			}
-
-			/// <summary>
-			/// Finalizes an instance of the <see cref="Node"/> class.
-			/// </summary>
-			~Node()
-			{
-				for (auto it = m_sons.begin(), end = m_sons.end(); it != end; ++it)
-				{
-					delete (*it);
-				}
-			}
 		};
 
 	private:
-		VPTree<Node*, SixDofPlannerBase::Configuration> * m_tree;
+		/// <summary>
+		/// The arenas owning the nodes. The first one is used to create new nodes, the others come from merged trees.
+		/// </summary>
+		std::vector<stdext::arena<Node>> m_arenas;
+		VPTree<Node*, SixDofPlannerBase::Configuration, NodeConfigurationBucket<Node>> * m_tree;
 		Node * m_root;
 		std::unordered_set<Node*> m_leaves;
 		
@@ -120,16 +116,17 @@ namespace MotionPlanning
 		}
 
 		/// <summary>
-		/// Collects all the nodes belonging to the tree.
+		/// Collects all the nodes belonging to the sub tree rooted at node (iterative traversal).
 		/// </summary>
 		/// <param name="node">The node.</param>
 		/// <param name="result">The result.</param>
 		void collectNodes(Node * node, std::vector<Node*> & result)
 		{
+			size_t first = result.size();
 			result.push_back(node);
-			for(auto it=node->getSons().begin(), end=node->getSons().end() ; it!=end ; ++it)
+			for (size_t cpt = first; cpt < result.size(); ++cpt)
 			{
-				collectNodes(*it, result);
+				result.insert(result.end(), result[cpt]->getSons().begin(), result[cpt]->getSons().end());
 			}
 		}
 		
@@ -144,9 +141,10 @@ namespace MotionPlanning
 			//, 
 			m_root(nullptr)
 		{
-			m_tree = new VPTree<Node*, SixDofPlannerBase::Configuration>
+			m_arenas.emplace_back();
+			m_tree = new VPTree<Node*, SixDofPlannerBase::Configuration, NodeConfigurationBucket<Node>>
 				([this](Node * node, Node * node2) -> float { return SixDofPlannerBase::configurationDistance(node->getConfiguration(), node2->getConfiguration()); },
-				 [this](Node * node, const SixDofPlannerBase::Configuration & config) -> float {return SixDofPlannerBase::configurationDistance(node->getConfiguration(), config); });
+				 NodeConfigurationDistance<Node>());
 
 		}
 
@@ -155,7 +153,6 @@ namespace MotionPlanning
 		/// </summary>
 		~SixDofConfigurationTree()
 		{
-			if (m_root != nullptr) { delete m_root; }
 			if (m_tree != nullptr) { delete m_tree; }
 		}
 
@@ -164,7 +161,7 @@ namespace MotionPlanning
 		/// </summary>
 		/// <param name="other">The other tree.</param>
 		SixDofConfigurationTree(SixDofConfigurationTree && other)
-			: m_tree(other.m_tree), m_root(other.m_root), m_leaves(std::move(other.m_leaves))
+			: m_arenas(std::move(other.m_arenas)), m_tree(other.m_tree), m_root(other.m_root), m_leaves(std::move(other.m_leaves))
 		{
 			other.m_root = nullptr;
 			other.m_tree = nullptr;
@@ -177,6 +174,7 @@ namespace MotionPlanning
 		/// <returns></returns>
 		SixDofConfigurationTree & operator = (SixDofConfigurationTree && other)
 		{
+			std::swap(m_arenas, other.m_arenas);
 			std::swap(m_tree, other.m_tree);
 			std::swap(m_root, other.m_root);
 			std::swap(m_leaves, other.m_leaves);
@@ -196,7 +194,7 @@ namespace MotionPlanning
 		{
 			assert(father != nullptr || m_root == nullptr);
 			assert(father==nullptr || doesBelong(father));
-			Node * created = new Node(configuration);
+			Node * created = m_arenas.front().create(configuration);
 			if(father==nullptr)
 			{
 				m_root = created;
@@ -265,8 +263,18 @@ namespace MotionPlanning
 			{
 				m_tree->add(*it);
 			}
+			// The nodes of the other tree now belong to this tree, so do their arenas
+			for (auto it = toAttach.m_arenas.begin(), end = toAttach.m_arenas.end(); it != end; ++it)
+			{
+				m_arenas.push_back(std::move(*it));
+			}
+			toAttach.m_arenas.clear();
+			toAttach.m_arenas.emplace_back();
+			m_leaves.erase(attachmentTarget);
+			m_leaves.insert(toAttach.m_leaves.begin(), toAttach.m_leaves.end());
 			toAttach.m_root = nullptr;
 			toAttach.m_tree->clear();
+			toAttach.m_leaves.clear();
 		}
 
 		/// <summary>
@@ -282,8 +290,10 @@ namespace MotionPlanning
 		/// </summary>
 		void clear()
 		{
-			if (m_root) { delete m_root; }
+			m_arenas.resize(1);
+			m_arenas.front().clear();
 			m_root = nullptr;
+			m_leaves.clear();
 			m_tree->clear();
 		}
 
@@ -1,14 +1,21 @@
 #pragma once
 #include <Math/Vectorf.h>
-#include <Math/UniformRandom.h>
 #include <Math/Interpolation.h>
 #include <Math/Quaternion.h>
 #include <MotionPlanning/CollisionManager.h>
+#include <MotionPlanning/ConfigurationSampler.h>
 #include <Math/Constant.h>
 #include <vector>
+#include <cmath>
+#include <limits>
+#include <cstdint>
+#include <memory>
 
 namespace MotionPlanning
 {
+	class SamplingStrategy;
+	class ClearanceFilter;
+
 	/// <summary>
 	/// Base class for six dof planners
 	/// </summary>
@@ -110,11 +117,119 @@ namespace MotionPlanning
 			return std::make_pair(-1.0f, 1.0f);
 		}
 
+		/// <summary>
+		/// The way local paths between two configurations are validated.
+		/// </summary>
+		enum class EdgeValidation
+		{
+			/// <summary>
+			/// The path is sampled at resolution dq, each sample is tested against the environment.
+			/// </summary>
+			cDiscrete,
+			/// <summary>
+			/// The whole path is tested with one continuous collision query (see <see cref="CollisionManager::doCollide"/>), dq is ignored.
+			/// </summary>
+			cContinuous
+		};
+
+		/// <summary>
+		/// Statistics collected by a planner. Used for benchmarking purpose.
+		/// </summary>
+		struct Statistics
+		{
+			/// <summary>
+			/// The number of random configurations returned to the planner (accepted candidates).
+			/// </summary>
+			size_t m_samples = 0;
+			/// <summary>
+			/// The number of candidates submitted to the sampling strategy (accepted or rejected). A candidate is one call to the strategy,
+			/// even if the strategy draws several configurations from the sampler (e.g. obstacle based sampling draws two).
+			/// </summary>
+			size_t m_candidates = 0;
+			/// <summary>
+			/// The number of configurations tested against the environment.
+			/// </summary>
+			size_t m_collisionChecks = 0;
+			/// <summary>
+			/// The number of local paths tested with a continuous collision query.
+			/// </summary>
+			size_t m_continuousChecks = 0;
+			/// <summary>
+			/// The number of configuration tests answered by the clearance filter without calling fcl.
+			/// </summary>
+			size_t m_filteredChecks = 0;
+			/// <summary>
+			/// The number of nodes created by the planner (tree or roadmap nodes).
+			/// </summary>
+			size_t m_nodes = 0;
+			/// <summary>
+			/// The number of queries solved from a path library (see <see cref="ExperiencePlanner"/>).
+			/// </summary>
+			size_t m_libraryHits = 0;
+
+			/// <summary>
+			/// Accumulates the statistics of another planner (e.g. a planner used internally).
+			/// </summary>
+			/// <param name="other">The other statistics.</param>
+			/// <returns></returns>
+			Statistics & operator+= (const Statistics & other)
+			{
+				m_samples += other.m_samples;
+				m_candidates += other.m_candidates;
+				m_collisionChecks += other.m_collisionChecks;
+				m_continuousChecks += other.m_continuousChecks;
+				m_filteredChecks += other.m_filteredChecks;
+				m_nodes += other.m_nodes;
+				m_libraryHits += other.m_libraryHits;
+				return (*this);
+			}
+
+			/// <summary>
+			/// The ratio of candidate configurations accepted by the sampling strategy.
+			/// </summary>
+			/// <returns></returns>
+			float acceptanceRate() const { return m_candidates == 0 ? 1.0f : float(m_samples) / float(m_candidates); }
+
+			/// <summary>
+			/// The ratio of configuration tests answered by the clearance filter.
+			/// </summary>
+			/// <returns></returns>
+			float filterHitRate() const { return m_collisionChecks == 0 ? 0.0f : float(m_filteredChecks) / float(m_collisionChecks); }
+		};
+
 	protected:
 		/// <summary>
-		/// A uniform random generator
+		/// Gets the collision manager.
 		/// </summary>
-		Math::UniformRandom m_uniformRandom;
+		/// <returns></returns>
+		MotionPlanning::CollisionManager * getCollisionManager() const { return m_collisionManager; }
+
+		/// <summary>
+		/// The sampler providing the random configurations
+		/// </summary>
+		std::unique_ptr<ConfigurationSampler> m_sampler;
+		/// <summary>
+		/// The sampling strategy (nullptr for uniform sampling)
+		/// </summary>
+		std::unique_ptr<SamplingStrategy> m_strategy;
+		/// <summary>
+		/// The conservative pre-filter of collision tests (nullptr if disabled)
+		/// </summary>
+		std::shared_ptr<const ClearanceFilter> m_clearanceFilter;
+		/// <summary>
+		/// The statistics of the planner
+		/// </summary>
+		mutable Statistics m_statistics;
+		/// <summary>
+		/// The maximum number of random configurations a planner is allowed to generate.
+		/// </summary>
+		size_t m_sampleLimit;
+
+		/// <summary>
+		/// Returns true if the planner submitted as many candidates as allowed by the sample limit.
+		/// </summary>
+		/// <returns></returns>
+		bool isSampleLimitReached() const { return m_statistics.m_candidates >= m_sampleLimit; }
 
 	private:
 		/// <summary>
@@ -122,6 +237,14 @@ namespace MotionPlanning
 		/// </summary>
 		std::vector<std::pair<float, float>> m_intervals;
 		/// <summary>
+		/// True if the angle intervals cover all orientations, orientations are then sampled uniformly on SO(3).
+		/// </summary>
+		bool m_uniformOrientation;
+		/// <summary>
+		/// The way local paths are validated
+		/// </summary>
+		EdgeValidation m_edgeValidation;
+		/// <summary>
 		/// The collision manager
 		/// </summary>
 		MotionPlanning::CollisionManager * m_collisionManager;
@@ -151,10 +274,117 @@ namespace MotionPlanning
 		SixDofPlannerBase(MotionPlanning::CollisionManager* collisionManager, MotionPlanning::CollisionManager::DynamicCollisionObject object, const std::vector<std::pair<float, float>>& intervals);
 
 		/// <summary>
-		/// Generates a random configuration.
+		/// Finalizes an instance of the <see cref="SixDofPlannerBase"/> class.
+		/// </summary>
+		virtual ~SixDofPlannerBase();
+
+		/// <summary>
+		/// Seeds the random generator used to sample configurations. Two planners seeded with the same value generate the same samples.
+		/// </summary>
+		/// <param name="seed">The seed.</param>
+		void seed(std::uint64_t seed);
+
+		/// <summary>
+		/// Sets the sampler used to generate random configurations (<see cref="UniformSampler"/> by default).
+		/// </summary>
+		/// <param name="sampler">The sampler.</param>
+		void setSampler(std::unique_ptr<ConfigurationSampler> sampler)
+		{
+			assert(sampler != nullptr);
+			m_sampler = std::move(sampler);
+		}
+
+		/// <summary>
+		/// Gets the sampler used to generate random configurations.
 		/// </summary>
 		/// <returns></returns>
-		Configuration randomConfiguration() const;
+		ConfigurationSampler & getSampler() const { return *m_sampler; }
+
+		/// <summary>
+		/// Sets the sampling strategy used by <see cref="randomConfiguration"/>. nullptr restores uniform sampling.
+		/// </summary>
+		/// <param name="strategy">The strategy.</param>
+		void setSamplingStrategy(std::unique_ptr<SamplingStrategy> strategy);
+
+		/// <summary>
+		/// Sets the clearance filter answering the collision tests of configurations that are certainly free before calling fcl (nullptr disables
+		/// the filter). The filter must have been built for the collision manager and the mobile of the planner, it can be shared between planners.
+		/// </summary>
+		/// <param name="filter">The filter.</param>
+		void setClearanceFilter(std::shared_ptr<const ClearanceFilter> filter) { m_clearanceFilter = std::move(filter); }
+
+		/// <summary>
+		/// Sets the way local paths are validated by <see cref="doCollide(const Configuration &, const Configuration &, float)"/> (discrete by default).
+		/// </summary>
+		/// <param name="validation">The validation mode.</param>
+		void setEdgeValidation(EdgeValidation validation) { m_edgeValidation = validation; }
+
+		/// <summary>
+		/// Gets the way local paths are validated.
+		/// </summary>
+		/// <returns></returns>
+		EdgeValidation getEdgeValidation() const { return m_edgeValidation; }
+
+		/// <summary>
+		/// Gets the search intervals (x, y, z, angle X, angle Y, angle Z).
+		/// </summary>
+		/// <returns></returns>
+		const std::vector<std::pair<float, float>> & getIntervals() const { return m_intervals; }
+
+		/// <summary>
+		/// Sets the maximum number of candidates (see Statistics::m_candidates) the planner is allowed to draw before giving up.
+		/// </summary>
+		/// <param name="limit">The limit.</param>
+		void setSampleLimit(size_t limit) { m_sampleLimit = limit; }
+
+		/// <summary>
+		/// Gets the maximum number of candidate configurations the planner is allowed to draw.
+		/// </summary>
+		/// <returns></returns>
+		size_t getSampleLimit() const { return m_sampleLimit; }
+
+		/// <summary>
+		/// Gets the statistics collected since the creation of the planner or the last call to <see cref="resetStatistics"/>.
+		/// </summary>
+		/// <returns></returns>
+		const Statistics & getStatistics() const { return m_statistics; }
+
+		/// <summary>
+		/// Resets the statistics.
+		/// </summary>
+		void resetStatistics() { m_statistics = Statistics(); }
+
+		/// <summary>
+		/// Generates a random configuration with the sampling strategy of the planner.
+		/// </summary>
+		/// <param name="result">The generated configuration.</param>
+		/// <returns>False if the sample limit has been reached before the strategy accepted a candidate, result is then not valid and
+		/// the planner should stop.</returns>
+		bool randomConfiguration(Configuration & result) const;
+
+		/// <summary>
+		/// Draws a candidate configuration from the sampler. The translation is sampled in the search intervals. If the angle intervals cover all
+		/// orientations, the orientation is uniformly sampled on SO(3), otherwise Euler angles are sampled in the search intervals.
+		/// </summary>
+		/// <returns></returns>
+		Configuration uniformConfiguration() const;
+
+		/// <summary>
+		/// Maps a point of the unit hypercube onto a configuration (see <see cref="uniformConfiguration"/>).
+		/// </summary>
+		/// <param name="point">The point.</param>
+		/// <returns></returns>
+		Configuration toConfiguration(const ConfigurationSampler::Point & point) const;
+
+		/// <summary>
+		/// Maps three values in [0;1[ onto a unit quaternion. Uniformly distributed values provide uniformly distributed orientations (K. Shoemake,
+		/// Uniform random rotations, Graphics Gems III).
+		/// </summary>
+		/// <param name="u1">The first value.</param>
+		/// <param name="u2">The second value.</param>
+		/// <param name="u3">The third value.</param>
+		/// <returns></returns>
+		static Math::Quaternion<float> uniformOrientation(float u1, float u2, float u3);
 
 		/// <summary>
 		/// Computes the minimum distance between the mobile and the obstacles.
@@ -171,14 +401,34 @@ namespace MotionPlanning
 		bool doCollide(const Configuration & configuration) const;
 
 		/// <summary>
-		/// Tests if the interpolation between two configurations collides with the environment.
+		/// Tests if the interpolation between two configurations collides with the environment. Depending on <see cref="getEdgeValidation"/>,
+		/// the path is either sampled at resolution dq or tested with a single continuous collision query.
 		/// </summary>
 		/// <param name="start">The start configuration.</param>
 		/// <param name="end">The target configuration.</param>
-		/// <param name="dq">The maximum distance between two samples along the path.</param>
+		/// <param name="dq">The maximum distance between two samples along the path (discrete validation).</param>
 		/// <returns></returns>
 		bool doCollide(const Configuration & start, const Configuration & end, float dq) const;
 
+		/// <summary>
+		/// Thread safe version of <see cref="doCollide(const Configuration &)"/>: the mobile is not moved and the provided statistics are
+		/// updated instead of the statistics of the planner. <see cref="CollisionManager::initialize"/> must have been called.
+		/// </summary>
+		/// <param name="configuration">The configuration.</param>
+		/// <param name="statistics">The statistics of the caller.</param>
+		/// <returns></returns>
+		bool doCollide(const Configuration & configuration, Statistics & statistics) const;
+
+		/// <summary>
+		/// Thread safe version of <see cref="doCollide(const Configuration &, const Configuration &, float)"/>.
+		/// </summary>
+		/// <param name="start">The start configuration.</param>
+		/// <param name="end">The target configuration.</param>
+		/// <param name="dq">The maximum distance between two samples along the path (discrete validation).</param>
+		/// <param name="statistics">The statistics of the caller.</param>
+		/// <returns></returns>
+		bool doCollide(const Configuration & start, const Configuration & end, float dq, Statistics & statistics) const;
+
 		/// <summary>
 		/// Optimizes the specified path.
 		/// </summary>
@@ -186,6 +436,35 @@ namespace MotionPlanning
 		/// <param name="dq">The maximum distance between to samples along the path.</param>
 		void optimize(::std::vector<Configuration> & toOptimize, float dq) const;
 
+		/// <summary>
+		/// Coefficients of the polynomial approximation of acos used by <see cref="fastAcos"/>.
+		/// </summary>
+		/// <returns></returns>
+		static const float * fastAcosCoefficients()
+		{
+			static const float coefficients[4] = { 1.5707288f, -0.2121144f, 0.0742610f, -0.0187293f };
+			return coefficients;
+		}
+
+		/// <summary>
+		/// Approximation of acos on [0;1] (Abramowitz and Stegun 4.4.45, absolute error lesser than 7e-5). The approximation is strictly
+		/// decreasing, but distances computed with it may be ordered differently from the exact ones when they differ by less than the
+		/// error of the approximation (about 4.5e-5 once scaled by 2/pi).
+		/// </summary>
+		/// <param name="x">The value in [0;1].</param>
+		/// <returns></returns>
+		static float fastAcos(float x)
+		{
+			const float * a = fastAcosCoefficients();
+			return std::sqrt(1.0f - x) * (a[0] + x * (a[1] + x * (a[2] + x * a[3])));
+		}
+
+		/// <summary>
+		/// 2/pi, the factor mapping a rotation angle onto the rotation part of the configuration distance.
+		/// </summary>
+		/// <returns></returns>
+		static float inverseHalfPi() { return float(1.0 / Math::piDiv2); }
+
 		/// <summary>
 		/// Distance between two configurations
 		/// </summary>
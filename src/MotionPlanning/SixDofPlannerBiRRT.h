@@ -3,6 +3,8 @@
 #include <vector>
 #include <MotionPlanning/SixDofPlannerBase.h>
 #include <MotionPlanning/VPTree.h>
+#include <MotionPlanning/ConfigurationSoA.h>
+#include <stdext/arena.h>
 
 namespace MotionPlanning
 {
@@ -73,10 +75,14 @@ namespace MotionPlanning
 			//}
 		};
 
+		/// <summary>
+		/// The arena owning the nodes of both trees during a planning episode.
+		/// </summary>
+		stdext::arena<Node> m_arena;
 		::std::vector<Node *> m_startNodes;
 		::std::vector<Node *> m_targetNodes;
-		VPTree<Node *, Configuration> m_startTree;
-		VPTree<Node *, Configuration> m_targetTree;
+		VPTree<Node *, Configuration, NodeConfigurationBucket<Node>> m_startTree;
+		VPTree<Node *, Configuration, NodeConfigurationBucket<Node>> m_targetTree;
 		size_t m_findNearestCount;
 
 		float distance(Node * node, Node * node2) const
@@ -109,15 +115,16 @@ namespace MotionPlanning
 		}
 
 	protected:
-		Node * createNode(::std::vector<Node *> & nodePool, VPTree<Node*, Configuration> & tree, const Configuration & configuration, float radius)
+		Node * createNode(::std::vector<Node *> & nodePool, VPTree<Node *, Configuration, NodeConfigurationBucket<Node>> & tree, const Configuration & configuration, float radius)
 		{
-			Node * tmp = new Node(configuration, radius);
+			Node * tmp = m_arena.create(configuration, radius);
 			nodePool.push_back(tmp);
+			++m_statistics.m_nodes;
 			tree.add(tmp);
 			return tmp;
 		}
 
-		Node * findNearest(const VPTree<Node *, Configuration> & tree, const Configuration & configuration)
+		Node * findNearest(const VPTree<Node *, Configuration, NodeConfigurationBucket<Node>> & tree, const Configuration & configuration)
 		{
 			++m_findNearestCount;
 			return tree.nearestNeighbour(configuration);
@@ -134,39 +141,34 @@ namespace MotionPlanning
 
 		void cleanup()
 		{
-			for (auto it = m_startNodes.begin(), end = m_startNodes.end(); it != end; ++it)
-			{
-				delete (*it);
-			}
 			m_startNodes.erase(m_startNodes.begin(), m_startNodes.end());
-			for (auto it = m_targetNodes.begin(), end = m_targetNodes.end(); it != end; ++it)
-			{
-				delete (*it);
-			}
 			m_targetNodes.erase(m_targetNodes.begin(), m_targetNodes.end());
+			m_arena.clear();
+			m_startTree.clear();
+			m_targetTree.clear();
 		}
 
 	public:
-		SixDofPlannerBiRRT(MotionPlanning::CollisionManager * collisionManager, MotionPlanning::CollisionManager::DynamicCollisionObject object, float maxDistance,
+		SixDofPlannerBiRRT(MotionPlanning::CollisionManager * collisionManager, MotionPlanning::CollisionManager::DynamicCollisionObject object,
 			const std::initializer_list<std::pair<float, float>> & intervals = { defaultPositionInterval(), defaultPositionInterval(), defaultPositionInterval(), defaultAngleInterval(), defaultAngleInterval(),defaultAngleInterval() })
-			: SixDofPlannerBase(collisionManager, object, maxDistance, intervals),
+			: SixDofPlannerBase(collisionManager, object, intervals),
 			m_startTree([this](Node * node, Node * node2) -> float { return distance(node, node2); },
-				[this](Node * node, const Configuration & config) -> float {return distance(node, config); }),
+				NodeConfigurationDistance<Node>()),
 			m_targetTree([this](Node * node, Node * node2) -> float { return distance(node, node2); },
-				[this](Node * node, const Configuration & config) -> float {return distance(node, config); }),
+				NodeConfigurationDistance<Node>()),
 			m_findNearestCount(0)
 		{}
 
-		SixDofPlannerBiRRT(MotionPlanning::CollisionManager * collisionManager, MotionPlanning::CollisionManager::DynamicCollisionObject object, float maxDistance, const std::vector<std::pair<float, float>> & intervals)
-			: SixDofPlannerBase(collisionManager, object, maxDistance, intervals),
+		SixDofPlannerBiRRT(MotionPlanning::CollisionManager * collisionManager, MotionPlanning::CollisionManager::DynamicCollisionObject object, const std::vector<std::pair<float, float>> & intervals)
+			: SixDofPlannerBase(collisionManager, object, intervals),
 			m_startTree([this](Node * node, Node * node2) -> float { return distance(node, node2); },
-				[this](Node * node, const Configuration & config) -> float {return distance(node, config); }),
+				NodeConfigurationDistance<Node>()),
 			m_targetTree([this](Node * node, Node * node2) -> float { return distance(node, node2); },
-				[this](Node * node, const Configuration & config) -> float {return distance(node, config); }),
+				NodeConfigurationDistance<Node>()),
 			m_findNearestCount(0)
 		{}
 
-		Node * tryConnect(std::vector<Node *> & nodes, VPTree<Node *, Configuration> & tree, const Configuration & random, float radius, float dq)
+		Node * tryConnect(std::vector<Node *> & nodes, VPTree<Node *, Configuration, NodeConfigurationBucket<Node>> & tree, const Configuration & random, float radius, float dq)
 		{
 			Node * nearest = findNearest(tree, random);
 			float distance = configurationDistance(nearest->getConfiguration(), random);
@@ -213,7 +215,7 @@ namespace MotionPlanning
 
 			size_t count = 0;
 
-			while (true)
+			while (!isSampleLimitReached())
 			{
 				++count;
 				if (count % 1000 == 0) 
@@ -223,8 +225,8 @@ namespace MotionPlanning
 				}
 
 				// We computed the tested configuration
-				Configuration random1 = randomConfiguration();
-				Configuration random2 = randomConfiguration();
+				Configuration random1, random2;
+				if (!randomConfiguration(random1) || !randomConfiguration(random2)) { break; }
 
 				Node * startConnected = tryConnect(m_startNodes, m_startTree, random1, radius, dq);
 				Node * targetConnected = tryConnect(m_targetNodes, m_targetTree, random2, radius, dq);
@@ -255,6 +257,7 @@ namespace MotionPlanning
 				}
 			}
 
+			cleanup();
 			return false;
 		}
 
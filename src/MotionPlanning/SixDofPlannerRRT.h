@@ -2,6 +2,8 @@
 
 #include <vector>
 #include <MotionPlanning/SixDofPlannerBase.h>
+#include <MotionPlanning/ConfigurationSoA.h>
+#include <stdext/arena.h>
 
 namespace MotionPlanning
 {
@@ -29,31 +31,31 @@ namespace MotionPlanning
 			}
 		};
 
+		/// <summary>
+		/// The arena owning the nodes during a planning episode.
+		/// </summary>
+		stdext::arena<Node> m_arena;
 		::std::vector<Node *> m_nodes;
+		/// <summary>
+		/// The configurations of the nodes (same order as m_nodes), used for vectorized nearest neighbour search.
+		/// </summary>
+		ConfigurationSoA m_configurations;
 
 	protected:
 		Node * createNode(const Configuration & configuration, float radius)
 		{
-			Node * tmp = new Node(configuration, radius);
+			Node * tmp = m_arena.create(configuration, radius);
 			m_nodes.push_back(tmp);
+			m_configurations.push_back(configuration);
+			++m_statistics.m_nodes;
 			return tmp;
 		}
 
 		Node * findNearest(const Configuration & configuration)
 		{
 			assert(m_nodes.size() > 0);
-			Node * nearest = m_nodes[0];
-			float distance = configurationDistance(nearest->m_configuration, configuration);
-			for (auto it = m_nodes.begin(), end = m_nodes.end(); it != end; ++it)
-			{
-				float tmpDist = configurationDistance((*it)->m_configuration, configuration);
-				if (tmpDist < distance)
-				{
-					distance = tmpDist;
-					nearest = (*it);
-				}
-			}
-			return nearest;
+			float distance;
+			return m_nodes[m_configurations.nearest(configuration, distance)];
 		}
 
 		Configuration limitDistance(const Configuration & source, Configuration target, float maxDistance)
@@ -67,11 +69,9 @@ namespace MotionPlanning
 
 		void cleanup()
 		{
-			for (auto it = m_nodes.begin(), end = m_nodes.end(); it != end; ++it)
-			{
-				delete (*it);
-			}
 			m_nodes.erase(m_nodes.begin(), m_nodes.end());
+			m_arena.clear();
+			m_configurations.clear();
 		}
 
 	public:
@@ -96,7 +96,8 @@ namespace MotionPlanning
 				if (count % 1000 == 0) { std::cout << "RRT size: " << m_nodes.size() << ", Trials: " << count << std::endl; }
 
 				// We computed the tested configuration
-				Configuration random = randomConfiguration();
+				Configuration random;
+				if (!randomConfiguration(random)) { break; }
 				Node * nearest = findNearest(random);
 				nearest->m_connexionTrials++;
 
@@ -2,6 +2,9 @@
 #include <algorithm>
 #include <limits>
 #include <cassert>
+#include <vector>
+#include <type_traits>
+#include <functional>
 #include <stdext/kmap.h>
 
 static size_t s_vpTreeDistanceCount = 0;
@@ -9,9 +12,21 @@ static size_t s_vpTreeDistanceCount = 0;
 namespace MotionPlanning
 {
 	/// <summary>
-	/// Vantage point tree for nearest neighbor queries
+	/// Default bucket mirror of <see cref="VPTree"/>: no additional storage.
 	/// </summary>
-	template <typename Data, typename SearchData=Data>
+	struct NoBucketMirror
+	{
+		template <typename Data>
+		void push_back(const Data &) {}
+
+		void clear() {}
+	};
+
+	/// <summary>
+	/// Vantage point tree for nearest neighbor queries. The elements of each leaf bucket can be mirrored in a BucketMirror (providing
+	/// push_back(Data) and clear()), e.g. a structure of arrays used by a vectorized distance function, see <see cref="Node::bucketDistances"/>.
+	/// </summary>
+	template <typename Data, typename SearchData=Data, typename BucketMirror = NoBucketMirror>
 	class VPTree
 	{
 		/// <summary>
@@ -35,6 +50,10 @@ namespace MotionPlanning
 			/// </summary>
 			::std::vector<Data> m_data;
 			/// <summary>
+			/// The mirror of m_data
+			/// </summary>
+			BucketMirror m_mirror;
+			/// <summary>
 			/// The actual radius of the node (covers all sub nodes)
 			/// </summary>
 			float m_radius;
@@ -51,6 +70,30 @@ namespace MotionPlanning
 			/// </summary>
 			Node * m_right;
 
+			/// <summary>
+			/// Computes the distances between value and the elements of the bucket. If the distance function provides a batch
+			/// overload distance(const BucketMirror &amp;, const SearchData &amp;, float *), it is used to compute all distances at once on the
+			/// mirror of the bucket.
+			/// </summary>
+			/// <param name="value">The value.</param>
+			/// <param name="distance">The distance function distance(Data, SearchData).</param>
+			/// <param name="result">The distances (at least bucketSize() values).</param>
+			template <typename DistanceFunction>
+			void bucketDistances(const SearchData & value, const DistanceFunction & distance, float * result) const
+			{
+				if constexpr (std::is_invocable<const DistanceFunction &, const BucketMirror &, const SearchData &, float *>::value)
+				{
+					if (!m_data.empty()) { distance(m_mirror, value, result); }
+				}
+				else
+				{
+					for (size_t cpt = 0; cpt < m_data.size(); ++cpt)
+					{
+						result[cpt] = distance(m_data[cpt], value);
+					}
+				}
+			}
+
 		public:
 			/// <summary>
 			/// Initializes a new instance of the <see cref="VPTree"/> class.
@@ -109,6 +152,7 @@ namespace MotionPlanning
 				else
 				{
 					m_data.push_back(value);
+					m_mirror.push_back(value);
 					if (m_data.size() == bucketSize())
 					{
 						size_t middleIndex = bucketSize() / 2 - 1;
@@ -130,6 +174,7 @@ namespace MotionPlanning
 							}
 						}
 						m_data.clear();
+						m_mirror.clear();
 					}
 				}
 			}
@@ -150,20 +195,21 @@ namespace MotionPlanning
 					nearest = m_centroid;
 					nearestDistance = centroidDistance;
 				}
-				for (auto it = m_data.begin(), end = m_data.end(); it != end; ++it)
+				float distances[bucketSize()];
+				bucketDistances(value, distance, distances);
+				for (size_t cpt = 0; cpt < m_data.size(); ++cpt)
 				{
-					float localDistance = distance(*it, value);
-					if(localDistance < nearestDistance)
+					if(distances[cpt] < nearestDistance)
 					{
-						nearest = (*it);
-						nearestDistance = localDistance;
+						nearest = m_data[cpt];
+						nearestDistance = distances[cpt];
 					}
 				}
-				if(m_left && distance(m_centroid, value)-nearestDistance<=m_limit)
+				if(m_left && centroidDistance-nearestDistance<=m_limit)
 				{
 					m_left->nearestNeighbour(value, distance, nearest, nearestDistance);
 				}
-				if(m_right && distance(m_centroid, value)+nearestDistance>m_limit)
+				if(m_right && centroidDistance+nearestDistance>m_limit)
 				{
 					m_right->nearestNeighbour(value, distance, nearest, nearestDistance);
 				}
@@ -186,11 +232,13 @@ namespace MotionPlanning
 				{
 					result.push_back(m_centroid);
 				}
-				for(auto it=m_data.begin(), end = m_data.end() ; it!=end; ++it)
+				float distances[bucketSize()];
+				bucketDistances(center, distance, distances);
+				for (size_t cpt = 0; cpt < m_data.size(); ++cpt)
 				{
-					if(distance(*it, center)<=radius)
+					if(distances[cpt]<=radius)
 					{
-						result.push_back(*it);
+						result.push_back(m_data[cpt]);
 					}
 				}
 				if (m_left && distanceToCentroid - radius <= m_limit) { m_left->select(center, radius, distance, result); }
@@ -237,9 +285,11 @@ namespace MotionPlanning
 					if (result.has_max()) { radius = result.max(); } // We update the radius if needed
 				}
 				// We add all the data in the kmap structure if needed
-				for (auto it = m_data.begin(), end = m_data.end(); it != end; ++it)
+				float distances[bucketSize()];
+				bucketDistances(center, distance, distances);
+				for (size_t cpt = 0; cpt < m_data.size(); ++cpt)
 				{
-					result.insert({distance(*it, center), *it});
+					result.insert({distances[cpt], m_data[cpt]});
 				}
 				if (result.has_max()) { radius = result.max(); } // We update the radius if needed
 				// We explore the left son if needed
@@ -464,6 +514,17 @@ namespace MotionPlanning
 			return result;
 		}
 
+		/// <summary>
+		/// Selects the elements in the ball centered in center with radius radius.
+		/// </summary>
+		/// <param name="center">The center of the ball.</param>
+		/// <param name="radius">The radius of the ball.</param>
+		/// <param name="result">The selected elements are appended to this vector.</param>
+		void select(const SearchData & center, double radius, std::vector<Data> & result) const
+		{
+			selectFunction(center, radius, result);
+		}
+
 		/// <summary>
 		/// Returns the k nearest neighbours of the provided value.
 		/// </summary>
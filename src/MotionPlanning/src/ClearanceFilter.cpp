@@ -0,0 +1,120 @@
+#include <MotionPlanning/ClearanceFilter.h>
+#include <tbb/parallel_for.h>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace MotionPlanning
+{
+	namespace
+	{
+		/// <summary>
+		/// Computes the smallest sphere centered on the middle of the bounding box of the provided triangles that contains them.
+		/// </summary>
+		ClearanceFilter::Sphere boundingSphere(const std::vector<const std::array<Math::Vector3f, 3>*> & triangles)
+		{
+			Math::Vector3f minimum = Math::makeVector(std::numeric_limits<float>::max(), std::numeric_limits<float>::max(), std::numeric_limits<float>::max());
+			Math::Vector3f maximum = minimum * -1.0f;
+			for (const std::array<Math::Vector3f, 3> * triangle : triangles)
+			{
+				for (const Math::Vector3f & vertex : *triangle)
+				{
+					minimum = minimum.simdMin(vertex);
+					maximum = maximum.simdMax(vertex);
+				}
+			}
+			ClearanceFilter::Sphere result = { (minimum + maximum) * 0.5f, 0.0f };
+			for (const std::array<Math::Vector3f, 3> * triangle : triangles)
+			{
+				for (const Math::Vector3f & vertex : *triangle)
+				{
+					result.m_radius = std::max(result.m_radius, (vertex - result.m_center).norm());
+				}
+			}
+			return result;
+		}
+	}
+
+	ClearanceFilter::ClearanceFilter(CollisionManager & manager, const CollisionManager::DynamicCollisionObject & mobile, const std::vector<std::pair<float, float>> & intervals,
+		float cellSize, size_t splits)
+		: m_cellSize(cellSize)
+	{
+		assert(intervals.size() >= 3 && cellSize > 0.0f && splits > 0);
+		manager.initialize();
+		buildSpheres(manager.getTriangles(mobile), splits);
+		// The grid covers all the positions reachable by the spheres of the mobile
+		float extent = m_bound.m_center.norm() + m_bound.m_radius;
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			m_origin[axis] = intervals[axis].first - extent;
+			m_cells[axis] = std::max<size_t>(size_t(std::ceil((intervals[axis].second - intervals[axis].first + 2.0f * extent) / m_cellSize)), 1);
+		}
+		buildGrid(manager);
+	}
+
+	void ClearanceFilter::buildSpheres(const std::vector<std::array<Math::Vector3f, 3>> & triangles, size_t splits)
+	{
+		std::vector<const std::array<Math::Vector3f, 3>*> all;
+		all.reserve(triangles.size());
+		for (const std::array<Math::Vector3f, 3> & triangle : triangles) { all.push_back(&triangle); }
+		m_bound = boundingSphere(all);
+		// Triangles are clustered by the cell of a splits^3 grid over the bounding box containing their centroid
+		Math::Vector3f minimum = m_bound.m_center - Math::makeVector(m_bound.m_radius, m_bound.m_radius, m_bound.m_radius);
+		float clusterSize = std::max(2.0f * m_bound.m_radius / float(splits), std::numeric_limits<float>::min());
+		std::vector<std::vector<const std::array<Math::Vector3f, 3>*>> clusters(splits * splits * splits);
+		for (const std::array<Math::Vector3f, 3> * triangle : all)
+		{
+			Math::Vector3f centroid = ((*triangle)[0] + (*triangle)[1] + (*triangle)[2]) * (1.0f / 3.0f);
+			size_t index = 0;
+			for (size_t axis = 0; axis < 3; ++axis)
+			{
+				size_t cell = std::min(size_t(std::max((centroid[axis] - minimum[axis]) / clusterSize, 0.0f)), splits - 1);
+				index = index * splits + cell;
+			}
+			clusters[index].push_back(triangle);
+		}
+		m_spheres.clear();
+		for (const std::vector<const std::array<Math::Vector3f, 3>*> & cluster : clusters)
+		{
+			if (!cluster.empty()) { m_spheres.push_back(boundingSphere(cluster)); }
+		}
+	}
+
+	void ClearanceFilter::buildGrid(const CollisionManager & manager)
+	{
+		m_clearance.resize(m_cells[0] * m_cells[1] * m_cells[2]);
+		// The clearance of a cell is the distance between the obstacles and the sphere circumscribed to the cell
+		float halfDiagonal = m_cellSize * std::sqrt(3.0f) * 0.5f;
+		auto computeCells = [this, &manager, halfDiagonal](const ::tbb::blocked_range<size_t> & range)
+		{
+			for (size_t index = range.begin(); index != range.end(); ++index)
+			{
+				size_t x = index / (m_cells[1] * m_cells[2]);
+				size_t y = (index / m_cells[2]) % m_cells[1];
+				size_t z = index % m_cells[2];
+				Math::Vector3f center = m_origin + Math::makeVector(float(x) + 0.5f, float(y) + 0.5f, float(z) + 0.5f) * m_cellSize;
+				m_clearance[index] = manager.computeDistance(center, halfDiagonal);
+			}
+		};
+		::tbb::parallel_for(::tbb::blocked_range<size_t>(0, m_clearance.size()), computeCells);
+	}
+
+	bool ClearanceFilter::isFree(const Sphere & sphere, const Math::Vector3f & translation, const Math::Quaternion<float> & orientation) const
+	{
+		Math::Vector3f center = translation + orientation.rotate(sphere.m_center);
+		size_t index = 0;
+		for (size_t axis = 0; axis < 3; ++axis)
+		{
+			float cell = std::floor((center[axis] - m_origin[axis]) / m_cellSize);
+			if (cell < 0.0f || cell >= float(m_cells[axis])) { return false; }
+			index = index * m_cells[axis] + size_t(cell);
+		}
+		return m_clearance[index] > sphere.m_radius;
+	}
+
+	bool ClearanceFilter::isFree(const Math::Vector3f & translation, const Math::Quaternion<float> & orientation) const
+	{
+		if (isFree(m_bound, translation, orientation)) { return true; }
+		return std::all_of(m_spheres.begin(), m_spheres.end(), [&](const Sphere & sphere) { return isFree(sphere, translation, orientation); });
+	}
+}
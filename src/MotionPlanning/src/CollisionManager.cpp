@@ -25,9 +25,36 @@ namespace MotionPlanning
 		fcl::DistanceResult<float> distanceResult;
 		fcl::distance(o1, o2, distanceRequest, distanceResult);
 		*result = std::min(*result, distanceResult.min_distance);
+		// The broad phase skips the pairs whose bounding volumes are farther than dist
+		dist = *result;
 		return false;
 	}
 
+	bool CollisionManager::continuousCollisionCallback(fcl::CollisionObject<float>* o1, fcl::CollisionObject<float>* o2, void * data)
+	{
+		ContinuousCollisionData * motion = (ContinuousCollisionData*)data;
+		// The bounding sphere of the motion is one of the objects, the other one is the static object to test
+		const fcl::CollisionObject<float> * obstacle = (o1 == motion->m_bound) ? o2 : o1;
+		fcl::ContinuousCollisionRequest<float> request;
+		request.num_max_iterations = 100;
+		request.toc_err = 1e-4f;
+		request.ccd_motion_type = fcl::CCDM_LINEAR;
+		request.ccd_solver_type = fcl::CCDC_CONSERVATIVE_ADVANCEMENT;
+		fcl::ContinuousCollisionResult<float> result;
+		fcl::continuousCollide(motion->m_geometry, motion->m_start, motion->m_end,
+			obstacle->collisionGeometry().get(), obstacle->getTransform(), obstacle->getTransform(), request, result);
+		motion->m_result = result.is_collide;
+		return result.is_collide;
+	}
+
+	fcl::Transform3f CollisionManager::toTransform(const Math::Vector3f & translation, const Math::Quaternion<float> & orientation)
+	{
+		fcl::Transform3f transform = fcl::Transform3f::Identity();
+		transform.linear() = convert(orientation).toRotationMatrix();
+		transform.translation() = convert(translation);
+		return transform;
+	}
+
 	CollisionManager::DynamicCollisionObject CollisionManager::registerDynamicObject(const HelperGl::Mesh * mesh)
 	{
 		// We register the mesh if necessary
@@ -67,6 +94,7 @@ namespace MotionPlanning
 	void CollisionManager::unregister(const DynamicCollisionObject & object)
 	{
 		m_dynamicManager.unregisterObject(object.get().get());
+		for (auto & queries : m_queryObjects) { queries.erase(object.get().get()); }
 		m_collisionObjects.erase(object);
 	}
 
@@ -76,7 +104,7 @@ namespace MotionPlanning
 		m_collisionObjects.erase(object);
 	}
 
-	bool CollisionManager::doCollide() 
+	void CollisionManager::initialize()
 	{
 		if (!m_isInitialized)
 		{
@@ -84,6 +112,11 @@ namespace MotionPlanning
 			m_dynamicManager.setup();
 			m_isInitialized = true;
 		}
+	}
+
+	bool CollisionManager::doCollide() 
+	{
+		initialize();
 		bool result = false;
 		m_staticManager.update();
 		m_dynamicManager.update();
@@ -95,14 +128,42 @@ namespace MotionPlanning
 		return result;
 	}
 
+	bool CollisionManager::doCollide(const DynamicCollisionObject & object, const Math::Vector3f & translation, const Math::Quaternion<float> & orientation) const
+	{
+		assert(m_isInitialized);
+		// The query object of this thread. It is copied from the dynamic object: constructing it from the geometry would recompute the
+		// local bounding box of the shared geometry, which races with the other threads.
+		std::unique_ptr<fcl::CollisionObject<float>> & query = m_queryObjects.local()[object.get().get()];
+		if (!query) { query.reset(new fcl::CollisionObject<float>(*object.get())); }
+		query->setTransform(toTransform(translation, orientation));
+		query->computeAABB();
+		bool result = false;
+		m_staticManager.collide(query.get(), &result, &doCollideCallback);
+		return result;
+	}
+
+	bool CollisionManager::doCollide(const DynamicCollisionObject & object, const Math::Vector3f & startTranslation, const Math::Quaternion<float> & startOrientation,
+		const Math::Vector3f & endTranslation, const Math::Quaternion<float> & endOrientation) const
+	{
+		assert(m_isInitialized);
+		const fcl::CollisionGeometry<float> * geometry = object->collisionGeometry().get();
+		// Whatever its orientation, the object lies in a sphere of radius extent centered on its origin. Along the motion, the origin
+		// moves on the segment between both translations: the swept volume lies in a sphere centered on the middle of this segment.
+		float extent = geometry->aabb_center.norm() + geometry->aabb_radius;
+		float radius = extent + (endTranslation - startTranslation).norm() * 0.5f;
+		fcl::Transform3f center = fcl::Transform3f::Identity();
+		center.translation() = convert((startTranslation + endTranslation) * 0.5f);
+		fcl::CollisionObject<float> bound(std::make_shared<fcl::Sphere<float>>(radius), center);
+		bound.computeAABB();
+		ContinuousCollisionData data = { &bound, geometry, toTransform(startTranslation, startOrientation), toTransform(endTranslation, endOrientation), false };
+		// The broad phase only reports the static objects whose bounding box overlaps the one of the sphere, the narrow phase is done by the callback
+		m_staticManager.collide(&bound, &data, &continuousCollisionCallback);
+		return data.m_result;
+	}
+
 	float CollisionManager::computeDistance() 
 	{
-		if (!m_isInitialized)
-		{
-			m_staticManager.setup();
-			m_dynamicManager.setup();
-			m_isInitialized = true;
-		}
+		initialize();
 		float result = std::numeric_limits<float>::max();
 		m_staticManager.update();
 		m_dynamicManager.update();
@@ -110,4 +171,34 @@ namespace MotionPlanning
 		return result;
 	}
 
+	float CollisionManager::computeDistance(const Math::Vector3f & center, float radius) const
+	{
+		assert(m_isInitialized);
+		fcl::Transform3f transform = fcl::Transform3f::Identity();
+		transform.translation() = convert(center);
+		fcl::CollisionObject<float> query(std::make_shared<fcl::Sphere<float>>(radius), transform);
+		float result = std::numeric_limits<float>::max();
+		m_staticManager.distance(&query, &result, distanceCallback);
+		return std::max(result, 0.0f);
+	}
+
+	std::vector<std::array<Math::Vector3f, 3>> CollisionManager::getTriangles(const CollisionObject & object) const
+	{
+		std::vector<std::array<Math::Vector3f, 3>> result;
+		const fcl::BVHModel<fcl::OBBRSS<float>> * model = dynamic_cast<const fcl::BVHModel<fcl::OBBRSS<float>>*>(object->collisionGeometry().get());
+		assert(model != nullptr);
+		result.reserve(model->num_tris);
+		for (int cpt = 0; cpt < model->num_tris; ++cpt)
+		{
+			std::array<Math::Vector3f, 3> triangle;
+			for (size_t vertex = 0; vertex < 3; ++vertex)
+			{
+				const fcl::Vector3f & v = model->vertices[model->tri_indices[cpt][vertex]];
+				triangle[vertex] = Math::makeVector(v[0], v[1], v[2]);
+			}
+			result.push_back(triangle);
+		}
+		return result;
+	}
+
 }
\ No newline at end of file
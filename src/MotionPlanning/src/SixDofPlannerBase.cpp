@@ -1,30 +1,89 @@
 #include <MotionPlanning/SixDofPlannerBase.h>
+#include <MotionPlanning/SamplingStrategy.h>
+#include <MotionPlanning/ClearanceFilter.h>
 #include <algorithm>
 
 namespace MotionPlanning
 {
 	SixDofPlannerBase::SixDofPlannerBase(MotionPlanning::CollisionManager* collisionManager, MotionPlanning::CollisionManager::DynamicCollisionObject object, const std::initializer_list<std::pair<float, float>>& intervals):
-		m_intervals(intervals), m_collisionManager(collisionManager), m_object(object)
+		m_sampler(new UniformSampler), m_sampleLimit(std::numeric_limits<size_t>::max()), m_intervals(intervals), m_edgeValidation(EdgeValidation::cDiscrete), m_collisionManager(collisionManager), m_object(object)
 	{
 		assert(m_intervals.size() == 6);
+		m_uniformOrientation = std::all_of(m_intervals.begin() + 3, m_intervals.end(), [](const std::pair<float, float> & interval) { return interval == defaultAngleInterval(); });
 	}
 
 	SixDofPlannerBase::SixDofPlannerBase(MotionPlanning::CollisionManager* collisionManager, MotionPlanning::CollisionManager::DynamicCollisionObject object, const std::vector<std::pair<float, float>>& intervals)
-	: m_intervals(intervals), m_collisionManager(collisionManager), m_object(object)
+	: m_sampler(new UniformSampler), m_sampleLimit(std::numeric_limits<size_t>::max()), m_intervals(intervals), m_edgeValidation(EdgeValidation::cDiscrete), m_collisionManager(collisionManager), m_object(object)
 	{
 		assert(m_intervals.size() == 6);
+		m_uniformOrientation = std::all_of(m_intervals.begin() + 3, m_intervals.end(), [](const std::pair<float, float> & interval) { return interval == defaultAngleInterval(); });
 	}
 
-	SixDofPlannerBase::Configuration SixDofPlannerBase::randomConfiguration() const
+	SixDofPlannerBase::~SixDofPlannerBase()
+	{}
+
+	void SixDofPlannerBase::seed(std::uint64_t seed)
+	{
+		m_sampler->seed(seed);
+		// The perturbations of the strategy must not replay the stream of the sampler
+		if (m_strategy != nullptr) { m_strategy->seed(ConfigurationSampler::mix(seed, 1)); }
+	}
+
+	void SixDofPlannerBase::setSamplingStrategy(std::unique_ptr<SamplingStrategy> strategy)
+	{
+		m_strategy = std::move(strategy);
+	}
+
+	bool SixDofPlannerBase::randomConfiguration(Configuration & result) const
+	{
+		if (m_strategy == nullptr)
+		{
+			++m_statistics.m_candidates;
+			++m_statistics.m_samples;
+			result = uniformConfiguration();
+			return true;
+		}
+		// One candidate per call to the strategy, whatever the number of configurations it draws (e.g. two for obstacle based sampling)
+		while (true)
+		{
+			++m_statistics.m_candidates;
+			if (m_strategy->sample(*this, result))
+			{
+				++m_statistics.m_samples;
+				return true;
+			}
+			if (isSampleLimitReached()) { return false; }
+		}
+	}
+
+	SixDofPlannerBase::Configuration SixDofPlannerBase::uniformConfiguration() const
+	{
+		return toConfiguration(m_sampler->next());
+	}
+
+	SixDofPlannerBase::Configuration SixDofPlannerBase::toConfiguration(const ConfigurationSampler::Point & point) const
 	{
 		float dofs[6];
 		for (size_t cpt = 0; cpt<6; ++cpt)
 		{
-			dofs[cpt] = static_cast<float>(m_uniformRandom(m_intervals[cpt].first, m_intervals[cpt].second));
+			dofs[cpt] = m_intervals[cpt].first + point[cpt] * (m_intervals[cpt].second - m_intervals[cpt].first);
+		}
+		if (m_uniformOrientation)
+		{
+			return Configuration(Math::makeVector(dofs[0], dofs[1], dofs[2]), uniformOrientation(point[3], point[4], point[5]));
 		}
 		return Configuration{ Math::makeVector(dofs[0], dofs[1], dofs[2]), Math::makeVector(dofs[3], dofs[4], dofs[5]) };
 	}
 
+	Math::Quaternion<float> SixDofPlannerBase::uniformOrientation(float u1, float u2, float u3)
+	{
+		float r1 = sqrt(1.0f - u1);
+		float r2 = sqrt(u1);
+		float theta1 = float(2.0 * Math::pi) * u2;
+		float theta2 = float(2.0 * Math::pi) * u3;
+		return Math::Quaternion<float>(r2 * cos(theta2), Math::makeVector(r1 * sin(theta1), r1 * cos(theta1), r2 * sin(theta2)));
+	}
+
 	float SixDofPlannerBase::distanceToObstacles(const Configuration & configuration) const
 	{
 		m_object.setTranslation(configuration.m_translation);
@@ -34,6 +93,12 @@ namespace MotionPlanning
 
 	bool SixDofPlannerBase::doCollide(const Configuration & configuration) const
 	{
+		++m_statistics.m_collisionChecks;
+		if (m_clearanceFilter != nullptr && m_clearanceFilter->isFree(configuration.m_translation, configuration.m_orientation))
+		{
+			++m_statistics.m_filteredChecks;
+			return false;
+		}
 		m_object.setTranslation(configuration.m_translation);
 		//m_object.setOrientation(toQuaternion(configuration.m_eulerAngles));
 		m_object.setOrientation(configuration.m_orientation);
@@ -43,10 +108,14 @@ namespace MotionPlanning
 
 	float SixDofPlannerBase::configurationDistance(const Configuration & c1, const Configuration & c2) 
 	{
-		float wR = 1;
-		float wT = 1;
-		float dotProduct = std::clamp(fabs(c1.m_orientation.dot(c2.m_orientation)), 0.0f, 1.0f);
-		float result = (c1.m_translation-c2.m_translation).norm()*wT + wR*acos(dotProduct) /(0.5*Math::pi); // For  compilation purpose
+		// Same computation as the vectorized kernel of ConfigurationSoA (keeps distances consistent between both implementations)
+		float dx = c1.m_translation[0] - c2.m_translation[0];
+		float dy = c1.m_translation[1] - c2.m_translation[1];
+		float dz = c1.m_translation[2] - c2.m_translation[2];
+		float dotProduct = c1.m_orientation.s() * c2.m_orientation.s() + c1.m_orientation.v()[0] * c2.m_orientation.v()[0]
+			+ c1.m_orientation.v()[1] * c2.m_orientation.v()[1] + c1.m_orientation.v()[2] * c2.m_orientation.v()[2];
+		dotProduct = std::min(std::fabs(dotProduct), 1.0f);
+		float result = std::sqrt(dx*dx + dy*dy + dz*dz) + fastAcos(dotProduct) * inverseHalfPi();
 		assert(std::isfinite(result));
 		//if (c1 == c2)
 		//{
@@ -77,6 +146,12 @@ namespace MotionPlanning
 
 	bool SixDofPlannerBase::doCollide(const Configuration & start, const Configuration & end, float dq) const
 	{
+		if (m_edgeValidation == EdgeValidation::cContinuous)
+		{
+			++m_statistics.m_continuousChecks;
+			m_collisionManager->initialize();
+			return m_collisionManager->doCollide(m_object, start.m_translation, start.m_orientation, end.m_translation, end.m_orientation);
+		}
 		float d = configurationDistance(start, end);
 		if (d < dq) {
 			return false;
@@ -96,6 +171,29 @@ namespace MotionPlanning
 		}
 	}
 
+	bool SixDofPlannerBase::doCollide(const Configuration & configuration, Statistics & statistics) const
+	{
+		++statistics.m_collisionChecks;
+		if (m_clearanceFilter != nullptr && m_clearanceFilter->isFree(configuration.m_translation, configuration.m_orientation))
+		{
+			++statistics.m_filteredChecks;
+			return false;
+		}
+		return m_collisionManager->doCollide(m_object, configuration.m_translation, configuration.m_orientation);
+	}
+
+	bool SixDofPlannerBase::doCollide(const Configuration & start, const Configuration & end, float dq, Statistics & statistics) const
+	{
+		if (m_edgeValidation == EdgeValidation::cContinuous)
+		{
+			++statistics.m_continuousChecks;
+			return m_collisionManager->doCollide(m_object, start.m_translation, start.m_orientation, end.m_translation, end.m_orientation);
+		}
+		if (configurationDistance(start, end) < dq) { return false; }
+		Configuration mid = start.interpolate(end, 0.5);
+		return doCollide(mid, statistics) || doCollide(start, mid, dq, statistics) || doCollide(mid, end, dq, statistics);
+	}
+
 	void SixDofPlannerBase::optimize(::std::vector<Configuration>& toOptimize, float dq) const
 	{
 		// Does nothing for now...
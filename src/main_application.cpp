@@ -8,10 +8,42 @@
 #include <Application/TP3_siaa.h>
 #include <Application/SIAA_TP4_MotionPlanning.h>
 #include <Application/SIAA_TP5_behavior.h>
+#include <Benchmarks/PlanningBenchmark.h>
+#include <Benchmarks/CrowdBenchmark.h>
+#include <Benchmarks/CrowdScenario.h>
+#include <Benchmarks/MessageBenchmark.h>
+#include <Benchmarks/TaskBenchmark.h>
+#include <Benchmarks/BlackboardBenchmark.h>
+#include <string>
 
 int main(int argc, char ** argv)
 {
   ::std::cout<<"Path of the executable: "<<System::Path::executable()<<::std::endl ;
+	// Headless benchmarks: --planning-benchmark | --crowd-benchmark | --crowd-scenario | --message-benchmark | --task-benchmark | --blackboard-benchmark [config=file] [key=value...]
+	if (argc > 1 && ::std::string(argv[1]) == "--planning-benchmark")
+	{
+		return Benchmarks::PlanningBenchmark::main(Benchmarks::Parameters(argc - 2, argv + 2));
+	}
+	if (argc > 1 && ::std::string(argv[1]) == "--crowd-benchmark")
+	{
+		return Benchmarks::CrowdBenchmark::main(Benchmarks::Parameters(argc - 2, argv + 2));
+	}
+	if (argc > 1 && ::std::string(argv[1]) == "--crowd-scenario")
+	{
+		return Benchmarks::CrowdScenario::main(Benchmarks::Parameters(argc - 2, argv + 2));
+	}
+	if (argc > 1 && ::std::string(argv[1]) == "--message-benchmark")
+	{
+		return Benchmarks::MessageBenchmark::main(Benchmarks::Parameters(argc - 2, argv + 2));
+	}
+	if (argc > 1 && ::std::string(argv[1]) == "--task-benchmark")
+	{
+		return Benchmarks::TaskBenchmark::main(Benchmarks::Parameters(argc - 2, argv + 2));
+	}
+	if (argc > 1 && ::std::string(argv[1]) == "--blackboard-benchmark")
+	{
+		return Benchmarks::BlackboardBenchmark::main(Benchmarks::Parameters(argc - 2, argv + 2));
+	}
 	// Registers the application 
 	/*SI*/
 	/*
@@ -0,0 +1,145 @@
+#pragma once
+
+#include <vector>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <cassert>
+
+namespace stdext
+{
+	/// <summary>
+	/// A monotonic arena of objects of type Type. Objects are constructed contiguously in blocks of blockSize elements and are
+	/// never released individually: all objects are destroyed at once by clear() (or by the destructor of the arena), iteratively
+	/// and without returning memory to the system, so that the blocks are reused by the next objects. Object addresses are stable.
+	/// </summary>
+	template <typename Type, size_t blockSize = 1024>
+	class arena
+	{
+		using storage = typename std::aligned_storage<sizeof(Type), alignof(Type)>::type;
+
+		std::vector<std::unique_ptr<storage[]>> m_blocks;
+		size_t m_size;
+
+		/// <summary>
+		/// Gets the address of the object at the provided index.
+		/// </summary>
+		/// <param name="index">The index.</param>
+		/// <returns></returns>
+		Type * at(size_t index) const
+		{
+			return reinterpret_cast<Type*>(&m_blocks[index / blockSize][index % blockSize]);
+		}
+
+	public:
+		/// <summary>
+		/// Initializes a new instance of the <see cref="arena"/> class.
+		/// </summary>
+		arena()
+			: m_size(0)
+		{}
+
+		arena(const arena &) = delete;
+		arena & operator= (const arena &) = delete;
+
+		/// <summary>
+		/// Move constructor. The objects of the other arena are transferred, their addresses do not change.
+		/// </summary>
+		/// <param name="other">The other arena.</param>
+		arena(arena && other) noexcept
+			: m_blocks(std::move(other.m_blocks)), m_size(other.m_size)
+		{
+			other.m_blocks.clear();
+			other.m_size = 0;
+		}
+
+		/// <summary>
+		/// Move assignment. The objects of this arena are destroyed, the objects of the other one are transferred.
+		/// </summary>
+		/// <param name="other">The other arena.</param>
+		/// <returns></returns>
+		arena & operator= (arena && other) noexcept
+		{
+			if (this != &other)
+			{
+				clear();
+				m_blocks = std::move(other.m_blocks);
+				m_size = other.m_size;
+				other.m_blocks.clear();
+				other.m_size = 0;
+			}
+			return (*this);
+		}
+
+		/// <summary>
+		/// Finalizes an instance of the <see cref="arena"/> class. Destroys all the objects.
+		/// </summary>
+		~arena()
+		{
+			clear();
+		}
+
+		/// <summary>
+		/// Constructs a new object in the arena.
+		/// </summary>
+		/// <param name="args">The arguments of the constructor.</param>
+		/// <returns>The constructed object.</returns>
+		template <typename... Args>
+		Type * create(Args &&... args)
+		{
+			if (m_size == m_blocks.size() * blockSize)
+			{
+				m_blocks.push_back(std::unique_ptr<storage[]>(new storage[blockSize]));
+			}
+			Type * result = new (at(m_size)) Type(std::forward<Args>(args)...);
+			++m_size;
+			return result;
+		}
+
+		/// <summary>
+		/// Destroys all the objects. Memory blocks are kept for future allocations. For trivially destructible types, this operation is O(1).
+		/// </summary>
+		void clear()
+		{
+			if constexpr (!std::is_trivially_destructible<Type>::value)
+			{
+				for (size_t cpt = 0; cpt < m_size; ++cpt)
+				{
+					at(cpt)->~Type();
+				}
+			}
+			m_size = 0;
+		}
+
+		/// <summary>
+		/// Releases the memory blocks that are not used.
+		/// </summary>
+		void shrink_to_fit()
+		{
+			m_blocks.resize((m_size + blockSize - 1) / blockSize);
+		}
+
+		/// <summary>
+		/// Returns the number of objects in the arena.
+		/// </summary>
+		/// <returns></returns>
+		size_t size() const { return m_size; }
+
+		/// <summary>
+		/// Determines whether the arena is empty.
+		/// </summary>
+		/// <returns></returns>
+		bool empty() const { return m_size == 0; }
+
+		/// <summary>
+		/// Gets the object at the provided index (objects are indexed by creation order).
+		/// </summary>
+		/// <param name="index">The index.</param>
+		/// <returns></returns>
+		Type & operator[] (size_t index) const
+		{
+			assert(index < m_size);
+			return *at(index);
+		}
+	};
+}
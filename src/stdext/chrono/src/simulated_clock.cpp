@@ -1,5 +1,3 @@
-#pragma once
-
 #include <stdext/chrono/simulated_clock.h>
 
 namespace stdext
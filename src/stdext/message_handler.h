@@ -1,11 +1,33 @@
 #pragma once
 
 #include <stdext/hash.h>
+#include <stdext/type_id.h>
+#include <tbb/enumerable_thread_specific.h>
 #include <unordered_map>
+#include <vector>
+#include <memory>
 #include <deque>
+#include <algorithm>
+#include <limits>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
 
 namespace stdext
 {
+	/// <summary>
+	/// Dispatches messages to receivers. A receiver is created for a message type and a target identifier, messages can be
+	/// broadcast to all the receivers of their type or posted to the receivers of a target. Receivers are stored in one table
+	/// per message type indexed by <see cref="type_id"/>: the dispatch does not use RTTI.
+	///
+	/// By default messages are delivered immediately. In deferred mode (see <see cref="setDeferred"/>), broadcast and post can be called
+	/// concurrently: messages are appended to per thread buffers and delivered by <see cref="flush"/>, ordered by the key of their emitter
+	/// (see <see cref="setEmitter"/>) then by emission order. The delivery order does not depend on the scheduling of the threads.
+	/// Receivers must not be created or destroyed while messages are emitted concurrently.
+	///
+	/// Targets providing a dense index through a getIndex() method (e.g. the agents) have their receivers stored in a vector indexed by
+	/// this index, the other targets in a hash map.
+	/// </summary>
 	class message_handler
 	{
 	public:
@@ -13,6 +35,26 @@ namespace stdext
 		template <typename MessageType> friend class receiver_queue;
 
 	private:
+		/// <summary>
+		/// Index of the targets without dense index.
+		/// </summary>
+		static constexpr size_t no_index = std::numeric_limits<size_t>::max();
+
+		/// <summary>
+		/// Returns the dense index of a target, or no_index if its type has no getIndex() method.
+		/// </summary>
+		template <typename TargetType, typename = void>
+		struct target_index
+		{
+			static size_t get(const TargetType *) { return no_index; }
+		};
+
+		template <typename TargetType>
+		struct target_index<TargetType, std::enable_if_t<std::is_integral<decltype(std::declval<const TargetType*>()->getIndex())>::value>>
+		{
+			static size_t get(const TargetType * target) { return target == nullptr ? no_index : size_t(target->getIndex()); }
+		};
+
 		/// <summary>
 		/// Base class for message receivers
 		/// </summary>
@@ -30,7 +72,21 @@ namespace stdext
 		class template_receiver_base : public receiver_base
 		{
 		protected:
+			friend class message_handler;
+
 			message_handler * m_messageHandler;
+			/// <summary>
+			/// The target identifier of this receiver.
+			/// </summary>
+			void * m_target;
+			/// <summary>
+			/// The dense index of the target if this receiver is stored in the indexed targets of its table, no_index otherwise.
+			/// </summary>
+			size_t m_targetIndex;
+			/// <summary>
+			/// The index of this receiver in the table of its message type.
+			/// </summary>
+			size_t m_slot;
 
 			template_receiver_base(message_handler * messageHandler)
 				: m_messageHandler(messageHandler)
@@ -150,8 +206,120 @@ namespace stdext
 		};
 
 	private:
-		//std::unordered_map<std::reference_wrapper<const type_info>, std::vector<receiver_base*>> m_callbacks;
-		std::unordered_map<std::reference_wrapper<const type_info>, std::unordered_map<void*, std::vector<receiver_base*>>> m_callbacks;
+		/// <summary>
+		/// Base class of the receiver tables.
+		/// </summary>
+		class table_base
+		{
+		public:
+			virtual ~table_base() {}
+		};
+
+		/// <summary>
+		/// The receivers of the messages of type MessageType.
+		/// </summary>
+		template <typename MessageType>
+		class table : public table_base
+		{
+		public:
+			/// <summary>
+			/// All the receivers (used by broadcast).
+			/// </summary>
+			std::vector<template_receiver_base<MessageType>*> m_receivers;
+			/// <summary>
+			/// The receivers of a target with a dense index.
+			/// </summary>
+			struct indexed_target
+			{
+				void * m_target = nullptr;
+				std::vector<template_receiver_base<MessageType>*> m_receivers;
+			};
+			/// <summary>
+			/// The receivers of the targets with a dense index, indexed by this index (used by post). A slot belongs to the target of its
+			/// receivers: the receivers of another target with the same index (e.g. a target of another type) go to m_targets.
+			/// </summary>
+			std::vector<indexed_target> m_indexedTargets;
+			/// <summary>
+			/// The receivers of the other targets (used by post).
+			/// </summary>
+			std::unordered_map<void*, std::vector<template_receiver_base<MessageType>*>> m_targets;
+			/// <summary>
+			/// The receivers of the spy target.
+			/// </summary>
+			std::vector<template_receiver_base<MessageType>*> m_spies;
+
+			/// <summary>
+			/// Returns true if the receivers of the provided target are stored in m_indexedTargets.
+			/// </summary>
+			bool isIndexed(void * target, size_t index) const
+			{
+				return index < m_indexedTargets.size() && m_indexedTargets[index].m_target == target;
+			}
+
+			/// <summary>
+			/// Gets the list containing the provided receiver.
+			/// </summary>
+			std::vector<template_receiver_base<MessageType>*> & receiversOf(const template_receiver_base<MessageType> * receiver)
+			{
+				if (receiver->m_target == nullptr) { return m_spies; }
+				if (receiver->m_targetIndex != no_index) { return m_indexedTargets[receiver->m_targetIndex].m_receivers; }
+				return m_targets[receiver->m_target];
+			}
+		};
+
+		/// <summary>
+		/// The receiver tables indexed by the type_id of their message type.
+		/// </summary>
+		std::vector<std::unique_ptr<table_base>> m_tables;
+
+		/// <summary>
+		/// Gets the table of the provided message type, creates it if needed.
+		/// </summary>
+		template <typename MessageType>
+		table<MessageType> & getTable()
+		{
+			type_id_t id = type_id<MessageType>();
+			if (id >= m_tables.size()) { m_tables.resize(id + 1); }
+			if (!m_tables[id]) { m_tables[id].reset(new table<MessageType>); }
+			return static_cast<table<MessageType>&>(*m_tables[id]);
+		}
+
+		/// <summary>
+		/// Finds the table of the provided message type.
+		/// </summary>
+		/// <returns>The table or nullptr if no receiver has been created for this type.</returns>
+		template <typename MessageType>
+		const table<MessageType> * findTable() const
+		{
+			type_id_t id = type_id<MessageType>();
+			if (id >= m_tables.size()) { return nullptr; }
+			return static_cast<const table<MessageType>*>(m_tables[id].get());
+		}
+
+		/// <summary>
+		/// References a new receiver.
+		/// </summary>
+		/// <param name="receiver">The receiver.</param>
+		/// <param name="target">The target identifier.</param>
+		/// <param name="index">The dense index of the target, no_index if none.</param>
+		template <typename MessageType>
+		void reference(template_receiver_base<MessageType> * receiver, void * target, size_t index)
+		{
+			table<MessageType> & current = getTable<MessageType>();
+			receiver->m_target = target;
+			receiver->m_targetIndex = no_index;
+			receiver->m_slot = current.m_receivers.size();
+			current.m_receivers.push_back(receiver);
+			if (target != spyTarget() && index != no_index)
+			{
+				if (index >= current.m_indexedTargets.size()) { current.m_indexedTargets.resize(index + 1); }
+				typename table<MessageType>::indexed_target & slot = current.m_indexedTargets[index];
+				// A slot without receivers is released (e.g. the index has been reused by a new agent)
+				if (slot.m_receivers.empty()) { slot.m_target = target; }
+				if (slot.m_target == target) { receiver->m_targetIndex = index; }
+			}
+			current.receiversOf(receiver).push_back(receiver);
+		}
 
 		/// <summary>
 		/// Dereferences an instance of receiver.
@@ -160,43 +328,184 @@ namespace stdext
 		template <typename MessageType>
 		void dereference(template_receiver_base<MessageType> * receiver)
 		{
-			std::unordered_map<void*, std::vector<receiver_base*>> & current = m_callbacks[typeid(MessageType)];
-			for (auto it = current.begin(), end = current.end(); it != end; ++it)
+			table<MessageType> & current = getTable<MessageType>();
+			current.m_receivers[receiver->m_slot] = current.m_receivers.back();
+			current.m_receivers[receiver->m_slot]->m_slot = receiver->m_slot;
+			current.m_receivers.pop_back();
+			std::vector<template_receiver_base<MessageType>*> & targetReceivers = current.receiversOf(receiver);
+			auto found = std::find(targetReceivers.begin(), targetReceivers.end(), receiver);
+			if (found != targetReceivers.end())
 			{
-				std::vector<receiver_base*> & tmp = it->second;
-				auto found = std::find(tmp.begin(), tmp.end(), receiver);
-				if (found != tmp.end())
-				{
-					(*found) = tmp.back();
-					tmp.pop_back();
-				}
+				(*found) = targetReceivers.back();
+				targetReceivers.pop_back();
 			}
 		}
 
 		/// <summary>
-		/// Posts the specified message.
+		/// Delivers a message to all the receivers of its type.
 		/// </summary>
-		/// <param name="message">The message.</param>
-		/// <param name="receiver">The receiver.</param>
 		template <typename MessageType>
-		void postHelper(const MessageType & message, receiver_base * receiver)
+		void deliverBroadcast(const MessageType & message)
 		{
+			const table<MessageType> * selected = findTable<MessageType>();
+			if (selected == nullptr) { return; }
+			// Receivers may be created by the callbacks: no iterator is kept during the dispatch
+			for (size_t cpt = 0; cpt < selected->m_receivers.size(); ++cpt)
 			{
-				receiver_queue<MessageType> * current = dynamic_cast<receiver_queue<MessageType>*>(receiver);
-				if (current != nullptr)
-				{
-					current->post(message);
-					return;
-				}
+				selected->m_receivers[cpt]->post(message);
 			}
+		}
+
+		/// <summary>
+		/// Delivers a message to the receivers of a target (and to the spies).
+		/// </summary>
+		template <typename MessageType>
+		void deliverPost(const MessageType & message, void * target, size_t index)
+		{
+			const table<MessageType> * selected = findTable<MessageType>();
+			if (selected == nullptr) { return; }
+			if (target != spyTarget())
 			{
-				receiver_callback<MessageType> * current = dynamic_cast<receiver_callback<MessageType> *>(receiver);
-				if (current != nullptr)
+				if (selected->isIndexed(target, index))
+				{
+					// Receivers may be created by the callbacks: the slot is accessed again at each iteration
+					for (size_t cpt = 0; cpt < selected->m_indexedTargets[index].m_receivers.size(); ++cpt)
+					{
+						selected->m_indexedTargets[index].m_receivers[cpt]->post(message);
+					}
+				}
+				else
 				{
-					current->post(message);
-					return;
+					auto it = selected->m_targets.find(target);
+					if (it == selected->m_targets.end()) { return; }
+					const std::vector<template_receiver_base<MessageType>*> & receivers = it->second;
+					for (size_t cpt = 0; cpt < receivers.size(); ++cpt)
+					{
+						receivers[cpt]->post(message);
+					}
 				}
 			}
+			for (size_t cpt = 0; cpt < selected->m_spies.size(); ++cpt)
+			{
+				selected->m_spies[cpt]->post(message);
+			}
+		}
+
+		/// <summary>
+		/// The emitter of the messages of the current thread.
+		/// </summary>
+		struct emitter
+		{
+			std::uint64_t m_key = std::numeric_limits<std::uint64_t>::max();
+			std::uint64_t m_sequence = 0;
+		};
+
+		/// <summary>
+		/// Gets the emitter of the current thread.
+		/// </summary>
+		static emitter & currentEmitter()
+		{
+			static thread_local emitter current;
+			return current;
+		}
+
+		class thread_buffer;
+
+		/// <summary>
+		/// Base class of the buffers of deferred messages of a given type.
+		/// </summary>
+		class deferred_buffer_base
+		{
+		public:
+			virtual ~deferred_buffer_base() {}
+			virtual void deliver(message_handler & handler, size_t index) = 0;
+			virtual void clear() = 0;
+		};
+
+		/// <summary>
+		/// The deferred messages of type MessageType emitted by a thread.
+		/// </summary>
+		template <typename MessageType>
+		class deferred_buffer : public deferred_buffer_base
+		{
+		public:
+			struct entry
+			{
+				MessageType m_message;
+				void * m_target;
+				size_t m_index;
+				bool m_broadcast;
+			};
+			std::vector<entry> m_entries;
+
+			virtual void deliver(message_handler & handler, size_t index) override
+			{
+				const entry & current = m_entries[index];
+				if (current.m_broadcast) { handler.deliverBroadcast(current.m_message); }
+				else { handler.deliverPost(current.m_message, current.m_target, current.m_index); }
+			}
+
+			virtual void clear() override { m_entries.clear(); }
+		};
+
+		/// <summary>
+		/// A deferred message: its position in the delivery order and its location in a thread buffer.
+		/// </summary>
+		struct pending
+		{
+			std::uint64_t m_key;
+			std::uint64_t m_sequence;
+			deferred_buffer_base * m_buffer;
+			size_t m_index;
+
+			bool operator<(const pending & other) const
+			{
+				return m_key < other.m_key || (m_key == other.m_key && m_sequence < other.m_sequence);
+			}
+		};
+
+		/// <summary>
+		/// The deferred messages emitted by a thread.
+		/// </summary>
+		class thread_buffer
+		{
+		public:
+			std::vector<pending> m_pending;
+			/// <summary>
+			/// The buffers indexed by the type_id of their message type.
+			/// </summary>
+			std::vector<std::unique_ptr<deferred_buffer_base>> m_buffers;
+
+			template <typename MessageType>
+			void push(const MessageType & message, void * target, size_t index, bool broadcast)
+			{
+				type_id_t id = type_id<MessageType>();
+				if (id >= m_buffers.size()) { m_buffers.resize(id + 1); }
+				if (!m_buffers[id]) { m_buffers[id].reset(new deferred_buffer<MessageType>); }
+				deferred_buffer<MessageType> * buffer = static_cast<deferred_buffer<MessageType>*>(m_buffers[id].get());
+				emitter & current = currentEmitter();
+				m_pending.push_back(pending{ current.m_key, current.m_sequence++, buffer, buffer->m_entries.size() });
+				buffer->m_entries.push_back({ message, target, index, broadcast });
+			}
+		};
+
+		bool m_deferred = false;
+		tbb::enumerable_thread_specific<thread_buffer> m_threadBuffers;
+
+		/// <summary>
+		/// Emits a message: immediate delivery or storage in the buffer of the current thread in deferred mode.
+		/// </summary>
+		template <typename MessageType>
+		void emit(const MessageType & message, void * target, size_t index, bool broadcast)
+		{
+			if (m_deferred)
+			{
+				// Nobody listens to this type: the message can be discarded
+				if (findTable<MessageType>() == nullptr) { return; }
+				m_threadBuffers.local().push(message, target, index, broadcast);
+			}
+			else if (broadcast) { deliverBroadcast(message); }
+			else { deliverPost(message, target, index); }
 		}
 
 	public:
@@ -207,15 +516,7 @@ namespace stdext
 		template <typename MessageType>
 		void broadcast(const MessageType & message)
 		{
-			const std::unordered_map<void*, std::vector<receiver_base*>> & selected = m_callbacks[typeid(MessageType)];
-			for (auto selectedIt = selected.begin(), end = selected.end(); selectedIt != end; ++selectedIt)
-			{
-				const std::vector<receiver_base*> & receivers = selectedIt->second;
-				for (auto it = receivers.begin(), end = receivers.end(); it != end; ++it)
-				{
-					postHelper(message, *it);
-				}
-			}
+			emit(message, spyTarget(), no_index, true);
 		}
 
 		/// <summary>
@@ -226,14 +527,7 @@ namespace stdext
 		template <typename MessageType, typename TargetType>
 		void post(const MessageType & message, TargetType * target)
 		{
-			const std::unordered_map<void*, std::vector<receiver_base*>> & selected = m_callbacks[typeid(MessageType)];
-			auto it = selected.find(target);
-			if (it == selected.end()) { return; }
-			for (auto receiverIt = it->second.begin(), end = it->second.end(); receiverIt != end; ++receiverIt)
-			{
-				postHelper(message, *receiverIt);
-			}
-			if (target != spyTarget()) { post(message, spyTarget()); }
+			emit(message, target, target_index<TargetType>::get(target), false);
 		}
 
 		/// <summary>
@@ -258,7 +552,7 @@ namespace stdext
 		receiver_queue<MessageType> * createReceiver(TargetType * receiverIdentifier)
 		{
 			receiver_queue<MessageType> * created = new receiver_queue<MessageType>(this);
-			m_callbacks[std::cref(typeid(MessageType))][receiverIdentifier].push_back(created);
+			reference<MessageType>(created, receiverIdentifier, target_index<TargetType>::get(receiverIdentifier));
 			return created;
 		}
 
@@ -271,7 +565,7 @@ namespace stdext
 		receiver_callback<MessageType> * createReceiver(const Callback & callback, TargetType * receiverIdentifier)
 		{
 			receiver_callback<MessageType> * created = new template_receiver_callback<MessageType, Callback>(this, callback);
-			m_callbacks[std::cref(typeid(MessageType))][receiverIdentifier].push_back(created);
+			reference<MessageType>(created, receiverIdentifier, target_index<TargetType>::get(receiverIdentifier));
 			return created;
 		}
 
@@ -280,5 +574,59 @@ namespace stdext
 		/// </summary>
 		/// <returns></returns>
 		constexpr void * spyTarget() const { return nullptr; }
+
+		/// <summary>
+		/// Enables or disables the deferred mode. When the deferred mode is disabled, the pending messages stay pending until the next flush.
+		/// </summary>
+		/// <param name="deferred">true to enable the deferred mode.</param>
+		void setDeferred(bool deferred) { m_deferred = deferred; }
+
+		/// <summary>
+		/// Returns true if the deferred mode is enabled.
+		/// </summary>
+		/// <returns></returns>
+		bool isDeferred() const { return m_deferred; }
+
+		/// <summary>
+		/// Sets the key of the emitter of the messages sent by the current thread. Deferred messages are delivered by increasing key, the
+		/// messages of a key in their emission order: keys should identify the emitters (e.g. an agent and an update phase) within a flush.
+		/// </summary>
+		/// <param name="key">The key.</param>
+		static void setEmitter(std::uint64_t key)
+		{
+			emitter & current = currentEmitter();
+			current.m_key = key;
+			current.m_sequence = 0;
+		}
+
+		/// <summary>
+		/// Delivers the pending deferred messages. This method must not be called concurrently with message emissions. Messages emitted by
+		/// the receivers during the flush are delivered immediately.
+		/// </summary>
+		void flush()
+		{
+			std::vector<pending> ordered;
+			for (thread_buffer & buffer : m_threadBuffers)
+			{
+				ordered.insert(ordered.end(), buffer.m_pending.begin(), buffer.m_pending.end());
+				buffer.m_pending.clear();
+			}
+			if (ordered.empty()) { return; }
+			std::sort(ordered.begin(), ordered.end());
+			bool deferred = m_deferred;
+			m_deferred = false;
+			for (const pending & current : ordered)
+			{
+				current.m_buffer->deliver(*this, current.m_index);
+			}
+			m_deferred = deferred;
+			for (thread_buffer & buffer : m_threadBuffers)
+			{
+				for (const std::unique_ptr<deferred_buffer_base> & typed : buffer.m_buffers)
+				{
+					if (typed) { typed->clear(); }
+				}
+			}
+		}
 	};
 }
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+
+namespace stdext
+{
+	/// <summary>
+	/// Identifier of a type, see <see cref="type_id"/>.
+	/// </summary>
+	using type_id_t = size_t;
+
+	namespace internal
+	{
+		/// <summary>
+		/// Returns a new type identifier.
+		/// </summary>
+		inline type_id_t next_type_id()
+		{
+			static std::atomic<type_id_t> counter(0);
+			return counter++;
+		}
+	}
+
+	/// <summary>
+	/// Returns the identifier of the provided type. Identifiers are dense (0, 1, 2... in the order of the first calls) and can be used
+	/// to index arrays. They do not rely on RTTI but are only valid during the execution of the program.
+	/// </summary>
+	template <typename Type>
+	type_id_t type_id()
+	{
+		static const type_id_t id = internal::next_type_id();
+		return id;
+	}
+}